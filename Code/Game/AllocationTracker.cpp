@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/AllocationTracker.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/StringUtils.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <atomic>
+#include <fstream>
+#include <new>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Running totals, written from any thread. Constant initialized so they work for allocations made before main
+//------------------------------------------------------------------------------------------------------------------------------
+static std::atomic<int64_t> s_allocCounts[NUM_ALLOC_TAGS];
+static std::atomic<int64_t> s_byteCounts[NUM_ALLOC_TAGS];
+static std::atomic<int64_t> s_liveAllocCounts[NUM_ALLOC_TAGS];
+static std::atomic<int64_t> s_liveByteCounts[NUM_ALLOC_TAGS];
+
+static thread_local eAllocationTag s_threadTag = ALLOC_TAG_UNTAGGED;
+
+int AllocationTracker::s_numFrames = 0;
+int AllocationTracker::s_numQuietFrames = 0;
+AllocationTagStats AllocationTracker::s_frameStats[NUM_ALLOC_TAGS];
+int64_t AllocationTracker::s_lastAllocCounts[NUM_ALLOC_TAGS] = {};
+int64_t AllocationTracker::s_lastByteCounts[NUM_ALLOC_TAGS] = {};
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool AllocationTracker::IsCompiledIn()
+{
+#if defined(GAME_TRACK_ALLOCATIONS)
+	return true;
+#else
+	return false;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC eAllocationTag AllocationTracker::SetThreadTag(eAllocationTag tag)
+{
+	eAllocationTag previousTag = s_threadTag;
+	s_threadTag = tag;
+	return previousTag;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* AllocationTracker::GetTagName(eAllocationTag tag)
+{
+	switch (tag)
+	{
+	case ALLOC_TAG_UNTAGGED:	return "untagged";
+	case ALLOC_TAG_GAME:		return "game";
+	case ALLOC_TAG_PHYSICS:		return "physics";
+	case ALLOC_TAG_RENDER:		return "render";
+	case ALLOC_TAG_CONSOLE:		return "console";
+	case ALLOC_TAG_EVENTS:		return "events";
+	default:					return "unknown";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationTracker::RecordAlloc(eAllocationTag tag, size_t numBytes)
+{
+	s_allocCounts[tag].fetch_add(1, std::memory_order_relaxed);
+	s_byteCounts[tag].fetch_add(static_cast<int64_t>(numBytes), std::memory_order_relaxed);
+	s_liveAllocCounts[tag].fetch_add(1, std::memory_order_relaxed);
+	s_liveByteCounts[tag].fetch_add(static_cast<int64_t>(numBytes), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationTracker::RecordFree(eAllocationTag tag, size_t numBytes)
+{
+	s_liveAllocCounts[tag].fetch_sub(1, std::memory_order_relaxed);
+	s_liveByteCounts[tag].fetch_sub(static_cast<int64_t>(numBytes), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationTracker::EndFrame()
+{
+	if (!IsCompiledIn())
+	{
+		return;
+	}
+
+	bool isQuiet = true;
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		int64_t allocCount = s_allocCounts[tagIndex].load(std::memory_order_relaxed);
+		int64_t byteCount = s_byteCounts[tagIndex].load(std::memory_order_relaxed);
+
+		AllocationTagStats& stats = s_frameStats[tagIndex];
+		stats.m_numAllocsLastFrame = allocCount - s_lastAllocCounts[tagIndex];
+		stats.m_bytesLastFrame = byteCount - s_lastByteCounts[tagIndex];
+		stats.m_numAllocsSinceReset += stats.m_numAllocsLastFrame;
+		stats.m_bytesSinceReset += stats.m_bytesLastFrame;
+		stats.m_maxAllocsPerFrame = (stats.m_numAllocsLastFrame > stats.m_maxAllocsPerFrame) ? stats.m_numAllocsLastFrame : stats.m_maxAllocsPerFrame;
+		stats.m_maxBytesPerFrame = (stats.m_bytesLastFrame > stats.m_maxBytesPerFrame) ? stats.m_bytesLastFrame : stats.m_maxBytesPerFrame;
+
+		s_lastAllocCounts[tagIndex] = allocCount;
+		s_lastByteCounts[tagIndex] = byteCount;
+
+		isQuiet = isQuiet && stats.m_numAllocsLastFrame == 0;
+	}
+
+	s_numFrames++;
+	if (isQuiet)
+	{
+		s_numQuietFrames++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationTracker::ResetStats()
+{
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		//Live counts are never reset, they describe what is on the heap right now
+		s_frameStats[tagIndex] = AllocationTagStats();
+		s_lastAllocCounts[tagIndex] = s_allocCounts[tagIndex].load(std::memory_order_relaxed);
+		s_lastByteCounts[tagIndex] = s_byteCounts[tagIndex].load(std::memory_order_relaxed);
+	}
+
+	s_numFrames = 0;
+	s_numQuietFrames = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC AllocationTagStats AllocationTracker::GetTagStats(eAllocationTag tag)
+{
+	AllocationTagStats stats = s_frameStats[tag];
+	stats.m_numLiveAllocs = s_liveAllocCounts[tag].load(std::memory_order_relaxed);
+	stats.m_liveBytes = s_liveByteCounts[tag].load(std::memory_order_relaxed);
+	return stats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationTracker::PrintReport()
+{
+	if (!IsCompiledIn())
+	{
+		g_devConsole->PrintString(Rgba::RED, "Allocation tracking is compiled out, define GAME_TRACK_ALLOCATIONS in AllocationTracker.hpp");
+		return;
+	}
+
+	//Snapshot first, building the report strings allocates
+	AllocationTagStats tagStats[NUM_ALLOC_TAGS];
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		tagStats[tagIndex] = GetTagStats(static_cast<eAllocationTag>(tagIndex));
+	}
+
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Allocations over %d frames, %d with no allocations", s_numFrames, s_numQuietFrames));
+	g_devConsole->PrintString(Rgba::WHITE, "Tag       allocs/frame  bytes/frame  avg allocs  max allocs   max bytes  live allocs  live bytes");
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		const AllocationTagStats& stats = tagStats[tagIndex];
+		double averageAllocs = (s_numFrames > 0) ? static_cast<double>(stats.m_numAllocsSinceReset) / static_cast<double>(s_numFrames) : 0.0;
+		g_devConsole->PrintString((stats.m_numAllocsLastFrame > 0) ? Rgba::YELLOW : Rgba::WHITE, Stringf("%-9s %12lld %12lld %11.1f %11lld %11lld %12lld %11lld",
+			GetTagName(static_cast<eAllocationTag>(tagIndex)), (long long)stats.m_numAllocsLastFrame, (long long)stats.m_bytesLastFrame, averageAllocs,
+			(long long)stats.m_maxAllocsPerFrame, (long long)stats.m_maxBytesPerFrame, (long long)stats.m_numLiveAllocs, (long long)stats.m_liveBytes));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool AllocationTracker::WriteReport(const std::string& filePath)
+{
+	if (!IsCompiledIn())
+	{
+		return false;
+	}
+
+	AllocationTagStats tagStats[NUM_ALLOC_TAGS];
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		tagStats[tagIndex] = GetTagStats(static_cast<eAllocationTag>(tagIndex));
+	}
+
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "{\"frames\":" << s_numFrames << ",\"quietFrames\":" << s_numQuietFrames << ",\"tags\":[\n";
+	for (int tagIndex = 0; tagIndex < NUM_ALLOC_TAGS; tagIndex++)
+	{
+		const AllocationTagStats& stats = tagStats[tagIndex];
+		file << "{\"name\":\"" << GetTagName(static_cast<eAllocationTag>(tagIndex)) << "\""
+			<< ",\"allocsLastFrame\":" << stats.m_numAllocsLastFrame << ",\"bytesLastFrame\":" << stats.m_bytesLastFrame
+			<< ",\"allocs\":" << stats.m_numAllocsSinceReset << ",\"bytes\":" << stats.m_bytesSinceReset
+			<< ",\"maxAllocsPerFrame\":" << stats.m_maxAllocsPerFrame << ",\"maxBytesPerFrame\":" << stats.m_maxBytesPerFrame
+			<< ",\"liveAllocs\":" << stats.m_numLiveAllocs << ",\"liveBytes\":" << stats.m_liveBytes << "}"
+			<< ((tagIndex + 1 < NUM_ALLOC_TAGS) ? ",\n" : "\n");
+	}
+	file << "]}\n";
+
+	return file.good();
+}
+
+#if defined(GAME_TRACK_ALLOCATIONS)
+//------------------------------------------------------------------------------------------------------------------------------
+// Every block carries its size and tag in front of it. 16 bytes keeps the alignment malloc gave us
+//------------------------------------------------------------------------------------------------------------------------------
+struct alignas(16) AllocationHeader
+{
+	size_t					m_numBytes;
+	eAllocationTag			m_tag;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void* TrackedAlloc(size_t numBytes)
+{
+	AllocationHeader* header = static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + numBytes));
+	if (header == nullptr)
+	{
+		return nullptr;
+	}
+
+	header->m_numBytes = numBytes;
+	header->m_tag = s_threadTag;
+	AllocationTracker::RecordAlloc(header->m_tag, numBytes);
+	return header + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void TrackedFree(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	AllocationHeader* header = static_cast<AllocationHeader*>(memory) - 1;
+	AllocationTracker::RecordFree(header->m_tag, header->m_numBytes);
+	free(header);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t numBytes)
+{
+	void* memory = TrackedAlloc(numBytes);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](size_t numBytes)
+{
+	return operator new(numBytes);
+}
+
+void* operator new(size_t numBytes, const std::nothrow_t&) noexcept
+{
+	return TrackedAlloc(numBytes);
+}
+
+void* operator new[](size_t numBytes, const std::nothrow_t&) noexcept
+{
+	return TrackedAlloc(numBytes);
+}
+
+void operator delete(void* memory) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(memory);
+}
+#endif
@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <stdint.h>
+#include <string>
+
+//#define GAME_TRACK_ALLOCATIONS	// (If uncommented) Replaces global new and delete to count heap use per subsystem tag
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eAllocationTag
+{
+	ALLOC_TAG_UNTAGGED,
+	ALLOC_TAG_GAME,
+	ALLOC_TAG_PHYSICS,
+	ALLOC_TAG_RENDER,
+	ALLOC_TAG_CONSOLE,
+	ALLOC_TAG_EVENTS,
+
+	NUM_ALLOC_TAGS
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct AllocationTagStats
+{
+	int64_t					m_numAllocsLastFrame = 0;
+	int64_t					m_bytesLastFrame = 0;
+	int64_t					m_maxAllocsPerFrame = 0;
+	int64_t					m_maxBytesPerFrame = 0;
+	int64_t					m_numAllocsSinceReset = 0;
+	int64_t					m_bytesSinceReset = 0;
+	int64_t					m_numLiveAllocs = 0;
+	int64_t					m_liveBytes = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Counts every new and delete against the tag of the scope that made it. A block remembers its tag, so freeing it from
+// another subsystem still takes the bytes off the right tag. Counting is a few relaxed atomic adds per call and is only
+// compiled in with GAME_TRACK_ALLOCATIONS. App calls EndFrame once a frame to turn the running totals into per frame numbers
+//------------------------------------------------------------------------------------------------------------------------------
+class AllocationTracker
+{
+public:
+	static bool				IsCompiledIn();
+
+	//Tags allocations made on the calling thread until the previous tag is put back
+	static eAllocationTag	SetThreadTag(eAllocationTag tag);
+	static const char*		GetTagName(eAllocationTag tag);
+
+	//Called by the replaced new and delete
+	static void				RecordAlloc(eAllocationTag tag, size_t numBytes);
+	static void				RecordFree(eAllocationTag tag, size_t numBytes);
+
+	static void				EndFrame();
+	static void				ResetStats();
+
+	static AllocationTagStats	GetTagStats(eAllocationTag tag);
+	inline static int		GetNumFrames() { return s_numFrames; }
+	inline static int		GetNumQuietFrames() { return s_numQuietFrames; }
+
+	static void				PrintReport();
+	static bool				WriteReport(const std::string& filePath);
+
+private:
+	static int				s_numFrames;
+	static int				s_numQuietFrames;				// Frames with no allocations from any tag
+	static AllocationTagStats	s_frameStats[NUM_ALLOC_TAGS];
+	static int64_t			s_lastAllocCounts[NUM_ALLOC_TAGS];
+	static int64_t			s_lastByteCounts[NUM_ALLOC_TAGS];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+class AllocationTagScope
+{
+public:
+	explicit AllocationTagScope(eAllocationTag tag) { m_previousTag = AllocationTracker::SetThreadTag(tag); }
+	~AllocationTagScope() { AllocationTracker::SetThreadTag(m_previousTag); }
+
+	AllocationTagScope(const AllocationTagScope&) = delete;
+	AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+private:
+	eAllocationTag			m_previousTag = ALLOC_TAG_UNTAGGED;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+#if defined(GAME_TRACK_ALLOCATIONS)
+	#define ALLOCATION_TAG_JOIN_INNER(a, b) a##b
+	#define ALLOCATION_TAG_JOIN(a, b) ALLOCATION_TAG_JOIN_INNER(a, b)
+	#define ALLOCATION_TAG_SCOPE(tag) AllocationTagScope ALLOCATION_TAG_JOIN(allocationTagScope_, __LINE__)(tag)
+#else
+	#define ALLOCATION_TAG_SCOPE(tag)
+#endif
@@ -2,6 +2,7 @@
 #include "Game/App.hpp"
 //Engine Systems
 #include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Commons/StringUtils.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EventSystems.hpp"
@@ -14,13 +15,23 @@
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Renderer/DebugRender.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
+#include <stdlib.h>
 //Game Systems
 #include "Game/Game.hpp"
+#include "Game/AllocationTracker.hpp"
+#include "Game/FrameAllocator.hpp"
+#include "Game/FloatingPointMode.hpp"
+#include "Game/FrameProfiler.hpp"
+#include "Game/GameCursor.hpp"
+#include "Game/PhysicsWorld.hpp"
 
 //Globals
 App* g_theApp = nullptr;
 Clock* g_gameClock = nullptr;
 Clock* g_devConsoleClock = nullptr;
+PhysicsWorld* g_physicsWorld = nullptr;
+FrameAllocator* g_frameAllocator = nullptr;
+FrameProfiler* g_profiler = nullptr;
 
 //------------------------------------------------------------------------------------------------------------------------------
 App::App()
@@ -41,6 +52,96 @@ STATIC bool App::Command_Quit(EventArgs& args)
 	return true;
 }
 
+STATIC bool App::Command_Profile(EventArgs& args)
+{
+	//Plain "Profile" turns the profiler on, then prints the report on later calls
+	bool wasEnabled = g_profiler->IsEnabled();
+	bool isEnabled = args.GetValue("enabled", true);
+	g_profiler->SetEnabled(isEnabled);
+
+	if (args.GetValue("reset", false))
+	{
+		g_profiler->ResetStats();
+	}
+
+	if (isEnabled && !wasEnabled)
+	{
+		g_devConsole->PrintString(Rgba::GREEN, "Profiler on, run Profile again for the report");
+	}
+	else if (!isEnabled)
+	{
+		g_devConsole->PrintString(Rgba::WHITE, "Profiler off");
+	}
+	else
+	{
+		g_profiler->PrintReport();
+	}
+	return true;
+}
+
+STATIC bool App::Command_ProfileCapture(EventArgs& args)
+{
+	std::string filePath = args.GetValue("file", "Data/Gameplay/ProfileTrace.json");
+	int numFrames = args.GetValue("frames", PROFILER_CAPTURE_FRAMES);
+
+	g_profiler->StartCapture(filePath, numFrames);
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Capturing %d frames to %s", numFrames, filePath.c_str()));
+	return true;
+}
+
+STATIC bool App::Command_Allocations(EventArgs& args)
+{
+	if (args.GetValue("reset", false))
+	{
+		AllocationTracker::ResetStats();
+		g_devConsole->PrintString(Rgba::WHITE, "Allocation stats reset");
+		return true;
+	}
+
+	AllocationTracker::PrintReport();
+
+	std::string filePath = args.GetValue("file", "");
+	if (filePath != "" && !AllocationTracker::WriteReport(filePath))
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not write allocation report " + filePath);
+	}
+	return true;
+}
+
+STATIC bool App::Command_Deterministic(EventArgs& args)
+{
+	//Restart the scene with a fixed seed, fixed dt and per step state hashing
+	g_theApp->m_isDeterministic = args.GetValue("enabled", true);
+	g_theApp->m_deterministicSeed = static_cast<unsigned int>(args.GetValue("seed", 0));
+	g_theApp->m_referenceHashPath = args.GetValue("verify", "");
+
+	g_theApp->RestartGame();
+	return true;
+}
+
+STATIC bool App::Command_RecordInput(EventArgs& args)
+{
+	unsigned int sceneSeed = static_cast<unsigned int>(args.GetValue("seed", 0));
+	g_theApp->StartRecordingInput(sceneSeed);
+	return true;
+}
+
+STATIC bool App::Command_StopRecording(EventArgs& args)
+{
+	std::string filePath = args.GetValue("file", "Data/Gameplay/InputLog.pinput");
+	g_theApp->StopRecordingInput(filePath);
+	return true;
+}
+
+STATIC bool App::Command_ReplayInput(EventArgs& args)
+{
+	std::string filePath = args.GetValue("file", "Data/Gameplay/InputLog.pinput");
+	bool isHeadless = args.GetValue("headless", false);
+	g_theApp->m_replayHashPath = args.GetValue("hashes", "");
+	g_theApp->StartReplay(filePath, isHeadless);
+	return true;
+}
+
 void App::LoadGameBlackBoard()
 {
 	const char* xmlDocPath = "Data/Gameplay/GameConfig.xml";
@@ -74,6 +175,9 @@ void App::StartUp()
 	//Create event system
 	g_eventSystem = new EventSystems();
 
+	//Markers are free until the Profile command turns the profiler on
+	g_profiler = new FrameProfiler();
+
 	//Create the Render Context
 	//g_renderContext = new RenderContext();
 	//g_renderContext->Startup();
@@ -94,23 +198,241 @@ void App::StartUp()
 
 	//Create physics system
 	g_physicsSystem = new PhysicsSystem();
-	g_physicsSystem->SetGravity(Vec2(0.f, -9.8f));
+	g_physicsSystem->SetGravity(Vec2(0.f, WORLD_GRAVITY_Y));
+	g_physicsWorld = new PhysicsWorld(*g_physicsSystem);
+
+	//Transient per frame memory for HUD strings
+	g_frameAllocator = new FrameAllocator(FRAME_ALLOCATOR_BYTES);
 
 	//create the networking system
 	//g_networkSystem = new NetworkSystem();
 
 	//Create the game here
-	m_game = new Game();
-	m_game->StartUp();
+	RestartGame();
 	
 	g_eventSystem->SubscribeEventCallBackFn("Quit", Command_Quit);
+	g_eventSystem->SubscribeEventCallBackFn("Deterministic", Command_Deterministic);
+	g_eventSystem->SubscribeEventCallBackFn("RecordInput", Command_RecordInput);
+	g_eventSystem->SubscribeEventCallBackFn("StopRecording", Command_StopRecording);
+	g_eventSystem->SubscribeEventCallBackFn("ReplayInput", Command_ReplayInput);
+	g_eventSystem->SubscribeEventCallBackFn("Profile", Command_Profile);
+	g_eventSystem->SubscribeEventCallBackFn("ProfileCapture", Command_ProfileCapture);
+	g_eventSystem->SubscribeEventCallBackFn("Allocations", Command_Allocations);
+}
+
+void App::HandleCommandLine(const char* commandLine)
+{
+	//Supports: -scene=File -replay=File -headless -hashes=File -trace=File -traceFrames=N -physicsStats=File -allocReport=File
+	std::string arguments = commandLine;
+	std::string replayPath = "";
+	std::string scenePath = "";
+	std::string tracePath = "";
+	std::string physicsStatsPath = "";
+	int numTraceFrames = PROFILER_CAPTURE_FRAMES;
+
+	size_t tokenStart = 0;
+	while (tokenStart < arguments.size())
+	{
+		size_t tokenEnd = arguments.find(' ', tokenStart);
+		if (tokenEnd == std::string::npos)
+		{
+			tokenEnd = arguments.size();
+		}
+
+		std::string token = arguments.substr(tokenStart, tokenEnd - tokenStart);
+		if (token.find("-scene=") == 0)
+		{
+			scenePath = token.substr(7);
+		}
+		else if (token.find("-replay=") == 0)
+		{
+			replayPath = token.substr(8);
+		}
+		else if (token.find("-hashes=") == 0)
+		{
+			m_replayHashPath = token.substr(8);
+		}
+		else if (token == "-headless")
+		{
+			m_isHeadless = true;
+		}
+		else if (token.find("-trace=") == 0)
+		{
+			tracePath = token.substr(7);
+		}
+		else if (token.find("-traceFrames=") == 0)
+		{
+			numTraceFrames = atoi(token.substr(13).c_str());
+		}
+		else if (token.find("-physicsStats=") == 0)
+		{
+			physicsStatsPath = token.substr(14);
+		}
+		else if (token.find("-allocReport=") == 0)
+		{
+			m_allocationReportPath = token.substr(13);
+		}
+
+		tokenStart = tokenEnd + 1;
+	}
+
+	if (tracePath != "")
+	{
+		//A headless replay that ends first writes what it has in FinishReplay
+		g_profiler->StartCapture(tracePath, numTraceFrames);
+	}
+
+	if (scenePath != "" && !m_game->LoadMappedScene(scenePath))
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not map scene " + scenePath);
+	}
+
+	if (replayPath != "")
+	{
+		m_quitAfterReplay = m_isHeadless;
+		StartReplay(replayPath, m_isHeadless);
+	}
+
+	//After the replay has restarted the game, the stream belongs to the game it measures
+	if (physicsStatsPath != "" && !m_game->StartPhysicsStatsStream(physicsStatsPath))
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not open " + physicsStatsPath);
+	}
+}
+
+void App::RestartGame()
+{
+	//Recorded inputs are tied to a scene, a restart ends them
+	if (m_inputRecorder.IsRecording())
+	{
+		m_inputRecorder.StopRecording(m_game->GetSimulationStep());
+	}
+	m_inputRecorder.StopPlayback();
+
+	delete m_game;
+	m_game = nullptr;
+
+	//Leaving deterministic mode hands back the control word from before it. Other threads pick this up before they step
+	FloatingPointMode::SetDeterministic(m_isDeterministic);
+	FloatingPointMode::Apply();
+
+	unsigned int sceneSeed = m_deterministicSeed;
+	if (!m_isDeterministic)
+	{
+		sceneSeed = static_cast<unsigned int>(GetCurrentTimeSeconds() * 1000.0);
+	}
+	m_fixedStepAccumulator = 0.f;
+
+	m_game = new Game(sceneSeed, m_isDeterministic);
+	m_game->StartUp();
+
+	if (m_isDeterministic && m_referenceHashPath != "")
+	{
+		if (!m_game->m_stateHashLog.LoadReferenceFromFile(m_referenceHashPath))
+		{
+			g_devConsole->PrintString(Rgba::RED, "Could not load reference hashes from " + m_referenceHashPath);
+		}
+	}
+}
+
+void App::StartRecordingInput(unsigned int sceneSeed)
+{
+	m_isDeterministic = true;
+	m_deterministicSeed = sceneSeed;
+	RestartGame();
+
+	m_inputRecorder.StartRecording(sceneSeed);
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Recording input with seed %u", sceneSeed));
+}
+
+void App::StopRecordingInput(const std::string& filePath)
+{
+	if (!m_inputRecorder.IsRecording())
+	{
+		g_devConsole->PrintString(Rgba::RED, "Not recording input");
+		return;
+	}
+
+	m_inputRecorder.StopRecording(m_game->GetSimulationStep());
+	if (m_inputRecorder.SaveToFile(filePath))
+	{
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Saved %d inputs over %d steps to %s", m_inputRecorder.GetNumInputs(), m_inputRecorder.GetNumSteps(), filePath.c_str()));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not write input log to " + filePath);
+	}
+}
+
+void App::StartReplay(const std::string& filePath, bool isHeadless)
+{
+	if (!m_inputRecorder.LoadFromFile(filePath))
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not load input log from " + filePath);
+		return;
+	}
+
+	m_isDeterministic = true;
+	m_deterministicSeed = m_inputRecorder.GetSceneSeed();
+	RestartGame();
+
+	//Keep the live mouse out of the replay
+	m_game->SetCursorOverride(Vec2(WORLD_CENTER_X, WORLD_CENTER_Y));
+
+	m_isHeadless = isHeadless;
+	m_replayStartTime = GetCurrentTimeSeconds();
+	m_inputRecorder.StartPlayback();
+}
+
+void App::FinishReplay()
+{
+	double replaySeconds = GetCurrentTimeSeconds() - m_replayStartTime;
+	int numSteps = m_game->GetSimulationStep();
+
+	m_inputRecorder.StopPlayback();
+	m_game->ClearCursorOverride();
+	m_isHeadless = false;
+
+	std::string summary = Stringf("Replay finished: %d steps in %.3f seconds, final state hash %016llx", numSteps, replaySeconds, static_cast<unsigned long long>(m_game->ComputeStateHash()));
+	g_devConsole->PrintString(Rgba::GREEN, summary);
+	printf("\n%s", summary.c_str());
+
+	if (m_replayHashPath != "")
+	{
+		m_game->m_stateHashLog.SaveToFile(m_replayHashPath);
+	}
+
+	if (g_profiler->IsCapturing())
+	{
+		g_profiler->StopCapture();
+	}
+
+	if (m_quitAfterReplay)
+	{
+		HandleQuitRequested();
+	}
 }
 
 void App::ShutDown()
 {
+	//Before anything is freed, so live bytes describe the running game
+	if (m_allocationReportPath != "" && !AllocationTracker::WriteReport(m_allocationReportPath))
+	{
+		printf("\nCould not write allocation report %s", m_allocationReportPath.c_str());
+	}
+
+	//Don't lose a capture that was still running
+	g_profiler->StopCapture();
+
 	m_game->ShutDown();
 	delete m_game;
 
+	delete g_physicsWorld;
+	g_physicsWorld = nullptr;
+
+	delete g_frameAllocator;
+	g_frameAllocator = nullptr;
+
 	delete g_renderContext;
 	g_renderContext = nullptr;
 
@@ -128,44 +450,88 @@ void App::ShutDown()
 
 	delete g_eventSystem;
 	g_eventSystem = nullptr;
+
+	delete g_profiler;
+	g_profiler = nullptr;
 }
 
 void App::RunFrame()
 {
+	g_profiler->BeginFrame();
+
+	{
+		PROFILE_SCOPE("Frame");
+
+		BeginFrame();	
 	
-	BeginFrame();	
-	
-	Update();
-	Render();	
+		if (m_isHeadless)
+		{
+			//Headless replay runs the simulation as fast as it can and skips rendering
+			UpdateHeadless();
+		}
+		else
+		{
+			Update();
+			Render();	
+
+			PostRender();
+		}
 
-	PostRender();
+		EndFrame();
+	}
 
-	EndFrame();
+	//The frame marker has closed, fold this frame's markers into the stats
+	g_profiler->EndFrame();
+	AllocationTracker::EndFrame();
 }
 
 
 void App::EndFrame()
 {
+	PROFILE_SCOPE("App EndFrame");
+
 	g_renderContext->EndFrame();
 	g_debugRenderer->EndFrame();
 	g_inputSystem->EndFrame();
 	g_audio->EndFrame();
-	g_eventSystem->EndFrame();
-	g_devConsole->EndFrame();
+
+	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+		g_eventSystem->EndFrame();
+	}
+
+	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_CONSOLE);
+		g_devConsole->EndFrame();
+	}
 }
 
 void App::BeginFrame()
 {
+	PROFILE_SCOPE("App BeginFrame");
+
+	g_frameAllocator->Reset();
+
 	g_renderContext->BeginFrame();
 	g_debugRenderer->BeginFrame();
 	g_inputSystem->BeginFrame();
 	g_audio->BeginFrame();
-	g_eventSystem->BeginFrame();
-	g_devConsole->BeginFrame();
+
+	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+		g_eventSystem->BeginFrame();
+	}
+
+	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_CONSOLE);
+		g_devConsole->BeginFrame();
+	}
 }
 
 void App::Update()
 {	
+	PROFILE_SCOPE("App Update");
+
 	m_timeAtLastFrameBegin = m_timeAtThisFrameBegin;
 	m_timeAtThisFrameBegin = GetCurrentTimeSeconds();
 	float deltaTime = static_cast<float>(m_timeAtThisFrameBegin - m_timeAtLastFrameBegin);
@@ -174,7 +540,10 @@ void App::Update()
 	g_gameClock->Step(deltaTime);
 	g_devConsoleClock->Step(deltaTime);
 
-	g_devConsole->UpdateConsole((float)g_devConsoleClock->GetFrameTime());
+	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_CONSOLE);
+		g_devConsole->UpdateConsole((float)g_devConsoleClock->GetFrameTime());
+	}
 
 	deltaTime = (float)g_gameClock->GetFrameTime();
 	if(deltaTime == 0.f)
@@ -183,16 +552,117 @@ void App::Update()
 	}
 
 	g_debugRenderer->Update(deltaTime);
-	m_game->Update(deltaTime);
 
+	if(m_isDeterministic)
+	{
+		UpdateFixedStep(deltaTime);
+	}
+	else
+	{
+		m_game->Update(deltaTime);
+	}
+}
+
+void App::UpdateFixedStep(float deltaTime)
+{
+	//The game only ever sees DETERMINISTIC_TIME_STEP so results do not depend on the frame rate
+	m_fixedStepAccumulator += deltaTime;
+
+	int numSteps = 0;
+	while (m_fixedStepAccumulator >= DETERMINISTIC_TIME_STEP && numSteps < MAX_FIXED_STEPS_PER_FRAME)
+	{
+		if (m_inputRecorder.IsPlaying() && m_game->GetSimulationStep() >= m_inputRecorder.GetNumSteps())
+		{
+			FinishReplay();
+		}
+
+		StepGame();
+		m_fixedStepAccumulator -= DETERMINISTIC_TIME_STEP;
+		numSteps++;
+	}
+
+	if (numSteps == MAX_FIXED_STEPS_PER_FRAME)
+	{
+		//Too far behind, drop the time instead of spiraling
+		m_fixedStepAccumulator = 0.f;
+	}
+}
+
+void App::UpdateHeadless()
+{
+	PROFILE_SCOPE("Headless Steps");
+
+	for (int stepIndex = 0; stepIndex < HEADLESS_STEPS_PER_FRAME; stepIndex++)
+	{
+		if (m_game->GetSimulationStep() >= m_inputRecorder.GetNumSteps())
+		{
+			FinishReplay();
+			return;
+		}
+
+		StepGame();
+	}
+}
+
+void App::StepGame()
+{
+	int step = m_game->GetSimulationStep();
+	if (m_inputRecorder.IsPlaying())
+	{
+		DispatchReplayedInputs(step);
+	}
+
+	m_game->Update(DETERMINISTIC_TIME_STEP);
+
+	//Grabbed objects follow the cursor every step, so drags need the cursor path too
+	if (m_inputRecorder.IsRecording() && m_game->m_selectedGeometry != nullptr)
+	{
+		m_inputRecorder.RecordInput(INPUT_CURSOR_MOVE, step, m_game->m_gameCursor->GetCursorPositon());
+	}
+}
+
+void App::RecordGameInput(eRecordedInputType type, unsigned char keyCode, float value)
+{
+	if (!m_inputRecorder.IsRecording())
+	{
+		return;
+	}
+
+	m_inputRecorder.RecordInput(type, m_game->GetSimulationStep(), m_game->GetCursorWorldPosition(), keyCode, value);
+}
+
+void App::DispatchReplayedInputs(int step)
+{
+	RecordedInput input;
+	while (m_inputRecorder.GetNextInputForStep(step, input))
+	{
+		m_game->SetCursorOverride(Vec2(input.m_cursorX, input.m_cursorY));
+
+		switch (input.m_type)
+		{
+		case INPUT_KEY_PRESSED:		m_game->HandleKeyPressed(input.m_keyCode);		break;
+		case INPUT_KEY_RELEASED:	m_game->HandleKeyReleased(input.m_keyCode);		break;
+		case INPUT_MOUSE_LB_DOWN:	m_game->HandleMouseLBDown();					break;
+		case INPUT_MOUSE_LB_UP:		m_game->HandleMouseLBUp();						break;
+		case INPUT_MOUSE_RB_DOWN:	m_game->HandleMouseRBDown();					break;
+		case INPUT_MOUSE_RB_UP:		m_game->HandleMouseRBUp();						break;
+		case INPUT_MOUSE_SCROLL:	m_game->HandleMouseScroll(input.m_value);		break;
+		case INPUT_CURSOR_MOVE:
+		default:
+		break;
+		}
+	}
 }
 
 void App::Render() const
 {
+	PROFILE_SCOPE("App Render");
+
 	m_game->Render();
 
 	if (g_devConsole->IsOpen())
 	{
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_CONSOLE);
 		g_renderContext->BindShader(m_game->m_shader);
 		g_renderContext->BindTextureViewWithSampler(0U, m_game->m_squirrelFont->GetTexture());
 		g_renderContext->SetModelMatrix(Matrix44::IDENTITY);
@@ -202,6 +672,8 @@ void App::Render() const
 
 void App::PostRender()
 {
+	PROFILE_SCOPE("App PostRender");
+
 	m_game->PostRender();
 }
 
@@ -214,6 +686,8 @@ bool App::HandleKeyPressed(unsigned char keyCode)
 
 	if (g_devConsole->IsOpen())
 	{
+		//Console commands run from here
+		ALLOCATION_TAG_SCOPE(ALLOC_TAG_CONSOLE);
 		g_devConsole->HandleKeyDown(keyCode);
 		return true;
 	}
@@ -245,6 +719,20 @@ bool App::HandleKeyPressed(unsigned char keyCode)
 			g_gameClock->ForceStep(0.1f);
 		}
 		break;
+		case 'Q':
+		case 'E':
+		{
+			//Scrub the rewind buffer. Not recorded, a replay should not jump around in time
+			if (m_inputRecorder.IsPlaying() || m_inputRecorder.IsRecording())
+			{
+				return true;
+			}
+
+			//Hold the world on the scrubbed frame until the clock is resumed
+			g_gameClock->Pause();
+			m_game->ScrubTimeline(keyCode == 'Q' ? -1 : 1);
+		}
+		break;
 		case UP_ARROW:
 		case RIGHT_ARROW:
 		case LEFT_ARROW:
@@ -283,15 +771,17 @@ bool App::HandleKeyPressed(unsigned char keyCode)
 		case NUM_9:
 		case NUM_0:
 		case LCTRL_KEY:
+			if (m_inputRecorder.IsPlaying())
+			{
+				return true;
+			}
+			RecordGameInput(INPUT_KEY_PRESSED, keyCode);
 			m_game->HandleKeyPressed(keyCode);
 			return true;
 		break;
 		case F8_KEY:
 		//Kill and restart the app
-		delete m_game;
-		m_game = nullptr;
-		m_game = new Game();
-		m_game->StartUp();
+		RestartGame();
 		return true;
 		break;
 		case KEY_ESC:
@@ -333,6 +823,11 @@ bool App::HandleKeyReleased(unsigned char keyCode)
 		case LEFT_ARROW:
 		case DOWN_ARROW:
 		case SPACE_KEY:
+			if (m_inputRecorder.IsPlaying())
+			{
+				return true;
+			}
+			RecordGameInput(INPUT_KEY_RELEASED, keyCode);
 			m_game->HandleKeyReleased(keyCode);
 			return true;
 		break;
@@ -356,29 +851,54 @@ bool App::HandleCharacter( unsigned char charCode )
 bool App::HandleMouseLBDown()
 {
 	//Implement Mouse Left button down logic here
+	if (m_inputRecorder.IsPlaying())
+	{
+		return true;
+	}
+	RecordGameInput(INPUT_MOUSE_LB_DOWN);
 	return m_game->HandleMouseLBDown();
 }
 
 bool App::HandleMouseLBUp()
 {
 	//Implement Mouse Left button Up logic here
+	if (m_inputRecorder.IsPlaying())
+	{
+		return true;
+	}
+	RecordGameInput(INPUT_MOUSE_LB_UP);
 	return m_game->HandleMouseLBUp();
 }
 
 bool App::HandleMouseRBDown()
 {
 	//Implement Mouse Right Button Down logic here
+	if (m_inputRecorder.IsPlaying())
+	{
+		return true;
+	}
+	RecordGameInput(INPUT_MOUSE_RB_DOWN);
 	return m_game->HandleMouseRBDown();
 }
 
 bool App::HandleMouseRBUp()
 {
 	//Implement Mouse Right Button Up logic here
+	if (m_inputRecorder.IsPlaying())
+	{
+		return true;
+	}
+	RecordGameInput(INPUT_MOUSE_RB_UP);
 	return m_game->HandleMouseRBUp();	
 }
 
 bool App::HandleMouseScroll(float wheelDelta)
 {
+	if (m_inputRecorder.IsPlaying())
+	{
+		return true;
+	}
+	RecordGameInput(INPUT_MOUSE_SCROLL, 0, wheelDelta);
 	return m_game->HandleMouseScroll(wheelDelta);
 }
 
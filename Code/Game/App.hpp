@@ -2,6 +2,7 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
+#include "Game/InputRecorder.hpp"
 
 //------------------------------------------------------------------------------------------------------------------------------
 class Game;
@@ -14,11 +15,19 @@ public:
 	~App();
 	
 	static bool			Command_Quit(EventArgs& args);
+	static bool			Command_Deterministic(EventArgs& args);
+	static bool			Command_RecordInput(EventArgs& args);
+	static bool			Command_StopRecording(EventArgs& args);
+	static bool			Command_ReplayInput(EventArgs& args);
+	static bool			Command_Profile(EventArgs& args);
+	static bool			Command_ProfileCapture(EventArgs& args);
+	static bool			Command_Allocations(EventArgs& args);
 
 	void				LoadGameBlackBoard();
 	void				StartUp();
 	void				ShutDown();
 	void				RunFrame();
+	void				HandleCommandLine(const char* commandLine);
 
 	bool				IsQuitting() const { return m_isQuitting; }
 	bool				HandleKeyPressed( unsigned char keyCode );
@@ -34,6 +43,13 @@ public:
 	inline float		GetMouseScroll() { return m_scrollValue; }
 	bool				HandleQuitRequested();
 
+	inline Game*		GetGame() const { return m_game; }
+	void				RestartGame();
+
+	void				StartRecordingInput(unsigned int sceneSeed);
+	void				StopRecordingInput(const std::string& filePath);
+	void				StartReplay(const std::string& filePath, bool isHeadless);
+
 private:
 	void				BeginFrame();
 	void				Update();
@@ -41,6 +57,14 @@ private:
 	void				PostRender();
 	void				EndFrame();
 
+	void				UpdateFixedStep(float deltaTime);
+	void				UpdateHeadless();
+	void				StepGame();
+
+	void				RecordGameInput(eRecordedInputType type, unsigned char keyCode = 0, float value = 0.f);
+	void				DispatchReplayedInputs(int step);
+	void				FinishReplay();
+
 private:
 	bool				m_isQuitting = false;
 	bool				m_isPaused = false;
@@ -53,4 +77,20 @@ private:
 
 	float				m_scrollValue = 0.f;
 
+	//Deterministic simulation
+	bool				m_isDeterministic = false;
+	unsigned int		m_deterministicSeed = 0U;
+	std::string			m_referenceHashPath = "";
+	float				m_fixedStepAccumulator = 0.f;
+
+	//Input recording and replay
+	InputRecorder		m_inputRecorder;
+	bool				m_isHeadless = false;
+	bool				m_quitAfterReplay = false;
+	std::string			m_replayHashPath = "";
+	double				m_replayStartTime = 0.0;
+
+	//Allocation report written on shutdown, for headless runs
+	std::string			m_allocationReportPath = "";
+
 };
\ No newline at end of file
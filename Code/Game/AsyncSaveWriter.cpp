@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/AsyncSaveWriter.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+AsyncSaveWriter::AsyncSaveWriter(SaveCompleteCallback callback)
+	: m_callback(callback)
+{
+	m_thread = std::thread(&AsyncSaveWriter::WriterThreadMain, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+AsyncSaveWriter::~AsyncSaveWriter()
+{
+	//Pending saves still get written, the thread only quits once the queue is empty
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void AsyncSaveWriter::AcquireSnapshot(WorldSnapshot& out_snapshot)
+{
+	out_snapshot.m_records.clear();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_freeBuffers.empty())
+	{
+		out_snapshot.m_records.swap(m_freeBuffers.back());
+		m_freeBuffers.pop_back();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void AsyncSaveWriter::QueueSave(const std::string& filePath, eSaveFormat format, WorldSnapshot& snapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_pendingJobs.emplace_back();
+		SaveJob& job = m_pendingJobs.back();
+		job.m_filePath = filePath;
+		job.m_format = format;
+		job.m_snapshot.m_records.swap(snapshot.m_records);
+
+		m_numInFlight++;
+	}
+
+	m_wakeCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void AsyncSaveWriter::DispatchCompletedSaves()
+{
+	std::vector<SaveResult> completedSaves;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completedSaves.swap(m_completedSaves);
+	}
+
+	if (m_callback == nullptr)
+	{
+		return;
+	}
+
+	for (int index = 0; index < (int)completedSaves.size(); index++)
+	{
+		m_callback(completedSaves[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool AsyncSaveWriter::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_numInFlight > 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void AsyncSaveWriter::WriterThreadMain()
+{
+	while (true)
+	{
+		SaveJob job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this]() { return m_isQuitting || !m_pendingJobs.empty(); });
+
+			if (m_pendingJobs.empty())
+			{
+				//Quitting and nothing left to write
+				return;
+			}
+
+			job.m_filePath.swap(m_pendingJobs.front().m_filePath);
+			job.m_format = m_pendingJobs.front().m_format;
+			job.m_snapshot.m_records.swap(m_pendingJobs.front().m_snapshot.m_records);
+			m_pendingJobs.pop_front();
+		}
+
+		SaveResult result;
+		result.m_filePath = job.m_filePath;
+		result.m_numRecords = static_cast<int>(job.m_snapshot.m_records.size());
+
+		double startTime = GetCurrentTimeSeconds();
+		result.m_succeeded = WriteAndReplace(job);
+		result.m_writeSeconds = GetCurrentTimeSeconds() - startTime;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_completedSaves.push_back(result);
+			m_freeBuffers.emplace_back();
+			m_freeBuffers.back().swap(job.m_snapshot.m_records);
+			m_numInFlight--;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool AsyncSaveWriter::WriteAndReplace(const SaveJob& job)
+{
+	std::string tempPath = job.m_filePath + ".tmp";
+
+	bool wroteFile = false;
+	if (job.m_format == SAVE_FORMAT_XML)
+	{
+		wroteFile = job.m_snapshot.SaveToXmlFile(tempPath);
+	}
+	else
+	{
+		wroteFile = job.m_snapshot.SaveToFile(tempPath);
+	}
+
+	if (!wroteFile)
+	{
+		DeleteFileA(tempPath.c_str());
+		return false;
+	}
+
+	//Atomic on the same volume, readers see either the old file or the new one
+	return MoveFileExA(tempPath.c_str(), job.m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Game/WorldSnapshot.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eSaveFormat
+{
+	SAVE_FORMAT_SNAPSHOT,
+	SAVE_FORMAT_XML
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SaveResult
+{
+	std::string				m_filePath;
+	bool					m_succeeded = false;
+	int						m_numRecords = 0;
+	double					m_writeSeconds = 0.0;
+};
+
+typedef void (*SaveCompleteCallback)(const SaveResult& result);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Writes captured world state on its own thread. The game thread only pays for filling the record buffer.
+// Files are written next to the target and renamed over it, so a crash mid save never leaves a broken file
+//------------------------------------------------------------------------------------------------------------------------------
+class AsyncSaveWriter
+{
+public:
+	explicit AsyncSaveWriter(SaveCompleteCallback callback);
+	~AsyncSaveWriter();
+
+	//Hands back a buffer from a finished save when there is one, so captures don't reallocate
+	void					AcquireSnapshot(WorldSnapshot& out_snapshot);
+	void					QueueSave(const std::string& filePath, eSaveFormat format, WorldSnapshot& snapshot);
+
+	//Call on the game thread, runs the completion callback for anything that finished
+	void					DispatchCompletedSaves();
+	bool					IsBusy();
+
+private:
+	struct SaveJob
+	{
+		std::string			m_filePath;
+		eSaveFormat			m_format = SAVE_FORMAT_SNAPSHOT;
+		WorldSnapshot		m_snapshot;
+	};
+
+	void					WriterThreadMain();
+	static bool				WriteAndReplace(const SaveJob& job);
+
+private:
+	SaveCompleteCallback	m_callback = nullptr;
+
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wakeCondition;
+	bool					m_isQuitting = false;
+	int						m_numInFlight = 0;
+
+	std::deque<SaveJob>		m_pendingJobs;
+	std::vector<SaveResult>	m_completedSaves;
+	std::vector<std::vector<GeometrySnapshotRecord>>	m_freeBuffers;
+};
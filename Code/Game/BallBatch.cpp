@@ -0,0 +1,457 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/BallBatch.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include <math.h>
+#include <xmmintrin.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr int BALL_BATCH_LANES = 4;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Closest point to (x, y) on the segment from start to end
+//------------------------------------------------------------------------------------------------------------------------------
+static void GetClosestPointOnSegment(float x, float y, const Vec2& start, const Vec2& end, float& out_x, float& out_y)
+{
+	float segmentX = end.x - start.x;
+	float segmentY = end.y - start.y;
+	float lengthSquared = segmentX * segmentX + segmentY * segmentY;
+
+	float fraction = 0.f;
+	if (lengthSquared > 0.f)
+	{
+		fraction = ((x - start.x) * segmentX + (y - start.y) * segmentY) / lengthSquared;
+		fraction = (fraction < 0.f) ? 0.f : ((fraction > 1.f) ? 1.f : fraction);
+	}
+
+	out_x = start.x + segmentX * fraction;
+	out_y = start.y + segmentY * fraction;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PegBoard::Build(const std::vector<Geometry*>& allGeometry, float maxBallRadius)
+{
+	m_segments.clear();
+	m_segmentBounds.clear();
+	m_maxBallRadius = maxBallRadius;
+
+	int numGeometry = static_cast<int>(allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		const Geometry* geometry = allGeometry[index];
+		if (geometry == nullptr || geometry->m_rigidbody == nullptr || geometry->m_rigidbody->GetSimulationType() != STATIC_SIMULATION)
+		{
+			continue;
+		}
+
+		Vec2 corePoints[GEOMETRY_MAX_CORE_POINTS];
+		float coreRadius = 0.f;
+		int numPoints = geometry->GetWorldCore(corePoints, coreRadius);
+		AddCore(corePoints, numPoints, coreRadius);
+	}
+
+	BuildGrid();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PegBoard::Build(const GeometrySnapshotRecord* records, int numRecords, float maxBallRadius)
+{
+	m_segments.clear();
+	m_segmentBounds.clear();
+	m_maxBallRadius = maxBallRadius;
+
+	for (int index = 0; index < numRecords; index++)
+	{
+		const GeometrySnapshotRecord& record = records[index];
+		if (record.m_simulationType != STATIC_SIMULATION)
+		{
+			continue;
+		}
+
+		//Same pose GetWorldCore reads once the record is applied to a body
+		Vec2 corePoints[GEOMETRY_MAX_CORE_POINTS];
+		float coreRadius = 0.f;
+		int numPoints = Geometry::GetShapeCore(record.GetShape(), record.m_position, record.m_bodyRotation, corePoints, coreRadius);
+		AddCore(corePoints, numPoints, coreRadius);
+	}
+
+	BuildGrid();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PegBoard::AddCore(const Vec2* corePoints, int numPoints, float coreRadius)
+{
+	if (numPoints <= 0)
+	{
+		return;
+	}
+
+	if (numPoints <= 2)
+	{
+		AddSegment(corePoints[0], corePoints[numPoints - 1], coreRadius);
+		return;
+	}
+
+	for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+	{
+		AddSegment(corePoints[pointIndex], corePoints[(pointIndex + 1) % numPoints], coreRadius);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Same counting sort as BroadphaseGrid. The grid only covers the segments, anywhere off it is too far from all of them
+//------------------------------------------------------------------------------------------------------------------------------
+void PegBoard::BuildGrid()
+{
+	m_cellStarts.assign(1, 0);
+	m_cellSegments.clear();
+	m_numCellsX = 0;
+	m_numCellsY = 0;
+
+	int numSegments = GetNumSegments();
+	if (numSegments == 0)
+	{
+		return;
+	}
+
+	AABB2 totalBounds = m_segmentBounds[0];
+	for (int segmentIndex = 1; segmentIndex < numSegments; segmentIndex++)
+	{
+		const AABB2& bounds = m_segmentBounds[segmentIndex];
+		totalBounds.m_minBounds = Vec2(fminf(totalBounds.m_minBounds.x, bounds.m_minBounds.x), fminf(totalBounds.m_minBounds.y, bounds.m_minBounds.y));
+		totalBounds.m_maxBounds = Vec2(fmaxf(totalBounds.m_maxBounds.x, bounds.m_maxBounds.x), fmaxf(totalBounds.m_maxBounds.y, bounds.m_maxBounds.y));
+	}
+
+	Vec2 extents = totalBounds.m_maxBounds - totalBounds.m_minBounds;
+	m_cellSize = m_desiredCellSize;
+	float numCellsWanted = ceilf(extents.x / m_cellSize + 0.001f) * ceilf(extents.y / m_cellSize + 0.001f);
+	if (numCellsWanted > static_cast<float>(m_maxCells))
+	{
+		m_cellSize *= sqrtf(numCellsWanted / static_cast<float>(m_maxCells)) * 1.01f;
+	}
+
+	m_origin = totalBounds.m_minBounds;
+	m_numCellsX = static_cast<int>(extents.x / m_cellSize) + 1;
+	m_numCellsY = static_cast<int>(extents.y / m_cellSize) + 1;
+	int numCells = m_numCellsX * m_numCellsY;
+
+	m_cellStarts.assign(numCells + 1, 0);
+	std::vector<int> cellCursors;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+		{
+			const AABB2& bounds = m_segmentBounds[segmentIndex];
+			int minX = static_cast<int>((bounds.m_minBounds.x - m_origin.x) / m_cellSize);
+			int maxX = static_cast<int>((bounds.m_maxBounds.x - m_origin.x) / m_cellSize);
+			int minY = static_cast<int>((bounds.m_minBounds.y - m_origin.y) / m_cellSize);
+			int maxY = static_cast<int>((bounds.m_maxBounds.y - m_origin.y) / m_cellSize);
+			maxX = (maxX >= m_numCellsX) ? m_numCellsX - 1 : maxX;
+			maxY = (maxY >= m_numCellsY) ? m_numCellsY - 1 : maxY;
+
+			for (int cellY = minY; cellY <= maxY; cellY++)
+			{
+				for (int cellX = minX; cellX <= maxX; cellX++)
+				{
+					int cellIndex = cellY * m_numCellsX + cellX;
+					if (pass == 0)
+					{
+						m_cellStarts[cellIndex + 1]++;
+					}
+					else
+					{
+						m_cellSegments[cellCursors[cellIndex]] = segmentIndex;
+						cellCursors[cellIndex]++;
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+			{
+				m_cellStarts[cellIndex + 1] += m_cellStarts[cellIndex];
+			}
+
+			m_cellSegments.resize(m_cellStarts[numCells]);
+			cellCursors.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PegBoard::AddSegment(const Vec2& start, const Vec2& end, float radius)
+{
+	PegSegment segment;
+	segment.m_start = start;
+	segment.m_end = end;
+	segment.m_radius = radius;
+	m_segments.push_back(segment);
+
+	float reach = radius + m_maxBallRadius;
+	AABB2 bounds;
+	bounds.m_minBounds = Vec2(fminf(start.x, end.x) - reach, fminf(start.y, end.y) - reach);
+	bounds.m_maxBounds = Vec2(fmaxf(start.x, end.x) + reach, fmaxf(start.y, end.y) + reach);
+	m_segmentBounds.push_back(bounds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const int* PegBoard::GetSegmentsNear(float x, float y, int& out_numSegments) const
+{
+	out_numSegments = 0;
+	if (m_cellSegments.empty())
+	{
+		return nullptr;
+	}
+
+	int cellX = static_cast<int>(floorf((x - m_origin.x) / m_cellSize));
+	int cellY = static_cast<int>(floorf((y - m_origin.y) / m_cellSize));
+	if (cellX < 0 || cellY < 0 || cellX >= m_numCellsX || cellY >= m_numCellsY)
+	{
+		return nullptr;
+	}
+
+	int cellIndex = cellY * m_numCellsX + cellX;
+	out_numSegments = m_cellStarts[cellIndex + 1] - m_cellStarts[cellIndex];
+	return m_cellSegments.data() + m_cellStarts[cellIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BallBatch::AddPocket(const GeometryShape& shape)
+{
+	PegPocket pocket;
+	pocket.m_numPoints = Geometry::GetShapeCore(shape, shape.m_position, shape.m_rotationDegrees, pocket.m_points, pocket.m_radius);
+	if (pocket.m_numPoints > 0)
+	{
+		m_pockets.push_back(pocket);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BallBatch::Reset(const std::vector<BallLaunch>& launches)
+{
+	m_numBalls = static_cast<int>(launches.size());
+	m_numLanes = (m_numBalls + BALL_BATCH_LANES - 1) / BALL_BATCH_LANES * BALL_BATCH_LANES;
+	m_numRunning = m_numBalls;
+
+	m_positionX.assign(m_numLanes, 0.f);
+	m_positionY.assign(m_numLanes, 0.f);
+	m_velocityX.assign(m_numLanes, 0.f);
+	m_velocityY.assign(m_numLanes, 0.f);
+	m_active.assign(m_numLanes, 0.f);
+	m_slowSteps.assign(m_numLanes, 0);
+	m_results.assign(m_numBalls, BallResult());
+
+	for (int ballIndex = 0; ballIndex < m_numBalls; ballIndex++)
+	{
+		m_positionX[ballIndex] = launches[ballIndex].m_position.x;
+		m_positionY[ballIndex] = launches[ballIndex].m_position.y;
+		m_velocityX[ballIndex] = launches[ballIndex].m_velocity.x;
+		m_velocityY[ballIndex] = launches[ballIndex].m_velocity.y;
+		m_active[ballIndex] = 1.f;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int BallBatch::Run(const PegBoard& board, int maxSteps)
+{
+	PROFILE_SCOPE("Ball Batch");
+
+	__m128 minX = _mm_set1_ps(m_worldBounds.m_minBounds.x - m_ballRadius);
+	__m128 minY = _mm_set1_ps(m_worldBounds.m_minBounds.y - m_ballRadius);
+	__m128 maxX = _mm_set1_ps(m_worldBounds.m_maxBounds.x + m_ballRadius);
+	__m128 maxY = _mm_set1_ps(m_worldBounds.m_maxBounds.y + m_ballRadius);
+
+	int numSubsteps = (m_numSubsteps > 0) ? m_numSubsteps : 1;
+	float subDeltaTime = m_timeStep / static_cast<float>(numSubsteps);
+	float restSpeedSquared = m_restSpeed * m_restSpeed;
+
+	int stepIndex = 0;
+	for (; stepIndex < maxSteps && m_numRunning > 0; stepIndex++)
+	{
+		for (int substepIndex = 0; substepIndex < numSubsteps; substepIndex++)
+		{
+			IntegrateLanes(subDeltaTime);
+
+			for (int ballIndex = 0; ballIndex < m_numBalls; ballIndex++)
+			{
+				if (m_active[ballIndex] != 0.f)
+				{
+					ResolveContacts(board, ballIndex);
+				}
+			}
+		}
+
+		for (int laneIndex = 0; laneIndex < m_numLanes; laneIndex += BALL_BATCH_LANES)
+		{
+			__m128 positionX = _mm_loadu_ps(&m_positionX[laneIndex]);
+			__m128 positionY = _mm_loadu_ps(&m_positionY[laneIndex]);
+			__m128 isOutside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(positionX, minX), _mm_cmpgt_ps(positionX, maxX)), _mm_or_ps(_mm_cmplt_ps(positionY, minY), _mm_cmpgt_ps(positionY, maxY)));
+			__m128 isActive = _mm_cmpneq_ps(_mm_loadu_ps(&m_active[laneIndex]), _mm_setzero_ps());
+			int leftMask = _mm_movemask_ps(_mm_and_ps(isOutside, isActive));
+
+			for (int lane = 0; lane < BALL_BATCH_LANES; lane++)
+			{
+				int ballIndex = laneIndex + lane;
+				if (leftMask & (1 << lane))
+				{
+					Finish(ballIndex, BALL_LEFT_BOARD, stepIndex + 1);
+					continue;
+				}
+
+				if (ballIndex >= m_numBalls || m_active[ballIndex] == 0.f)
+				{
+					continue;
+				}
+
+				int pocketIndex = FindPocket(m_positionX[ballIndex], m_positionY[ballIndex]);
+				if (pocketIndex >= 0)
+				{
+					Finish(ballIndex, pocketIndex, stepIndex + 1);
+					continue;
+				}
+
+				float speedSquared = m_velocityX[ballIndex] * m_velocityX[ballIndex] + m_velocityY[ballIndex] * m_velocityY[ballIndex];
+				m_slowSteps[ballIndex] = (speedSquared < restSpeedSquared) ? m_slowSteps[ballIndex] + 1 : 0;
+				if (m_slowSteps[ballIndex] >= m_restSteps)
+				{
+					Finish(ballIndex, BALL_RESTING, stepIndex + 1);
+				}
+			}
+		}
+	}
+
+	for (int ballIndex = 0; ballIndex < m_numBalls; ballIndex++)
+	{
+		if (m_active[ballIndex] != 0.f)
+		{
+			m_results[ballIndex].m_numSteps = stepIndex;
+			m_results[ballIndex].m_position = Vec2(m_positionX[ballIndex], m_positionY[ballIndex]);
+		}
+	}
+
+	return stepIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int BallBatch::FindPocket(float x, float y) const
+{
+	int numPockets = GetNumPockets();
+	for (int pocketIndex = 0; pocketIndex < numPockets; pocketIndex++)
+	{
+		const PegPocket& pocket = m_pockets[pocketIndex];
+		float reach = m_ballRadius + pocket.m_radius;
+
+		//Polygon cores wind counter clockwise, so the ball is inside when it is left of every edge
+		bool isInside = (pocket.m_numPoints > 2);
+		float closestDistanceSquared = 3.402823466e+38f;
+		int numEdges = (pocket.m_numPoints > 2) ? pocket.m_numPoints : 1;
+		for (int edgeIndex = 0; edgeIndex < numEdges; edgeIndex++)
+		{
+			const Vec2& start = pocket.m_points[edgeIndex];
+			const Vec2& end = pocket.m_points[(pocket.m_numPoints > 2) ? (edgeIndex + 1) % pocket.m_numPoints : pocket.m_numPoints - 1];
+
+			float closestX;
+			float closestY;
+			GetClosestPointOnSegment(x, y, start, end, closestX, closestY);
+			float distanceSquared = (x - closestX) * (x - closestX) + (y - closestY) * (y - closestY);
+			closestDistanceSquared = fminf(closestDistanceSquared, distanceSquared);
+
+			float cross = (end.x - start.x) * (y - start.y) - (end.y - start.y) * (x - start.x);
+			isInside = isInside && (cross >= 0.f);
+		}
+
+		if (isInside || closestDistanceSquared <= reach * reach)
+		{
+			return pocketIndex;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Semi implicit Euler on four worlds at a time. Multiplying by the active mask leaves finished balls where they stopped
+//------------------------------------------------------------------------------------------------------------------------------
+void BallBatch::IntegrateLanes(float deltaTime)
+{
+	__m128 gravityStep = _mm_set1_ps(m_gravity * deltaTime);
+	__m128 timeStep = _mm_set1_ps(deltaTime);
+
+	for (int laneIndex = 0; laneIndex < m_numLanes; laneIndex += BALL_BATCH_LANES)
+	{
+		__m128 active = _mm_loadu_ps(&m_active[laneIndex]);
+		__m128 velocityX = _mm_loadu_ps(&m_velocityX[laneIndex]);
+		__m128 velocityY = _mm_add_ps(_mm_loadu_ps(&m_velocityY[laneIndex]), _mm_mul_ps(gravityStep, active));
+		__m128 activeTimeStep = _mm_mul_ps(timeStep, active);
+
+		_mm_storeu_ps(&m_velocityY[laneIndex], velocityY);
+		_mm_storeu_ps(&m_positionX[laneIndex], _mm_add_ps(_mm_loadu_ps(&m_positionX[laneIndex]), _mm_mul_ps(velocityX, activeTimeStep)));
+		_mm_storeu_ps(&m_positionY[laneIndex], _mm_add_ps(_mm_loadu_ps(&m_positionY[laneIndex]), _mm_mul_ps(velocityY, activeTimeStep)));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BallBatch::ResolveContacts(const PegBoard& board, int ballIndex)
+{
+	float& positionX = m_positionX[ballIndex];
+	float& positionY = m_positionY[ballIndex];
+	float& velocityX = m_velocityX[ballIndex];
+	float& velocityY = m_velocityY[ballIndex];
+
+	int numSegments = 0;
+	const int* segmentIndices = board.GetSegmentsNear(positionX, positionY, numSegments);
+	for (int index = 0; index < numSegments; index++)
+	{
+		const PegSegment& segment = board.GetSegment(segmentIndices[index]);
+
+		float closestX;
+		float closestY;
+		GetClosestPointOnSegment(positionX, positionY, segment.m_start, segment.m_end, closestX, closestY);
+
+		float offsetX = positionX - closestX;
+		float offsetY = positionY - closestY;
+		float distanceSquared = offsetX * offsetX + offsetY * offsetY;
+		float reach = m_ballRadius + segment.m_radius;
+		if (distanceSquared >= reach * reach)
+		{
+			continue;
+		}
+
+		//Dead center on the segment has no direction to push out along, go up
+		float distance = sqrtf(distanceSquared);
+		float normalX = (distance > 0.f) ? offsetX / distance : 0.f;
+		float normalY = (distance > 0.f) ? offsetY / distance : 1.f;
+
+		positionX += normalX * (reach - distance);
+		positionY += normalY * (reach - distance);
+
+		float normalSpeed = velocityX * normalX + velocityY * normalY;
+		if (normalSpeed < 0.f)
+		{
+			float tangentX = velocityX - normalX * normalSpeed;
+			float tangentY = velocityY - normalY * normalSpeed;
+			float bounceSpeed = -normalSpeed * m_restitution;
+			velocityX = tangentX * (1.f - m_friction) + normalX * bounceSpeed;
+			velocityY = tangentY * (1.f - m_friction) + normalY * bounceSpeed;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BallBatch::Finish(int ballIndex, int outcome, int step)
+{
+	m_active[ballIndex] = 0.f;
+	m_numRunning--;
+
+	BallResult& result = m_results[ballIndex];
+	result.m_outcome = outcome;
+	result.m_numSteps = step;
+	result.m_position = Vec2(m_positionX[ballIndex], m_positionY[ballIndex]);
+}
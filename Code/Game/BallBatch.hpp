@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/GameCommon.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+struct GeometryShape;
+struct GeometrySnapshotRecord;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A segment grown by a radius. Discs have start == end, polygon pegs are stored as their edges with no radius
+//------------------------------------------------------------------------------------------------------------------------------
+struct PegSegment
+{
+	Vec2					m_start;
+	Vec2					m_end;
+	float					m_radius = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PegPocket
+{
+	Vec2					m_points[4];
+	int						m_numPoints = 0;
+	float					m_radius = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The static bodies of a board flattened into segments and binned into a grid. Built once and never changed after, so any
+// number of BallBatch runs on any number of threads can share one
+//------------------------------------------------------------------------------------------------------------------------------
+class PegBoard
+{
+public:
+	//Takes every static body. Segments are binned grown by maxBallRadius so a ball only ever looks at the cell it is in
+	void					Build(const std::vector<Geometry*>& allGeometry, float maxBallRadius);
+	void					Build(const GeometrySnapshotRecord* records, int numRecords, float maxBallRadius);
+
+	inline int				GetNumSegments() const { return static_cast<int>(m_segments.size()); }
+	inline float			GetMaxBallRadius() const { return m_maxBallRadius; }
+
+	//Segments near a point, nullptr and 0 off the grid
+	const int*				GetSegmentsNear(float x, float y, int& out_numSegments) const;
+	inline const PegSegment&	GetSegment(int segmentIndex) const { return m_segments[segmentIndex]; }
+
+public:
+	float					m_desiredCellSize = 8.f;
+	int						m_maxCells = 1 << 16;		// Cells get bigger rather than go over this
+
+private:
+	void					AddCore(const Vec2* corePoints, int numPoints, float coreRadius);
+	void					AddSegment(const Vec2& start, const Vec2& end, float radius);
+	void					BuildGrid();
+
+private:
+	std::vector<PegSegment>	m_segments;
+	std::vector<AABB2>		m_segmentBounds;
+
+	std::vector<int>		m_cellStarts;
+	std::vector<int>		m_cellSegments;
+	Vec2					m_origin = Vec2::ZERO;
+	float					m_cellSize = 8.f;
+	int						m_numCellsX = 0;
+	int						m_numCellsY = 0;
+	float					m_maxBallRadius = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct BallLaunch
+{
+	Vec2					m_position;
+	Vec2					m_velocity;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eBallOutcome
+{
+	BALL_RUNNING = -3,			// Still moving when the step limit ran out
+	BALL_LEFT_BOARD = -2,		// Fell or bounced out of the world bounds
+	BALL_RESTING = -1,			// Came to rest without reaching a pocket
+	// 0 and up is the pocket index
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct BallResult
+{
+	int						m_outcome = BALL_RUNNING;
+	int						m_numSteps = 0;				// Step the outcome was decided on
+	Vec2					m_position;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Many one ball worlds on the same PegBoard stepped in lockstep. Ball state is kept as arrays of floats with one ball per
+// lane, so gravity, integration and the bounds test run four worlds per SSE instruction. Contacts are resolved ball by ball
+// since balls spread into different cells. A simplified model of the engine's solver: gravity, restitution and
+// contact friction against static bodies only. It is for estimating where balls land, it will not match PhysicsSystem
+//------------------------------------------------------------------------------------------------------------------------------
+class BallBatch
+{
+public:
+	//Balls outside the bounds have left the board. Pockets are the areas a ball can finish in, numbered in the order added
+	inline void				SetWorldBounds(const AABB2& worldBounds) { m_worldBounds = worldBounds; }
+	void					AddPocket(const GeometryShape& shape);
+	inline int				GetNumPockets() const { return static_cast<int>(m_pockets.size()); }
+
+	void					Reset(const std::vector<BallLaunch>& launches);
+
+	//Steps until every ball has an outcome or maxSteps is reached. Returns the number of steps taken
+	//The board has to be built for a max ball radius of at least m_ballRadius
+	int						Run(const PegBoard& board, int maxSteps);
+
+	inline int				GetNumBalls() const { return m_numBalls; }
+	inline const std::vector<BallResult>&	GetResults() const { return m_results; }
+
+public:
+	float					m_ballRadius = 1.f;
+	float					m_gravity = WORLD_GRAVITY_Y;
+	float					m_timeStep = DETERMINISTIC_TIME_STEP;
+	int						m_numSubsteps = 4;
+	float					m_restitution = 0.5f;
+	float					m_friction = 0.1f;			// Tangential speed lost per contact
+	float					m_restSpeed = PHYSICS_AWAKE_SPEED;	// A ball this slow for m_restSteps steps has come to rest
+	int						m_restSteps = 30;
+
+private:
+	int						FindPocket(float x, float y) const;
+	void					IntegrateLanes(float deltaTime);
+	void					ResolveContacts(const PegBoard& board, int ballIndex);
+	void					Finish(int ballIndex, int outcome, int step);
+
+private:
+	AABB2					m_worldBounds;
+	std::vector<PegPocket>	m_pockets;
+
+	int						m_numBalls = 0;
+	int						m_numLanes = 0;				// m_numBalls rounded up to a whole SSE register
+	int						m_numRunning = 0;
+
+	//One entry per lane. Padding lanes and finished balls have m_active 0 so they never move
+	std::vector<float>		m_positionX;
+	std::vector<float>		m_positionY;
+	std::vector<float>		m_velocityX;
+	std::vector<float>		m_velocityY;
+	std::vector<float>		m_active;
+	std::vector<int>		m_slowSteps;
+
+	std::vector<BallResult>	m_results;
+};
@@ -0,0 +1,544 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/BroadphaseGrid.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Collider2D.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/ShapeCast.hpp"
+#include <algorithm>
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::Rebuild(const std::vector<Geometry*>& allGeometry)
+{
+	PROFILE_SCOPE("Broadphase Rebuild");
+
+	m_bodies.clear();
+
+	int numGeometry = static_cast<int>(allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		Geometry* geometry = allGeometry[index];
+		if (geometry == nullptr || geometry->m_rigidbody == nullptr)
+		{
+			continue;
+		}
+
+		BroadphaseBody body;
+		body.m_geometry = geometry;
+		body.m_bounds = geometry->GetWorldBounds();
+
+		geometry->m_broadphaseSlot = static_cast<int>(m_bodies.size());
+		m_bodies.push_back(body);
+	}
+
+	BuildCells();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::Rebuild(const std::vector<AABB2>& allBounds)
+{
+	PROFILE_SCOPE("Broadphase Rebuild");
+
+	m_bodies.resize(allBounds.size());
+	for (size_t index = 0; index < allBounds.size(); index++)
+	{
+		m_bodies[index].m_geometry = nullptr;
+		m_bodies[index].m_bounds = allBounds[index];
+		m_bodies[index].m_isRemoved = false;
+	}
+
+	BuildCells();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::BuildCells()
+{
+	if (m_bodies.empty())
+	{
+		Clear();
+		return;
+	}
+
+	AABB2 totalBounds = m_bodies[0].m_bounds;
+	for (const BroadphaseBody& body : m_bodies)
+	{
+		totalBounds.m_minBounds = Vec2(fminf(totalBounds.m_minBounds.x, body.m_bounds.m_minBounds.x), fminf(totalBounds.m_minBounds.y, body.m_bounds.m_minBounds.y));
+		totalBounds.m_maxBounds = Vec2(fmaxf(totalBounds.m_maxBounds.x, body.m_bounds.m_maxBounds.x), fmaxf(totalBounds.m_maxBounds.y, body.m_bounds.m_maxBounds.y));
+	}
+
+	//Pick the grid size, going coarser if the bodies cover more cells than we allow
+	Vec2 extents = totalBounds.m_maxBounds - totalBounds.m_minBounds;
+	m_cellSize = m_desiredCellSize;
+	float numCellsWanted = ceilf(extents.x / m_cellSize + 0.001f) * ceilf(extents.y / m_cellSize + 0.001f);
+	if (numCellsWanted > static_cast<float>(m_maxCells))
+	{
+		m_cellSize *= sqrtf(numCellsWanted / static_cast<float>(m_maxCells)) * 1.01f;
+	}
+
+	m_origin = totalBounds.m_minBounds;
+	m_numCellsX = static_cast<int>(extents.x / m_cellSize) + 1;
+	m_numCellsY = static_cast<int>(extents.y / m_cellSize) + 1;
+	int numCells = m_numCellsX * m_numCellsY;
+
+	//Count the bodies touching each cell, then turn the counts into start offsets
+	m_cellStarts.assign(numCells + 1, 0);
+	int numBodies = static_cast<int>(m_bodies.size());
+	for (int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++)
+	{
+		const AABB2& bounds = m_bodies[bodyIndex].m_bounds;
+		int minX = GetCellX(bounds.m_minBounds.x);
+		int maxX = GetCellX(bounds.m_maxBounds.x);
+		int minY = GetCellY(bounds.m_minBounds.y);
+		int maxY = GetCellY(bounds.m_maxBounds.y);
+
+		for (int cellY = minY; cellY <= maxY; cellY++)
+		{
+			for (int cellX = minX; cellX <= maxX; cellX++)
+			{
+				m_cellStarts[cellY * m_numCellsX + cellX + 1]++;
+			}
+		}
+	}
+
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		m_cellStarts[cellIndex + 1] += m_cellStarts[cellIndex];
+	}
+
+	m_cellBodies.resize(m_cellStarts[numCells]);
+	m_cellCursors.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+
+	for (int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++)
+	{
+		const AABB2& bounds = m_bodies[bodyIndex].m_bounds;
+		int minX = GetCellX(bounds.m_minBounds.x);
+		int maxX = GetCellX(bounds.m_maxBounds.x);
+		int minY = GetCellY(bounds.m_minBounds.y);
+		int maxY = GetCellY(bounds.m_maxBounds.y);
+
+		for (int cellY = minY; cellY <= maxY; cellY++)
+		{
+			for (int cellX = minX; cellX <= maxX; cellX++)
+			{
+				int cellIndex = cellY * m_numCellsX + cellX;
+				m_cellBodies[m_cellCursors[cellIndex]] = bodyIndex;
+				m_cellCursors[cellIndex]++;
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::Clear()
+{
+	m_bodies.clear();
+	m_cellStarts.assign(1, 0);
+	m_cellBodies.clear();
+	m_numCellsX = 0;
+	m_numCellsY = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::Remove(Geometry* geometry)
+{
+	int slot = geometry->m_broadphaseSlot;
+	if (slot >= 0 && slot < static_cast<int>(m_bodies.size()) && m_bodies[slot].m_geometry == geometry)
+	{
+		m_bodies[slot].m_geometry = nullptr;
+		m_bodies[slot].m_isRemoved = true;
+	}
+	geometry->m_broadphaseSlot = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::QueryAABB(const AABB2& bounds, std::vector<Geometry*>& out_geometry) const
+{
+	if (m_numCellsX == 0)
+	{
+		return;
+	}
+
+	int minX = GetCellX(bounds.m_minBounds.x);
+	int maxX = GetCellX(bounds.m_maxBounds.x);
+	int minY = GetCellY(bounds.m_minBounds.y);
+	int maxY = GetCellY(bounds.m_maxBounds.y);
+
+	for (int cellY = minY; cellY <= maxY; cellY++)
+	{
+		for (int cellX = minX; cellX <= maxX; cellX++)
+		{
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+			{
+				const BroadphaseBody& body = m_bodies[m_cellBodies[entry]];
+				if (body.m_geometry == nullptr || !DoBoundsOverlap(body.m_bounds, bounds))
+				{
+					continue;
+				}
+
+				//A body sits in every cell it touches, only report it from the cell holding the corner of the overlap
+				float overlapMinX = fmaxf(body.m_bounds.m_minBounds.x, bounds.m_minBounds.x);
+				float overlapMinY = fmaxf(body.m_bounds.m_minBounds.y, bounds.m_minBounds.y);
+				if (GetCellX(overlapMinX) == cellX && GetCellY(overlapMinY) == cellY)
+				{
+					out_geometry.push_back(body.m_geometry);
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::QueryAABB(const AABB2& bounds, std::vector<int>& out_indices) const
+{
+	if (m_numCellsX == 0)
+	{
+		return;
+	}
+
+	int minX = GetCellX(bounds.m_minBounds.x);
+	int maxX = GetCellX(bounds.m_maxBounds.x);
+	int minY = GetCellY(bounds.m_minBounds.y);
+	int maxY = GetCellY(bounds.m_maxBounds.y);
+
+	for (int cellY = minY; cellY <= maxY; cellY++)
+	{
+		for (int cellX = minX; cellX <= maxX; cellX++)
+		{
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+			{
+				int bodyIndex = m_cellBodies[entry];
+				const BroadphaseBody& body = m_bodies[bodyIndex];
+				if (body.m_isRemoved || !DoBoundsOverlap(body.m_bounds, bounds))
+				{
+					continue;
+				}
+
+				//Reported once, from the cell holding the corner of the overlap
+				float overlapMinX = fmaxf(body.m_bounds.m_minBounds.x, bounds.m_minBounds.x);
+				float overlapMinY = fmaxf(body.m_bounds.m_minBounds.y, bounds.m_minBounds.y);
+				if (GetCellX(overlapMinX) == cellX && GetCellY(overlapMinY) == cellY)
+				{
+					out_indices.push_back(bodyIndex);
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int BroadphaseGrid::CountOverlappingPairs() const
+{
+	int numPairs = 0;
+	int numCells = m_numCellsX * m_numCellsY;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		int cellX = cellIndex % m_numCellsX;
+		int cellY = cellIndex / m_numCellsX;
+		int cellEnd = m_cellStarts[cellIndex + 1];
+		for (int entryA = m_cellStarts[cellIndex]; entryA < cellEnd; entryA++)
+		{
+			const BroadphaseBody& bodyA = m_bodies[m_cellBodies[entryA]];
+			if (bodyA.m_geometry == nullptr)
+			{
+				continue;
+			}
+
+			for (int entryB = entryA + 1; entryB < cellEnd; entryB++)
+			{
+				const BroadphaseBody& bodyB = m_bodies[m_cellBodies[entryB]];
+				if (bodyB.m_geometry == nullptr || !DoBoundsOverlap(bodyA.m_bounds, bodyB.m_bounds))
+				{
+					continue;
+				}
+
+				//Both bodies share every cell their overlap touches, only count the pair in the cell holding its corner
+				float overlapMinX = fmaxf(bodyA.m_bounds.m_minBounds.x, bodyB.m_bounds.m_minBounds.x);
+				float overlapMinY = fmaxf(bodyA.m_bounds.m_minBounds.y, bodyB.m_bounds.m_minBounds.y);
+				if (GetCellX(overlapMinX) == cellX && GetCellY(overlapMinY) == cellY)
+				{
+					numPairs++;
+				}
+			}
+		}
+	}
+
+	return numPairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::QueryPoint(const Vec2& point, std::vector<Geometry*>& out_geometry) const
+{
+	if (m_numCellsX == 0)
+	{
+		return;
+	}
+
+	//The cell is clamped onto the grid, the bounds test drops its bodies if the point is really off the grid
+	AABB2 pointBounds(point, point);
+	int cellIndex = GetCellY(point.y) * m_numCellsX + GetCellX(point.x);
+	for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+	{
+		const BroadphaseBody& body = m_bodies[m_cellBodies[entry]];
+		if (body.m_geometry == nullptr || !DoBoundsOverlap(body.m_bounds, pointBounds))
+		{
+			continue;
+		}
+
+		Collider2D* collider = body.m_geometry->m_collider;
+		if (collider != nullptr && collider->Contains(point))
+		{
+			out_geometry.push_back(body.m_geometry);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BroadphaseGrid::QueryPoint(const Vec2& point, std::vector<int>& out_indices) const
+{
+	if (m_numCellsX == 0)
+	{
+		return;
+	}
+
+	AABB2 pointBounds(point, point);
+	int cellIndex = GetCellY(point.y) * m_numCellsX + GetCellX(point.x);
+	for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+	{
+		int bodyIndex = m_cellBodies[entry];
+		const BroadphaseBody& body = m_bodies[bodyIndex];
+		if (!body.m_isRemoved && DoBoundsOverlap(body.m_bounds, pointBounds))
+		{
+			out_indices.push_back(bodyIndex);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Geometry* BroadphaseGrid::QueryNearest(const Vec2& point, float radius) const
+{
+	if (m_numCellsX == 0)
+	{
+		return nullptr;
+	}
+
+	//A body within the radius has its position, and so its bounds, inside this box
+	AABB2 searchBounds(point - Vec2(radius, radius), point + Vec2(radius, radius));
+	int minX = GetCellX(searchBounds.m_minBounds.x);
+	int maxX = GetCellX(searchBounds.m_maxBounds.x);
+	int minY = GetCellY(searchBounds.m_minBounds.y);
+	int maxY = GetCellY(searchBounds.m_maxBounds.y);
+
+	Geometry* nearest = nullptr;
+	float nearestDistSq = radius * radius;
+	for (int cellY = minY; cellY <= maxY; cellY++)
+	{
+		for (int cellX = minX; cellX <= maxX; cellX++)
+		{
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+			{
+				const BroadphaseBody& body = m_bodies[m_cellBodies[entry]];
+				if (body.m_geometry == nullptr || !DoBoundsOverlap(body.m_bounds, searchBounds))
+				{
+					continue;
+				}
+
+				//Bodies in several cells are seen more than once, that's harmless for a minimum
+				Vec2 displacement = body.m_geometry->m_transform.m_position - point;
+				float distSq = displacement.x * displacement.x + displacement.y * displacement.y;
+				if (distSq < nearestDistSq)
+				{
+					nearestDistSq = distSq;
+					nearest = body.m_geometry;
+				}
+			}
+		}
+	}
+
+	return nearest;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BroadphaseGrid::CastShape(const ShapeCast& cast, BroadphaseCastScratch& scratch, CastHit& out_hit) const
+{
+	if (m_numCellsX == 0)
+	{
+		return false;
+	}
+
+	//Cells within reach of the cell under the cast center can hold a body the cast shape touches
+	float reach = cast.GetReach();
+	int reachCells = static_cast<int>(ceilf(reach / m_cellSize));
+
+	//Only the part of the cast over the grid matters
+	AABB2 gridBounds(m_origin - Vec2(reach, reach), m_origin + Vec2(m_numCellsX * m_cellSize + reach, m_numCellsY * m_cellSize + reach));
+	float enterDistance = 0.f;
+	float exitDistance = 0.f;
+	if (!ClipRayToBounds(cast.m_start, cast.m_direction, cast.m_maxDistance, gridBounds, enterDistance, exitDistance))
+	{
+		return false;
+	}
+
+	//Fresh stamp per cast, clear the marks when it wraps
+	int numBodies = static_cast<int>(m_bodies.size());
+	if (static_cast<int>(scratch.m_visitStamps.size()) < numBodies)
+	{
+		scratch.m_visitStamps.resize(numBodies, 0);
+	}
+	scratch.m_stamp++;
+	if (scratch.m_stamp == 0)
+	{
+		std::fill(scratch.m_visitStamps.begin(), scratch.m_visitStamps.end(), 0);
+		scratch.m_stamp = 1;
+	}
+
+	//Step cell to cell along the cast center line
+	Vec2 enterPoint = cast.m_start + cast.m_direction * enterDistance;
+	int cellX = GetCellX(enterPoint.x);
+	int cellY = GetCellY(enterPoint.y);
+	int stepX = (cast.m_direction.x > 0.f) ? 1 : -1;
+	int stepY = (cast.m_direction.y > 0.f) ? 1 : -1;
+
+	const float noCrossing = 3.402823466e+38f;
+	float deltaX = (cast.m_direction.x != 0.f) ? m_cellSize / fabsf(cast.m_direction.x) : noCrossing;
+	float deltaY = (cast.m_direction.y != 0.f) ? m_cellSize / fabsf(cast.m_direction.y) : noCrossing;
+	float nextX = noCrossing;
+	float nextY = noCrossing;
+	if (cast.m_direction.x != 0.f)
+	{
+		float boundaryX = m_origin.x + (cellX + ((stepX > 0) ? 1 : 0)) * m_cellSize;
+		nextX = (boundaryX - cast.m_start.x) / cast.m_direction.x;
+	}
+	if (cast.m_direction.y != 0.f)
+	{
+		float boundaryY = m_origin.y + (cellY + ((stepY > 0) ? 1 : 0)) * m_cellSize;
+		nextY = (boundaryY - cast.m_start.y) / cast.m_direction.y;
+	}
+
+	float bestDistance = cast.m_maxDistance;
+	float cellDistance = enterDistance;
+	bool didHit = false;
+	while (cellDistance <= bestDistance && cellDistance <= exitDistance)
+	{
+		int minX = (cellX - reachCells < 0) ? 0 : cellX - reachCells;
+		int maxX = (cellX + reachCells >= m_numCellsX) ? m_numCellsX - 1 : cellX + reachCells;
+		int minY = (cellY - reachCells < 0) ? 0 : cellY - reachCells;
+		int maxY = (cellY + reachCells >= m_numCellsY) ? m_numCellsY - 1 : cellY + reachCells;
+
+		for (int blockY = minY; blockY <= maxY; blockY++)
+		{
+			for (int blockX = minX; blockX <= maxX; blockX++)
+			{
+				int cellIndex = blockY * m_numCellsX + blockX;
+				for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; entry++)
+				{
+					int bodyIndex = m_cellBodies[entry];
+					if (scratch.m_visitStamps[bodyIndex] == scratch.m_stamp)
+					{
+						continue;
+					}
+					scratch.m_visitStamps[bodyIndex] = scratch.m_stamp;
+
+					const BroadphaseBody& body = m_bodies[bodyIndex];
+					if (body.m_geometry == nullptr)
+					{
+						continue;
+					}
+
+					float bodyEnter = 0.f;
+					float bodyExit = 0.f;
+					AABB2 reachBounds(body.m_bounds.m_minBounds - Vec2(reach, reach), body.m_bounds.m_maxBounds + Vec2(reach, reach));
+					if (!ClipRayToBounds(cast.m_start, cast.m_direction, bestDistance, reachBounds, bodyEnter, bodyExit))
+					{
+						continue;
+					}
+
+					if (cast.CastAgainstGeometry(*body.m_geometry, bestDistance, out_hit))
+					{
+						bestDistance = out_hit.m_distance;
+						didHit = true;
+					}
+				}
+			}
+		}
+
+		//Cells are visited in the order the cast enters them, anything past the best hit can't beat it
+		if (nextX < nextY)
+		{
+			cellX += stepX;
+			cellDistance = nextX;
+			nextX += deltaX;
+		}
+		else
+		{
+			cellY += stepY;
+			cellDistance = nextY;
+			nextY += deltaY;
+		}
+
+		if (cellX < 0 || cellX >= m_numCellsX || cellY < 0 || cellY >= m_numCellsY)
+		{
+			break;
+		}
+	}
+
+	return didHit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int BroadphaseGrid::GetCellX(float x) const
+{
+	int cellX = static_cast<int>(floorf((x - m_origin.x) / m_cellSize));
+	return (cellX < 0) ? 0 : ((cellX >= m_numCellsX) ? m_numCellsX - 1 : cellX);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int BroadphaseGrid::GetCellY(float y) const
+{
+	int cellY = static_cast<int>(floorf((y - m_origin.y) / m_cellSize));
+	return (cellY < 0) ? 0 : ((cellY >= m_numCellsY) ? m_numCellsY - 1 : cellY);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool BroadphaseGrid::DoBoundsOverlap(const AABB2& a, const AABB2& b)
+{
+	return a.m_minBounds.x <= b.m_maxBounds.x && a.m_maxBounds.x >= b.m_minBounds.x
+		&& a.m_minBounds.y <= b.m_maxBounds.y && a.m_maxBounds.y >= b.m_minBounds.y;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool BroadphaseGrid::ClipRayToBounds(const Vec2& start, const Vec2& direction, float maxDistance, const AABB2& bounds, float& out_enterDistance, float& out_exitDistance)
+{
+	float enterDistance = 0.f;
+	float exitDistance = maxDistance;
+	const float startCoords[2] = { start.x, start.y };
+	const float directionCoords[2] = { direction.x, direction.y };
+	const float minCoords[2] = { bounds.m_minBounds.x, bounds.m_minBounds.y };
+	const float maxCoords[2] = { bounds.m_maxBounds.x, bounds.m_maxBounds.y };
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (directionCoords[axis] == 0.f)
+		{
+			if (startCoords[axis] < minCoords[axis] || startCoords[axis] > maxCoords[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float nearDistance = (minCoords[axis] - startCoords[axis]) / directionCoords[axis];
+		float farDistance = (maxCoords[axis] - startCoords[axis]) / directionCoords[axis];
+		enterDistance = fmaxf(enterDistance, fminf(nearDistance, farDistance));
+		exitDistance = fminf(exitDistance, fmaxf(nearDistance, farDistance));
+	}
+
+	out_enterDistance = enterDistance;
+	out_exitDistance = exitDistance;
+	return enterDistance <= exitDistance;
+}
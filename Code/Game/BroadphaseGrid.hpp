@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include <stdint.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+struct CastHit;
+struct ShapeCast;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Per thread memory for casts, marks bodies already tested so a body spanning many cells is only tested once per cast
+//------------------------------------------------------------------------------------------------------------------------------
+struct BroadphaseCastScratch
+{
+	std::vector<uint32_t>	m_visitStamps;
+	uint32_t				m_stamp = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Uniform grid over the bounds of every body, rebuilt from scratch once per frame.
+// Cells are packed into one array by counting sort so a rebuild does not allocate once the body count settles.
+// Queries are read only and may run from several threads at once
+//------------------------------------------------------------------------------------------------------------------------------
+class BroadphaseGrid
+{
+public:
+	void					Rebuild(const std::vector<Geometry*>& allGeometry);
+	//Grid over bare bounds, for copies of the world like the render snapshot. Only the index queries see these bodies
+	void					Rebuild(const std::vector<AABB2>& allBounds);
+	void					Clear();
+
+	//Keeps a body destroyed after the rebuild out of query results
+	void					Remove(Geometry* geometry);
+
+	//Appends every body whose bounds overlap, each one once
+	void					QueryAABB(const AABB2& bounds, std::vector<Geometry*>& out_geometry) const;
+
+	//Appends every body whose collider contains the point. Only looks in the one cell under the point
+	void					QueryPoint(const Vec2& point, std::vector<Geometry*>& out_geometry) const;
+
+	//Same, reporting positions in the array the grid was built from. The point query only tests bounds
+	void					QueryAABB(const AABB2& bounds, std::vector<int>& out_indices) const;
+	void					QueryPoint(const Vec2& point, std::vector<int>& out_indices) const;
+
+	//Body whose position is closest to the point, nullptr if none is within the radius
+	Geometry*				QueryNearest(const Vec2& point, float radius) const;
+
+	//Closest body along the cast. Walks the cells under the cast in order and stops once nothing further can be closer
+	bool					CastShape(const ShapeCast& cast, BroadphaseCastScratch& scratch, CastHit& out_hit) const;
+
+	//Pairs of bodies whose bounds overlap, each pair once. What a narrowphase behind this grid would have to test
+	int						CountOverlappingPairs() const;
+
+	inline int				GetNumBodies() const { return static_cast<int>(m_bodies.size()); }
+	inline int				GetNumCells() const { return m_numCellsX * m_numCellsY; }
+	inline float			GetCellSize() const { return m_cellSize; }
+
+private:
+	struct BroadphaseBody
+	{
+		Geometry*			m_geometry = nullptr;
+		AABB2				m_bounds;
+		bool				m_isRemoved = false;
+	};
+
+	void					BuildCells();
+	int						GetCellX(float x) const;
+	int						GetCellY(float y) const;
+	static bool				DoBoundsOverlap(const AABB2& a, const AABB2& b);
+	static bool				ClipRayToBounds(const Vec2& start, const Vec2& direction, float maxDistance, const AABB2& bounds, float& out_enterDistance, float& out_exitDistance);
+
+public:
+	float					m_desiredCellSize = 10.f;
+	int						m_maxCells = 128 * 128;		// Cells grow past the desired size if the bodies spread too far
+
+private:
+	std::vector<BroadphaseBody>	m_bodies;
+	std::vector<int>		m_cellStarts;				// Index into m_cellBodies, one past the last cell too
+	std::vector<int>		m_cellCursors;
+	std::vector<int>		m_cellBodies;
+
+	Vec2					m_origin = Vec2::ZERO;
+	float					m_cellSize = 10.f;
+	int						m_numCellsX = 0;
+	int						m_numCellsY = 0;
+};
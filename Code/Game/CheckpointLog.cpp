@@ -0,0 +1,317 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/CheckpointLog.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+//Game Systems
+#include "Game/Geometry.hpp"
+#include <algorithm>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BodyStateRecord::SetFromRecord(const GeometrySnapshotRecord& record)
+{
+	m_id = record.m_id;
+	m_position = record.m_position;
+	m_rotation = record.m_rotation;
+	m_bodyRotation = record.m_bodyRotation;
+	m_velocity = record.m_velocity;
+	m_angularVelocity = record.m_angularVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BodyStateRecord::ApplyToRecord(GeometrySnapshotRecord& record) const
+{
+	record.m_position = m_position;
+	record.m_rotation = m_rotation;
+	record.m_bodyRotation = m_bodyRotation;
+	record.m_velocity = m_velocity;
+	record.m_angularVelocity = m_angularVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BodyStateRecord::SetFromGeometry(const Geometry& geometry)
+{
+	m_id = geometry.m_id;
+	m_position = geometry.m_transform.m_position;
+	m_rotation = geometry.m_transform.m_rotation;
+	m_bodyRotation = geometry.m_rigidbody->m_rotation;
+	m_velocity = geometry.m_rigidbody->m_velocity;
+	m_angularVelocity = geometry.m_rigidbody->m_angularVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BodyStateRecord::ApplyToGeometry(Geometry& geometry) const
+{
+	geometry.m_transform.m_position = m_position;
+	geometry.m_transform.m_rotation = m_rotation;
+	geometry.m_rigidbody->m_rotation = m_bodyRotation;
+	geometry.m_rigidbody->m_velocity = m_velocity;
+	geometry.m_rigidbody->m_angularVelocity = m_angularVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CheckpointLog::Begin(const std::string& pathPrefix, const WorldSnapshot& baseSnapshot)
+{
+	End();
+
+	if (!baseSnapshot.SaveToFile(GetBasePath(pathPrefix)))
+	{
+		return false;
+	}
+
+	m_deltaFile.open(GetDeltaPath(pathPrefix), std::ios::binary | std::ios::trunc);
+	if (!m_deltaFile.is_open())
+	{
+		return false;
+	}
+
+	CheckpointLogHeader header;
+	m_deltaFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_deltaFile.flush();
+
+	m_previousRecords = baseSnapshot.m_records;
+	SortByID(m_previousRecords);
+	m_numCheckpoints = 0;
+	return m_deltaFile.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CheckpointLog::Append(const WorldSnapshot& currentSnapshot, int simulationStep)
+{
+	if (!IsActive())
+	{
+		return false;
+	}
+
+	m_currentRecords = currentSnapshot.m_records;
+	SortByID(m_currentRecords);
+
+	m_upserted.clear();
+	m_destroyed.clear();
+	m_changed.clear();
+
+	//Merge walk both id sorted lists
+	size_t previousIndex = 0;
+	size_t currentIndex = 0;
+	while (previousIndex < m_previousRecords.size() || currentIndex < m_currentRecords.size())
+	{
+		if (currentIndex == m_currentRecords.size() || (previousIndex < m_previousRecords.size() && m_previousRecords[previousIndex].m_id < m_currentRecords[currentIndex].m_id))
+		{
+			m_destroyed.push_back(m_previousRecords[previousIndex].m_id);
+			previousIndex++;
+			continue;
+		}
+
+		const GeometrySnapshotRecord& current = m_currentRecords[currentIndex];
+		if (previousIndex == m_previousRecords.size() || current.m_id < m_previousRecords[previousIndex].m_id)
+		{
+			m_upserted.push_back(current);
+			currentIndex++;
+			continue;
+		}
+
+		const GeometrySnapshotRecord& previous = m_previousRecords[previousIndex];
+		if (memcmp(&previous, &current, sizeof(GeometrySnapshotRecord)) != 0)
+		{
+			if (IsStateOnlyChange(previous, current))
+			{
+				m_changed.emplace_back();
+				m_changed.back().SetFromRecord(current);
+			}
+			else
+			{
+				m_upserted.push_back(current);
+			}
+		}
+
+		previousIndex++;
+		currentIndex++;
+	}
+
+	m_numCheckpoints++;
+
+	CheckpointDeltaHeader deltaHeader;
+	deltaHeader.m_checkpointIndex = static_cast<uint32_t>(m_numCheckpoints);
+	deltaHeader.m_simulationStep = static_cast<uint32_t>(simulationStep);
+	deltaHeader.m_numUpserted = static_cast<uint32_t>(m_upserted.size());
+	deltaHeader.m_numDestroyed = static_cast<uint32_t>(m_destroyed.size());
+	deltaHeader.m_numChanged = static_cast<uint32_t>(m_changed.size());
+
+	m_deltaFile.write(reinterpret_cast<const char*>(&deltaHeader), sizeof(deltaHeader));
+	m_deltaFile.write(reinterpret_cast<const char*>(m_upserted.data()), sizeof(GeometrySnapshotRecord) * m_upserted.size());
+	m_deltaFile.write(reinterpret_cast<const char*>(m_destroyed.data()), sizeof(uint32_t) * m_destroyed.size());
+	m_deltaFile.write(reinterpret_cast<const char*>(m_changed.data()), sizeof(BodyStateRecord) * m_changed.size());
+	m_deltaFile.flush();
+
+	m_lastDeltaBytes = static_cast<int>(sizeof(deltaHeader) + sizeof(GeometrySnapshotRecord) * m_upserted.size() + sizeof(uint32_t) * m_destroyed.size() + sizeof(BodyStateRecord) * m_changed.size());
+
+	m_previousRecords.swap(m_currentRecords);
+	return m_deltaFile.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CheckpointLog::End()
+{
+	if (m_deltaFile.is_open())
+	{
+		m_deltaFile.close();
+	}
+
+	m_deltaFile.clear();
+	m_previousRecords.clear();
+	m_currentRecords.clear();
+	m_lastDeltaBytes = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bytes between the read position and the end, so counts from a header can be checked before anything is sized by them
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t GetBytesRemaining(std::ifstream& file)
+{
+	std::streampos position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streampos end = file.tellg();
+	file.seekg(position);
+	return (end > position) ? static_cast<uint64_t>(end - position) : 0U;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool CheckpointLog::Rebuild(const std::string& pathPrefix, int checkpointIndex, WorldSnapshot& out_snapshot)
+{
+	if (!out_snapshot.LoadFromFile(GetBasePath(pathPrefix)))
+	{
+		return false;
+	}
+
+	std::vector<GeometrySnapshotRecord>& records = out_snapshot.m_records;
+	SortByID(records);
+
+	if (checkpointIndex == 0)
+	{
+		return true;
+	}
+
+	std::ifstream deltaFile(GetDeltaPath(pathPrefix), std::ios::binary);
+	if (!deltaFile.is_open())
+	{
+		return false;
+	}
+
+	CheckpointLogHeader header;
+	CheckpointLogHeader expected;
+	deltaFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!deltaFile.good() || memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		return false;
+	}
+
+	std::vector<GeometrySnapshotRecord> upserted;
+	std::vector<uint32_t> destroyed;
+	std::vector<BodyStateRecord> changed;
+
+	CheckpointDeltaHeader deltaHeader;
+	while (deltaFile.read(reinterpret_cast<char*>(&deltaHeader), sizeof(deltaHeader)))
+	{
+		//A damaged header must not size the lists past what is actually there, treat it like a cut off checkpoint
+		uint64_t numBytesExpected = static_cast<uint64_t>(deltaHeader.m_numUpserted) * sizeof(GeometrySnapshotRecord)
+			+ static_cast<uint64_t>(deltaHeader.m_numDestroyed) * sizeof(uint32_t)
+			+ static_cast<uint64_t>(deltaHeader.m_numChanged) * sizeof(BodyStateRecord);
+		if (GetBytesRemaining(deltaFile) < numBytesExpected)
+		{
+			break;
+		}
+
+		upserted.resize(deltaHeader.m_numUpserted);
+		destroyed.resize(deltaHeader.m_numDestroyed);
+		changed.resize(deltaHeader.m_numChanged);
+
+		deltaFile.read(reinterpret_cast<char*>(upserted.data()), sizeof(GeometrySnapshotRecord) * upserted.size());
+		deltaFile.read(reinterpret_cast<char*>(destroyed.data()), sizeof(uint32_t) * destroyed.size());
+		deltaFile.read(reinterpret_cast<char*>(changed.data()), sizeof(BodyStateRecord) * changed.size());
+		if (!deltaFile.good())
+		{
+			//A checkpoint cut off mid write, everything before it is still valid
+			break;
+		}
+
+		//Records are kept sorted by id, so each list is applied with a binary search
+		auto findRecord = [&records](uint32_t id)
+		{
+			return std::lower_bound(records.begin(), records.end(), id, [](const GeometrySnapshotRecord& record, uint32_t value) { return record.m_id < value; });
+		};
+
+		for (int index = 0; index < (int)destroyed.size(); index++)
+		{
+			auto found = findRecord(destroyed[index]);
+			if (found != records.end() && found->m_id == destroyed[index])
+			{
+				records.erase(found);
+			}
+		}
+
+		for (int index = 0; index < (int)upserted.size(); index++)
+		{
+			auto found = findRecord(upserted[index].m_id);
+			if (found != records.end() && found->m_id == upserted[index].m_id)
+			{
+				*found = upserted[index];
+			}
+			else
+			{
+				records.insert(found, upserted[index]);
+			}
+		}
+
+		for (int index = 0; index < (int)changed.size(); index++)
+		{
+			auto found = findRecord(changed[index].m_id);
+			if (found != records.end() && found->m_id == changed[index].m_id)
+			{
+				changed[index].ApplyToRecord(*found);
+			}
+		}
+
+		if (checkpointIndex > 0 && (int)deltaHeader.m_checkpointIndex >= checkpointIndex)
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::string CheckpointLog::GetBasePath(const std::string& pathPrefix)
+{
+	return pathPrefix + ".snapshot";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::string CheckpointLog::GetDeltaPath(const std::string& pathPrefix)
+{
+	return pathPrefix + ".deltas";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void CheckpointLog::SortByID(std::vector<GeometrySnapshotRecord>& records)
+{
+	//Capture order is creation order, so this is normally already sorted
+	auto isLess = [](const GeometrySnapshotRecord& a, const GeometrySnapshotRecord& b) { return a.m_id < b.m_id; };
+	if (!std::is_sorted(records.begin(), records.end(), isLess))
+	{
+		std::sort(records.begin(), records.end(), isLess);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool CheckpointLog::IsStateOnlyChange(const GeometrySnapshotRecord& previous, const GeometrySnapshotRecord& current)
+{
+	//Copy the moving state across, if what's left matches then only the state changed
+	GeometrySnapshotRecord withCurrentState = previous;
+	BodyStateRecord state;
+	state.SetFromRecord(current);
+	state.ApplyToRecord(withCurrentState);
+
+	return memcmp(&withCurrentState, &current, sizeof(GeometrySnapshotRecord)) == 0;
+}
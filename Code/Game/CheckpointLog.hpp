@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Game/WorldSnapshot.hpp"
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Only the parts of a body that move. Anything else changing sends the whole record again
+//------------------------------------------------------------------------------------------------------------------------------
+struct BodyStateRecord
+{
+	uint32_t				m_id = 0;
+	Vec2					m_position = Vec2::ZERO;
+	float					m_rotation = 0.f;
+	float					m_bodyRotation = 0.f;
+	Vec2					m_velocity = Vec2::ZERO;
+	float					m_angularVelocity = 0.f;
+
+	void					SetFromRecord(const GeometrySnapshotRecord& record);
+	void					ApplyToRecord(GeometrySnapshotRecord& record) const;
+	void					SetFromGeometry(const Geometry& geometry);
+	void					ApplyToGeometry(Geometry& geometry) const;
+};
+
+static_assert(sizeof(BodyStateRecord) == 32, "BodyStateRecord layout changed, bump CHECKPOINT_LOG_VERSION");
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t CHECKPOINT_LOG_VERSION = 1;
+
+struct CheckpointLogHeader
+{
+	char					m_fourCC[4] = { 'P', 'C', 'H', 'K' };
+	uint32_t				m_version = CHECKPOINT_LOG_VERSION;
+	uint32_t				m_recordSize = sizeof(GeometrySnapshotRecord);
+	uint32_t				m_stateSize = sizeof(BodyStateRecord);
+};
+
+//Followed by numUpserted full records, numDestroyed ids and numChanged state records
+struct CheckpointDeltaHeader
+{
+	uint32_t				m_checkpointIndex = 0;
+	uint32_t				m_simulationStep = 0;
+	uint32_t				m_numUpserted = 0;
+	uint32_t				m_numDestroyed = 0;
+	uint32_t				m_numChanged = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One full snapshot as the base, then an append only log of what changed at each checkpoint.
+// Writes are proportional to the number of bodies that moved, spawned or died, not to the size of the board
+//------------------------------------------------------------------------------------------------------------------------------
+class CheckpointLog
+{
+public:
+	bool					Begin(const std::string& pathPrefix, const WorldSnapshot& baseSnapshot);
+	bool					Append(const WorldSnapshot& currentSnapshot, int simulationStep);
+	void					End();
+
+	inline bool				IsActive() const { return m_deltaFile.is_open(); }
+	inline int				GetNumCheckpoints() const { return m_numCheckpoints; }
+	inline int				GetLastDeltaBytes() const { return m_lastDeltaBytes; }
+
+	//checkpointIndex 0 is the base, -1 is the latest checkpoint in the log
+	static bool				Rebuild(const std::string& pathPrefix, int checkpointIndex, WorldSnapshot& out_snapshot);
+
+	static std::string		GetBasePath(const std::string& pathPrefix);
+	static std::string		GetDeltaPath(const std::string& pathPrefix);
+
+private:
+	static void				SortByID(std::vector<GeometrySnapshotRecord>& records);
+	static bool				IsStateOnlyChange(const GeometrySnapshotRecord& previous, const GeometrySnapshotRecord& current);
+
+private:
+	std::ofstream			m_deltaFile;
+	int						m_numCheckpoints = 0;
+	int						m_lastDeltaBytes = 0;
+
+	//State at the last checkpoint, sorted by id
+	std::vector<GeometrySnapshotRecord>	m_previousRecords;
+	std::vector<GeometrySnapshotRecord>	m_currentRecords;
+
+	std::vector<GeometrySnapshotRecord>	m_upserted;
+	std::vector<uint32_t>				m_destroyed;
+	std::vector<BodyStateRecord>		m_changed;
+};
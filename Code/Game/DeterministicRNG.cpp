@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/DeterministicRNG.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Squirrel style 1D noise. Integer only, so results do not depend on FP state or compiler
+//------------------------------------------------------------------------------------------------------------------------------
+static unsigned int GetNoiseUint(unsigned int position, unsigned int seed)
+{
+	constexpr unsigned int BIT_NOISE1 = 0xd2a80a3f;
+	constexpr unsigned int BIT_NOISE2 = 0xa884f197;
+	constexpr unsigned int BIT_NOISE3 = 0x6C736F4B;
+	constexpr unsigned int BIT_NOISE4 = 0xB79F3ABB;
+	constexpr unsigned int BIT_NOISE5 = 0x1b56c4f5;
+
+	unsigned int mangledBits = position;
+	mangledBits *= BIT_NOISE1;
+	mangledBits += seed;
+	mangledBits ^= (mangledBits >> 9);
+	mangledBits += BIT_NOISE2;
+	mangledBits ^= (mangledBits >> 11);
+	mangledBits *= BIT_NOISE3;
+	mangledBits ^= (mangledBits >> 13);
+	mangledBits += BIT_NOISE4;
+	mangledBits ^= (mangledBits >> 15);
+	mangledBits *= BIT_NOISE5;
+	mangledBits ^= (mangledBits >> 17);
+	return mangledBits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+DeterministicRNG::DeterministicRNG(unsigned int seed)
+{
+	Reset(seed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+DeterministicRNG::~DeterministicRNG()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DeterministicRNG::Reset(unsigned int seed, unsigned int position)
+{
+	m_seed = seed;
+	m_position = position;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+unsigned int DeterministicRNG::GetRandomUint()
+{
+	return GetNoiseUint(m_position++, m_seed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float DeterministicRNG::GetRandomFloatZeroToOne()
+{
+	//Use the top 24 bits so every value is exactly representable as a float
+	constexpr float ONE_OVER_2_POW_24 = 1.f / 16777216.f;
+	return static_cast<float>(GetRandomUint() >> 8) * ONE_OVER_2_POW_24;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float DeterministicRNG::GetRandomFloatInRange(float minInclusive, float maxInclusive)
+{
+	return minInclusive + (maxInclusive - minInclusive) * GetRandomFloatZeroToOne();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int DeterministicRNG::GetRandomIntInRange(int minInclusive, int maxInclusive)
+{
+	unsigned int range = static_cast<unsigned int>(maxInclusive - minInclusive) + 1U;
+	return minInclusive + static_cast<int>(GetRandomUint() % range);
+}
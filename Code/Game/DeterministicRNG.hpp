@@ -0,0 +1,28 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Seeded, position based random number generator used for everything that affects the simulation.
+// Each value is a pure hash of (seed, position), so the sequence is identical on every machine and can be
+// rewound or restored by saving the seed and position.
+//------------------------------------------------------------------------------------------------------------------------------
+class DeterministicRNG
+{
+public:
+	explicit DeterministicRNG(unsigned int seed = 0U);
+	~DeterministicRNG();
+
+	void					Reset(unsigned int seed, unsigned int position = 0U);
+
+	unsigned int			GetRandomUint();
+	float					GetRandomFloatZeroToOne();
+	float					GetRandomFloatInRange(float minInclusive, float maxInclusive);
+	int						GetRandomIntInRange(int minInclusive, int maxInclusive);
+
+	inline unsigned int		GetSeed() const		{ return m_seed; }
+	inline unsigned int		GetPosition() const	{ return m_position; }
+
+private:
+	unsigned int			m_seed = 0U;
+	unsigned int			m_position = 0U;
+};
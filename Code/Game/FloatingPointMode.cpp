@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/FloatingPointMode.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <atomic>
+#include <float.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+#if defined(_M_IX86)
+constexpr unsigned int DETERMINISTIC_FP_MASK = _MCW_RC | _MCW_DN | _MCW_PC;		// x87 precision only exists on 32 bit builds
+#else
+constexpr unsigned int DETERMINISTIC_FP_MASK = _MCW_RC | _MCW_DN;
+#endif
+
+static std::atomic<bool> s_isDeterministic(false);
+static thread_local bool s_isApplied = false;
+static thread_local unsigned int s_savedControlWord = 0;
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void FloatingPointMode::SetDeterministic(bool isDeterministic)
+{
+	s_isDeterministic.store(isDeterministic);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool FloatingPointMode::IsDeterministic()
+{
+	return s_isDeterministic.load();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void FloatingPointMode::Apply()
+{
+	bool isDeterministic = s_isDeterministic.load();
+	if (isDeterministic == s_isApplied)
+	{
+		return;
+	}
+
+	unsigned int controlWord = 0;
+	if (isDeterministic)
+	{
+		//Same rounding and denormal handling on every machine
+		_controlfp_s(&s_savedControlWord, 0, 0);
+		_controlfp_s(&controlWord, _RC_NEAR, _MCW_RC);
+		_controlfp_s(&controlWord, _DN_FLUSH, _MCW_DN);
+#if defined(_M_IX86)
+		_controlfp_s(&controlWord, _PC_53, _MCW_PC);
+#endif
+	}
+	else
+	{
+		_controlfp_s(&controlWord, s_savedControlWord & DETERMINISTIC_FP_MASK, DETERMINISTIC_FP_MASK);
+	}
+
+	s_isApplied = isDeterministic;
+}
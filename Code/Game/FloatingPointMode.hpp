@@ -0,0 +1,18 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Rounding and denormal handling for deterministic runs. The FP control word belongs to each thread, so the requested
+// mode is kept here and every thread that steps physics applies it before stepping. Each thread remembers its own
+// control word from before the mode was applied and gets it back when the mode is turned off
+//------------------------------------------------------------------------------------------------------------------------------
+class FloatingPointMode
+{
+public:
+	//Takes effect on each thread at its next Apply
+	static void				SetDeterministic(bool isDeterministic);
+	static bool				IsDeterministic();
+
+	//Puts the calling thread in the requested mode, or restores its previous control word. Cheap when nothing changed
+	static void				Apply();
+};
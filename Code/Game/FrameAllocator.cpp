@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/FrameAllocator.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameAllocator::FrameAllocator(size_t capacityBytes)
+{
+	m_capacity = capacityBytes;
+	m_buffer = static_cast<char*>(malloc(m_capacity));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameAllocator::~FrameAllocator()
+{
+	Reset();
+	free(m_buffer);
+	m_buffer = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* FrameAllocator::Allocate(size_t numBytes, size_t alignment)
+{
+	size_t start = (m_bytesUsed + alignment - 1) & ~(alignment - 1);
+	if (start + numBytes <= m_capacity)
+	{
+		m_bytesUsed = start + numBytes;
+		if (m_bytesUsed > m_highWaterMark)
+		{
+			m_highWaterMark = m_bytesUsed;
+		}
+		return m_buffer + start;
+	}
+
+	//Out of frame memory. malloc is aligned enough for anything we put in here
+	m_numOverflows++;
+	m_overflowBytes += numBytes;
+	char* block = static_cast<char*>(malloc(numBytes));
+	m_overflowBlocks.push_back(block);
+	return block;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const char* FrameAllocator::Format(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	//Try writing straight into what is left, most strings fit first time
+	size_t start = m_bytesUsed;
+	size_t available = (start < m_capacity) ? m_capacity - start : 0;
+	int length = vsnprintf(m_buffer + start, available, format, args);
+	va_end(args);
+
+	if (length < 0)
+	{
+		return "";
+	}
+
+	if (static_cast<size_t>(length) < available)
+	{
+		return static_cast<char*>(Allocate(length + 1, 1));
+	}
+
+	char* text = static_cast<char*>(Allocate(length + 1, 1));
+	va_start(args, format);
+	vsnprintf(text, length + 1, format, args);
+	va_end(args);
+	return text;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameAllocator::Reset()
+{
+	if (!m_overflowBlocks.empty())
+	{
+		for (size_t blockIndex = 0; blockIndex < m_overflowBlocks.size(); blockIndex++)
+		{
+			free(m_overflowBlocks[blockIndex]);
+		}
+		m_overflowBlocks.clear();
+
+		//Nothing points into the buffer between frames, grow it so the next frame fits
+		m_capacity = (m_highWaterMark + m_overflowBytes) * 2;
+		free(m_buffer);
+		m_buffer = static_cast<char*>(malloc(m_capacity));
+		m_overflowBytes = 0;
+	}
+
+	m_bytesUsed = 0;
+}
@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <stddef.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bump allocator for data that only lives until the end of the frame. Reset in App::BeginFrame.
+// Running out spills to the heap for the rest of the frame and the next Reset grows the buffer to fit
+//------------------------------------------------------------------------------------------------------------------------------
+class FrameAllocator
+{
+public:
+	explicit FrameAllocator(size_t capacityBytes);
+	~FrameAllocator();
+
+	FrameAllocator(const FrameAllocator&) = delete;
+	FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+	void*					Allocate(size_t numBytes, size_t alignment = 16);
+
+	template <typename T>
+	T*						AllocateArray(int count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+	//printf into frame memory, the string is gone after the next Reset
+	const char*				Format(const char* format, ...);
+
+	void					Reset();
+
+	inline size_t			GetCapacity() const { return m_capacity; }
+	inline size_t			GetBytesUsed() const { return m_bytesUsed; }
+	inline size_t			GetHighWaterMark() const { return m_highWaterMark; }
+	inline int				GetNumOverflows() const { return m_numOverflows; }
+
+private:
+	char*					m_buffer = nullptr;
+	size_t					m_capacity = 0;
+	size_t					m_bytesUsed = 0;
+	size_t					m_highWaterMark = 0;
+
+	std::vector<char*>		m_overflowBlocks;
+	size_t					m_overflowBytes = 0;
+	int						m_numOverflows = 0;
+};
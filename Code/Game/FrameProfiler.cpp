@@ -0,0 +1,355 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/FrameProfiler.hpp"
+//Engine Systems
+#include "Engine/Commons/StringUtils.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Hands the thread's buffer back when the thread exits, so short lived worker threads don't grow the buffer list
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileThreadHandle
+{
+	~ProfileThreadHandle()
+	{
+		if (m_buffer != nullptr && g_profiler != nullptr)
+		{
+			g_profiler->ReleaseThreadBuffer(m_buffer);
+		}
+	}
+
+	ProfileThreadBuffer*	m_buffer = nullptr;
+};
+
+static thread_local ProfileThreadHandle s_threadHandle;
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameProfiler::FrameProfiler()
+{
+	m_frameEvents.reserve(256);
+
+	//The creating thread is the main thread, give it the first lane
+	GetThreadBuffer();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameProfiler::~FrameProfiler()
+{
+	for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size(); bufferIndex++)
+	{
+		delete m_threadBuffers[bufferIndex];
+	}
+	m_threadBuffers.clear();
+
+	//The calling thread's handle outlives us
+	s_threadHandle.m_buffer = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::SetEnabled(bool isEnabled)
+{
+	if (isEnabled && !m_isEnabled)
+	{
+		ResetStats();
+	}
+	m_isEnabled = isEnabled;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::BeginFrame()
+{
+	m_frameStartSeconds = GetCurrentTimeSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::EndFrame()
+{
+	//Take what every thread recorded since last frame
+	m_frameEvents.clear();
+	{
+		std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+		for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size(); bufferIndex++)
+		{
+			ProfileThreadBuffer& buffer = *m_threadBuffers[bufferIndex];
+			std::lock_guard<std::mutex> bufferLock(buffer.m_mutex);
+			m_frameEvents.insert(m_frameEvents.end(), buffer.m_events.begin(), buffer.m_events.end());
+			buffer.m_events.clear();
+		}
+	}
+
+	if (!m_isEnabled)
+	{
+		return;
+	}
+
+	if (m_isCapturing)
+	{
+		if (m_numCapturedFrames == 0)
+		{
+			m_captureStartSeconds = m_frameStartSeconds;
+		}
+		m_captureEvents.insert(m_captureEvents.end(), m_frameEvents.begin(), m_frameEvents.end());
+		m_numCapturedFrames++;
+		m_captureFramesLeft--;
+	}
+
+	//Parents start before their children, so new markers get listed in tree order
+	std::sort(m_frameEvents.begin(), m_frameEvents.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+	{
+		return (a.m_laneIndex != b.m_laneIndex) ? a.m_laneIndex < b.m_laneIndex : a.m_startSeconds < b.m_startSeconds;
+	});
+
+	for (size_t markerIndex = 0; markerIndex < m_markerStats.size(); markerIndex++)
+	{
+		m_markerStats[markerIndex].m_thisFrameSeconds = 0.0;
+		m_markerStats[markerIndex].m_thisFrameCalls = 0;
+	}
+
+	for (size_t eventIndex = 0; eventIndex < m_frameEvents.size(); eventIndex++)
+	{
+		AccumulateEvent(m_frameEvents[eventIndex]);
+	}
+
+	for (size_t markerIndex = 0; markerIndex < m_markerStats.size(); markerIndex++)
+	{
+		ProfileMarkerStats& marker = m_markerStats[markerIndex];
+		marker.m_frameMS[m_historyIndex] = static_cast<float>(marker.m_thisFrameSeconds * 1000.0);
+		marker.m_numCallsLastFrame = marker.m_thisFrameCalls;
+		if (marker.m_numFrames < PROFILER_HISTORY_FRAMES)
+		{
+			marker.m_numFrames++;
+		}
+	}
+
+	m_historyIndex = (m_historyIndex + 1) % PROFILER_HISTORY_FRAMES;
+	if (m_numFramesRecorded < PROFILER_HISTORY_FRAMES)
+	{
+		m_numFramesRecorded++;
+	}
+
+	if (m_isCapturing && m_captureFramesLeft <= 0)
+	{
+		StopCapture();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int FrameProfiler::PushScope()
+{
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	int depth = buffer->m_depth;
+	buffer->m_depth++;
+	return depth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::PopScope(const char* name, double startSeconds, int depth)
+{
+	ProfileEvent event;
+	event.m_name = name;
+	event.m_startSeconds = startSeconds;
+	event.m_endSeconds = GetCurrentTimeSeconds();
+	event.m_depth = depth;
+
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	buffer->m_depth = depth;
+	event.m_laneIndex = buffer->m_laneIndex;
+
+	std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+	buffer->m_events.push_back(event);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::ReleaseThreadBuffer(ProfileThreadBuffer* buffer)
+{
+	std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+	buffer->m_depth = 0;
+	buffer->m_isInUse = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::ResetStats()
+{
+	m_markerStats.clear();
+	m_historyIndex = 0;
+	m_numFramesRecorded = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::PrintReport() const
+{
+	if (m_numFramesRecorded == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, "Profiler has no frames recorded, enable it with Profile enabled=true");
+		return;
+	}
+
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Profile over the last %d frames (ms)      avg      min      max   calls", m_numFramesRecorded));
+	for (size_t markerIndex = 0; markerIndex < m_markerStats.size(); markerIndex++)
+	{
+		const ProfileMarkerStats& marker = m_markerStats[markerIndex];
+
+		float minMS = marker.m_frameMS[0];
+		float maxMS = marker.m_frameMS[0];
+		float totalMS = 0.f;
+		for (int frameIndex = 0; frameIndex < marker.m_numFrames; frameIndex++)
+		{
+			int ringIndex = (m_historyIndex - 1 - frameIndex + PROFILER_HISTORY_FRAMES) % PROFILER_HISTORY_FRAMES;
+			float frameMS = marker.m_frameMS[ringIndex];
+			minMS = (frameIndex == 0 || frameMS < minMS) ? frameMS : minMS;
+			maxMS = (frameIndex == 0 || frameMS > maxMS) ? frameMS : maxMS;
+			totalMS += frameMS;
+		}
+		float averageMS = (marker.m_numFrames > 0) ? totalMS / static_cast<float>(marker.m_numFrames) : 0.f;
+
+		std::string label = std::string(marker.m_depth * 2, ' ') + marker.m_name;
+		g_devConsole->PrintString(Rgba::WHITE, Stringf("%-40s %8.3f %8.3f %8.3f %7d", label.c_str(), averageMS, minMS, maxMS, marker.m_numCallsLastFrame));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::StartCapture(const std::string& filePath, int numFrames)
+{
+	if (!m_isCapturing)
+	{
+		m_wasEnabledBeforeCapture = m_isEnabled;
+	}
+
+	SetEnabled(true);
+	m_isCapturing = true;
+	m_captureFilePath = filePath;
+	m_captureFramesLeft = (numFrames > 0) ? numFrames : 1;
+	m_numCapturedFrames = 0;
+	m_captureEvents.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool FrameProfiler::StopCapture()
+{
+	if (!m_isCapturing)
+	{
+		return false;
+	}
+
+	m_isCapturing = false;
+	SetEnabled(m_wasEnabledBeforeCapture);
+
+	bool didWrite = WriteTraceFile(m_captureFilePath);
+	if (didWrite)
+	{
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Wrote %d frames, %d markers to %s", m_numCapturedFrames, (int)m_captureEvents.size(), m_captureFilePath.c_str()));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not write trace " + m_captureFilePath);
+	}
+
+	m_captureEvents.clear();
+	m_captureEvents.shrink_to_fit();
+	return didWrite;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool FrameProfiler::WriteTraceFile(const std::string& filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	//Complete events ("ph":"X") in microseconds from the first captured frame, one tid per profiler lane
+	int numLanes = 0;
+	file << "{\"traceEvents\":[\n";
+	file.setf(std::ios::fixed);
+	file.precision(3);
+	for (size_t eventIndex = 0; eventIndex < m_captureEvents.size(); eventIndex++)
+	{
+		const ProfileEvent& event = m_captureEvents[eventIndex];
+		double startMicroseconds = (event.m_startSeconds - m_captureStartSeconds) * 1000000.0;
+		double durationMicroseconds = (event.m_endSeconds - event.m_startSeconds) * 1000000.0;
+		file << "{\"name\":\"" << event.m_name << "\",\"cat\":\"game\",\"ph\":\"X\",\"ts\":" << startMicroseconds << ",\"dur\":" << durationMicroseconds << ",\"pid\":1,\"tid\":" << event.m_laneIndex << "},\n";
+
+		numLanes = (event.m_laneIndex + 1 > numLanes) ? event.m_laneIndex + 1 : numLanes;
+	}
+
+	//Metadata goes last so every event line above can end in a comma
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Pachinko\"}}";
+	for (int laneIndex = 0; laneIndex < numLanes; laneIndex++)
+	{
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << laneIndex << ",\"args\":{\"name\":\"";
+		if (laneIndex == 0)
+		{
+			file << "Main Thread";
+		}
+		else
+		{
+			file << "Worker " << laneIndex;
+		}
+		file << "\"}}";
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfileThreadBuffer* FrameProfiler::GetThreadBuffer()
+{
+	if (s_threadHandle.m_buffer != nullptr)
+	{
+		return s_threadHandle.m_buffer;
+	}
+
+	std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+	ProfileThreadBuffer* buffer = nullptr;
+	for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size() && buffer == nullptr; bufferIndex++)
+	{
+		if (!m_threadBuffers[bufferIndex]->m_isInUse)
+		{
+			buffer = m_threadBuffers[bufferIndex];
+		}
+	}
+
+	if (buffer == nullptr)
+	{
+		buffer = new ProfileThreadBuffer();
+		buffer->m_laneIndex = static_cast<int>(m_threadBuffers.size());
+		m_threadBuffers.push_back(buffer);
+	}
+
+	buffer->m_isInUse = true;
+	s_threadHandle.m_buffer = buffer;
+	return buffer;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameProfiler::AccumulateEvent(const ProfileEvent& event)
+{
+	ProfileMarkerStats& marker = FindOrAddMarker(event.m_name, event.m_depth);
+	marker.m_thisFrameSeconds += event.m_endSeconds - event.m_startSeconds;
+	marker.m_thisFrameCalls++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfileMarkerStats& FrameProfiler::FindOrAddMarker(const char* name, int depth)
+{
+	//The same literal can have different addresses in different files, fall back to comparing the text
+	for (size_t markerIndex = 0; markerIndex < m_markerStats.size(); markerIndex++)
+	{
+		ProfileMarkerStats& marker = m_markerStats[markerIndex];
+		if (marker.m_name == name || strcmp(marker.m_name, name) == 0)
+		{
+			return marker;
+		}
+	}
+
+	m_markerStats.emplace_back();
+	ProfileMarkerStats& marker = m_markerStats.back();
+	marker.m_name = name;
+	marker.m_depth = depth;
+	marker.m_frameMS.assign(PROFILER_HISTORY_FRAMES, 0.f);
+	return marker;
+}
@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Core/Time.hpp"
+#include "Game/GameCommon.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
+
+//#define GAME_DISABLE_PROFILING	// (If uncommented) Compiles every PROFILE_SCOPE marker out of the build
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileEvent
+{
+	const char*				m_name = nullptr;		// Must outlive the profiler, markers use string literals
+	double					m_startSeconds = 0.0;
+	double					m_endSeconds = 0.0;
+	int						m_depth = 0;
+	int						m_laneIndex = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Events from one thread. Only its thread writes to it, the profiler takes the events at the end of every frame
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileThreadBuffer
+{
+	std::mutex				m_mutex;
+	std::vector<ProfileEvent>	m_events;
+	int						m_depth = 0;
+	int						m_laneIndex = 0;			// Stable per buffer, buffers are reused when threads exit
+	bool					m_isInUse = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Rolling per frame totals for one marker name
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileMarkerStats
+{
+	const char*				m_name = nullptr;
+	int						m_depth = 0;
+	std::vector<float>		m_frameMS;					// Ring of the last PROFILER_HISTORY_FRAMES frames
+	int						m_numFrames = 0;			// Frames since the marker was first seen, up to the ring size
+	int						m_numCallsLastFrame = 0;
+	double					m_thisFrameSeconds = 0.0;
+	int						m_thisFrameCalls = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Scoped timing markers gathered per thread and folded into rolling min/avg/max per marker once a frame.
+// A capture keeps every marker for a number of frames and writes them as a trace event JSON file, which Chrome's
+// about:tracing and Perfetto open with one lane per thread. When disabled a marker costs one branch.
+// App calls BeginFrame and EndFrame around every frame
+//------------------------------------------------------------------------------------------------------------------------------
+class FrameProfiler
+{
+public:
+	FrameProfiler();
+	~FrameProfiler();
+
+	inline bool				IsEnabled() const { return m_isEnabled; }
+	void					SetEnabled(bool isEnabled);
+
+	void					BeginFrame();
+	void					EndFrame();
+
+	//Called by ProfileScope, and when a thread exits so its buffer can be reused
+	int						PushScope();
+	void					PopScope(const char* name, double startSeconds, int depth);
+	void					ReleaseThreadBuffer(ProfileThreadBuffer* buffer);
+
+	//Forgets all history
+	void					ResetStats();
+	void					PrintReport() const;
+
+	//Turns the profiler on for numFrames frames, then writes the trace. StopCapture writes whatever was captured so far
+	void					StartCapture(const std::string& filePath, int numFrames);
+	bool					StopCapture();
+	inline bool				IsCapturing() const { return m_isCapturing; }
+
+	inline int				GetNumFramesRecorded() const { return m_numFramesRecorded; }
+	inline const std::vector<ProfileEvent>&	GetLastFrameEvents() const { return m_frameEvents; }
+	inline const std::vector<ProfileMarkerStats>&	GetMarkerStats() const { return m_markerStats; }
+
+private:
+	ProfileThreadBuffer*	GetThreadBuffer();
+	void					AccumulateEvent(const ProfileEvent& event);
+	ProfileMarkerStats&		FindOrAddMarker(const char* name, int depth);
+	bool					WriteTraceFile(const std::string& filePath) const;
+
+private:
+	bool					m_isEnabled = false;
+
+	std::mutex				m_buffersMutex;
+	std::vector<ProfileThreadBuffer*>	m_threadBuffers;
+
+	std::vector<ProfileEvent>	m_frameEvents;			// Every event from the last EndFrame, kept for reuse
+	std::vector<ProfileMarkerStats>	m_markerStats;
+	double					m_frameStartSeconds = 0.0;
+	int						m_historyIndex = 0;
+	int						m_numFramesRecorded = 0;
+
+	bool					m_isCapturing = false;
+	bool					m_wasEnabledBeforeCapture = false;
+	std::string				m_captureFilePath;
+	int						m_captureFramesLeft = 0;
+	int						m_numCapturedFrames = 0;
+	double					m_captureStartSeconds = 0.0;
+	std::vector<ProfileEvent>	m_captureEvents;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+	{
+		if (g_profiler != nullptr && g_profiler->IsEnabled())
+		{
+			m_name = name;
+			m_depth = g_profiler->PushScope();
+			m_startSeconds = GetCurrentTimeSeconds();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (m_name != nullptr && g_profiler != nullptr)
+		{
+			g_profiler->PopScope(m_name, m_startSeconds, m_depth);
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char*				m_name = nullptr;
+	double					m_startSeconds = 0.0;
+	int						m_depth = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+#if defined(GAME_DISABLE_PROFILING)
+	#define PROFILE_SCOPE(name)
+#else
+	#define PROFILE_SCOPE_JOIN_INNER(a, b) a##b
+	#define PROFILE_SCOPE_JOIN(a, b) PROFILE_SCOPE_JOIN_INNER(a, b)
+	#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_JOIN(profileScope_, __LINE__)(name)
+#endif
@@ -4,6 +4,7 @@
 #include "Engine/Commons/ErrorWarningAssert.hpp"
 #include "Engine/Commons/StringUtils.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EventSystems.hpp"
 #include "Engine/Core/VertexUtils.hpp"
@@ -13,7 +14,6 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/PhysicsSystem.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
-#include "Engine/Math/RigidBodyBucket.hpp"
 #include "Engine/Math/Trigger2D.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Renderer/Camera.hpp"
@@ -22,9 +22,23 @@
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include <ThirdParty/TinyXML2/tinyxml2.h>
+#include <algorithm>
 
 //Game systems
+#include "Game/AllocationTracker.hpp"
+#include "Game/App.hpp"
+#include "Game/AsyncSaveWriter.hpp"
+#include "Game/BallBatch.hpp"
+#include "Game/FrameAllocator.hpp"
+#include "Game/FrameProfiler.hpp"
 #include "Game/GameCursor.hpp"
+#include "Game/MappedFile.hpp"
+#include "Game/PhysicsWorld.hpp"
+#include "Game/PhysicsWorldRunner.hpp"
+#include "Game/SimulationThread.hpp"
+#include "Game/StaticBoard.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include "Game/XmlStreamReader.hpp"
 
 //Globals
 Rgba* g_clearScreenColor = nullptr;
@@ -32,14 +46,14 @@ float g_shakeAmount = 0.0f;
 RandomNumberGenerator* g_randomNumGen;
 bool g_debugMode = false;
 
-eSimulationType g_selectedSimType = STATIC_SIMULATION;
 
 //Extern 
+extern App* g_theApp;
 extern RenderContext* g_renderContext;
 extern AudioSystem* g_audio;
 
 //------------------------------------------------------------------------------------------------------------------------------
-Game::Game()
+Game::Game(unsigned int sceneSeed, bool isDeterministic)
 {
 	m_isGameAlive = true;
 	m_squirrelFont = g_renderContext->CreateOrGetBitmapFontFromFile("SquirrelFixedFont");
@@ -48,6 +62,14 @@ Game::Game()
 	g_debugRenderer->SetDebugFont(m_squirrelFont);
 	g_randomNumGen = new RandomNumberGenerator();
 
+	//Everything that can change the simulation draws from the scene RNG
+	m_sceneSeed = sceneSeed;
+	m_isDeterministic = isDeterministic;
+	g_physicsWorld->GetRNG().Reset(m_sceneSeed);
+
+	m_saveWriter = new AsyncSaveWriter(OnSaveComplete);
+	m_lastAutosaveTime = GetCurrentTimeSeconds();
+
 	g_devConsole->PrintString(Rgba::BLUE, "this is a test string");
 	g_devConsole->PrintString(Rgba::RED, "this is also a test string");
 	g_devConsole->PrintString(Rgba::GREEN, "damn this dev console lit!");
@@ -63,14 +85,47 @@ Game::Game()
 
 	g_eventSystem->SubscribeEventCallBackFn("CapsuleTriggerEnter", CapsuleTriggerEnter);
 	g_eventSystem->SubscribeEventCallBackFn("CapsuleTriggerExit", CapsuleTriggerExit);
+
+	g_eventSystem->SubscribeEventCallBackFn("SaveStateHashes", Command_SaveStateHashes);
+	g_eventSystem->SubscribeEventCallBackFn("SaveSnapshot", Command_SaveSnapshot);
+	g_eventSystem->SubscribeEventCallBackFn("LoadSnapshot", Command_LoadSnapshot);
+	g_eventSystem->SubscribeEventCallBackFn("LoadMappedScene", Command_LoadMappedScene);
+	g_eventSystem->SubscribeEventCallBackFn("Autosave", Command_Autosave);
+	g_eventSystem->SubscribeEventCallBackFn("StartCheckpoints", Command_StartCheckpoints);
+	g_eventSystem->SubscribeEventCallBackFn("StopCheckpoints", Command_StopCheckpoints);
+	g_eventSystem->SubscribeEventCallBackFn("LoadCheckpoint", Command_LoadCheckpoint);
+	g_eventSystem->SubscribeEventCallBackFn("RecordHistory", Command_RecordHistory);
+	g_eventSystem->SubscribeEventCallBackFn("SaveHistory", Command_SaveHistory);
+	g_eventSystem->SubscribeEventCallBackFn("Rewind", Command_Rewind);
+	g_eventSystem->SubscribeEventCallBackFn("GeometryRender", Command_GeometryRender);
+	g_eventSystem->SubscribeEventCallBackFn("Culling", Command_Culling);
+	g_eventSystem->SubscribeEventCallBackFn("PhysicsStats", Command_PhysicsStats);
+	g_eventSystem->SubscribeEventCallBackFn("CastPreview", Command_CastPreview);
+	g_eventSystem->SubscribeEventCallBackFn("PhysicsStream", Command_PhysicsStream);
+	g_eventSystem->SubscribeEventCallBackFn("WorldBench", Command_WorldBench);
+	g_eventSystem->SubscribeEventCallBackFn("BallBatch", Command_BallBatch);
+	g_eventSystem->SubscribeEventCallBackFn("SimThread", Command_SimThread);
+
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Scene seed : %u %s", m_sceneSeed, m_isDeterministic ? "(Deterministic)" : ""));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 Game::~Game()
 {
 	m_isGameAlive = false;
+
+	delete m_simulationThread;
+	m_simulationThread = nullptr;
+
+	//The board stays with the world for the next game to pick up, everything else goes now
+	DestroyAllGeometry();
+
 	delete m_mainCamera;
 	m_mainCamera = nullptr;
+
+	//Finishes any queued saves before returning
+	delete m_saveWriter;
+	m_saveWriter = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -90,32 +145,51 @@ void Game::StartUp()
 	Vec2 minWorldBounds = Vec2(20.f, -20.f);
 	Vec2 maxWorldBounds = Vec2(WORLD_WIDTH, WORLD_HEIGHT) + Vec2(-20.f, 20.f);
 	m_worldBounds = AABB2(minWorldBounds, maxWorldBounds);
-
-	//Create the static floor object
-	Geometry* geometry = new Geometry(*g_physicsSystem, STATIC_SIMULATION, BOX_GEOMETRY, Vec2(150.f, 10.f), 0.f, 0.f, Vec2(150.f, 10.f), true);
-	geometry->m_rigidbody->m_mass = INFINITY;
-	geometry->m_collider->SetMomentForObject();
-	geometry->m_collider->SetCollisionEvent("StaticCollisionEvent");
-	m_allGeometry.push_back(geometry);
+	m_rewindTimeline.Reset(m_worldBounds, REWIND_CAPACITY_FRAMES);
+
+	//The static floor is the default board. A restart finds it still attached and keeps its body
+	GeometrySnapshotRecord floorRecord;
+	floorRecord.m_geometryType = BOX_GEOMETRY;
+	floorRecord.m_simulationType = STATIC_SIMULATION;
+	floorRecord.m_size = Vec2(80.f, 10.f);
+	floorRecord.m_position = Vec2(150.f, 10.f);
+	floorRecord.m_mass = INFINITY;
+	if (AttachStaticBoard(&floorRecord, 1))
+	{
+		Geometry* geometry = m_allGeometry[0];
+		geometry->m_collider->SetMomentForObject();
+		geometry->m_collider->SetCollisionEvent("StaticCollisionEvent");
+	}
 
 	//Create an OBB trigger to test
-	m_boxTrigger = g_physicsSystem->CreateTrigger(STATIC_SIMULATION);
-	m_boxTrigger->SetCollider(new BoxCollider2D(Vec2(30.f, 10.f), Vec2(5.f, 5.f), 0.f));
+	m_boxTriggerShape.m_geometryType = BOX_GEOMETRY;
+	m_boxTriggerShape.m_position = Vec2(30.f, 10.f);
+	m_boxTriggerShape.m_size = Vec2(5.f, 5.f);
+	PhysicsSystem& physicsSystem = g_physicsWorld->GetPhysicsSystem();
+	m_boxTrigger = physicsSystem.CreateTrigger(STATIC_SIMULATION);
+	m_boxTrigger->SetCollider(new BoxCollider2D(m_boxTriggerShape.m_position, m_boxTriggerShape.m_size, m_boxTriggerShape.m_rotationDegrees));
 	m_boxTrigger->m_collider->SetColliderType(COLLIDER_BOX);
 	m_boxTrigger->SetOnEnterEvent("BoxTriggerEnter");
 	m_boxTrigger->SetOnExitEvent("BoxTriggerExit");
-	g_physicsSystem->AddTriggerToVector(m_boxTrigger);
+	physicsSystem.AddTriggerToVector(m_boxTrigger);
+	g_physicsWorld->OnTriggerAdded();
 
 	//Create a capsule trigger to test
-	m_capsuleTrigger = g_physicsSystem->CreateTrigger(STATIC_SIMULATION);
-	m_capsuleTrigger->SetCollider(new CapsuleCollider2D(Vec2(50.f, 40.f), Vec2(80.f, 40.f), 5.f));
+	m_capsuleTriggerShape.m_geometryType = CAPSULE_GEOMETRY;
+	m_capsuleTriggerShape.m_position = Vec2(65.f, 40.f);
+	m_capsuleTriggerShape.m_start = Vec2(50.f, 40.f);
+	m_capsuleTriggerShape.m_end = Vec2(80.f, 40.f);
+	m_capsuleTriggerShape.m_radius = 5.f;
+	m_capsuleTrigger = physicsSystem.CreateTrigger(STATIC_SIMULATION);
+	m_capsuleTrigger->SetCollider(new CapsuleCollider2D(m_capsuleTriggerShape.m_start, m_capsuleTriggerShape.m_end, m_capsuleTriggerShape.m_radius));
 	m_capsuleTrigger->m_collider->SetColliderType(COLLIDER_CAPSULE);
 	Transform2 transform;
-	transform.m_position = Vec2(65.f, 40.f);
+	transform.m_position = m_capsuleTriggerShape.m_position;
 	m_capsuleTrigger->SetTransform(transform);
 	m_capsuleTrigger->SetOnEnterEvent("CapsuleTriggerEnter");
 	m_capsuleTrigger->SetOnExitEvent("CapsuleTriggerExit");
-	g_physicsSystem->AddTriggerToVector(m_capsuleTrigger);
+	physicsSystem.AddTriggerToVector(m_capsuleTrigger);
+	g_physicsWorld->OnTriggerAdded();
 
 
 	//Create the Camera and setOrthoView
@@ -157,7 +231,9 @@ STATIC bool Game::TestEvent(EventArgs& args)
 STATIC bool Game::StaticCollisionEvent(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::YELLOW, "Collision Event Called for Static Object");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnContactEvent();
+	PrintSimulationMessage(Rgba::YELLOW, "Collision Event Called for Static Object");
 	return true;
 }
 
@@ -165,7 +241,9 @@ STATIC bool Game::StaticCollisionEvent(EventArgs& args)
 bool Game::DynamicCollisionEvent(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::GREEN, "Collision Event Called for Dynamic Object");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnContactEvent();
+	PrintSimulationMessage(Rgba::GREEN, "Collision Event Called for Dynamic Object");
 	return true;
 }
 
@@ -173,7 +251,9 @@ bool Game::DynamicCollisionEvent(EventArgs& args)
 STATIC bool Game::BoxTriggerEnter(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::YELLOW, "Box Trigger Enter");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnTriggerEnter();
+	PrintSimulationMessage(Rgba::YELLOW, "Box Trigger Enter");
 	return true;
 }
 
@@ -181,7 +261,9 @@ STATIC bool Game::BoxTriggerEnter(EventArgs& args)
 STATIC bool Game::BoxTriggerExit(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::GREEN, "Box Trigger Exit");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnTriggerExit();
+	PrintSimulationMessage(Rgba::GREEN, "Box Trigger Exit");
 	return true;
 }
 
@@ -189,7 +271,9 @@ STATIC bool Game::BoxTriggerExit(EventArgs& args)
 STATIC bool Game::CapsuleTriggerEnter(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::YELLOW, "Capsule Trigger Enter");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnTriggerEnter();
+	PrintSimulationMessage(Rgba::YELLOW, "Capsule Trigger Enter");
 	return true;
 }
 
@@ -197,1309 +281,2485 @@ STATIC bool Game::CapsuleTriggerEnter(EventArgs& args)
 STATIC bool Game::CapsuleTriggerExit(EventArgs& args)
 {
 	UNUSED(args);
-	g_devConsole->PrintString(Rgba::GREEN, "Capsule Trigger Exit");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_EVENTS);
+	g_physicsWorld->OnTriggerExit();
+	PrintSimulationMessage(Rgba::GREEN, "Capsule Trigger Exit");
 	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleKeyPressed(unsigned char keyCode)
+STATIC bool Game::Command_SaveStateHashes(EventArgs& args)
 {
-	if (g_devConsole->IsOpen())
+	std::string filePath = args.GetValue("file", "Data/Gameplay/StateHashes.txt");
+
+	Game* game = g_theApp->GetGame();
+	if (game->m_stateHashLog.SaveToFile(filePath))
 	{
-		g_devConsole->HandleKeyDown(keyCode);
-		return;
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Saved %d step hashes to %s", game->m_stateHashLog.GetNumSteps(), filePath.c_str()));
 	}
-
-	switch( keyCode )
+	else
 	{
-		case W_KEY:
-		case S_KEY:
-		case A_KEY:
-		case D_KEY:
-		//m_gameCursor->HandleKeyPressed(keyCode);
-		UpdateCameraMovement(keyCode);
-		break;
-		case LCTRL_KEY:
-		{
-			m_toggleUI = !m_toggleUI;
-		}
-		break;
-		case SPACE_KEY:
-		{
-			ToggleSimType();
-			break;
-		}
-		case DEL_KEY:
-		{
-			if(m_selectedGeometry == nullptr)
-			{
-				return;
-			}
-
-			//Destroy selected object
-			delete m_selectedGeometry;
-			m_selectedGeometry = nullptr;
-			//Set the reference to the object in vector to be nullptr
-			m_allGeometry[m_selectedIndex] = nullptr;
-			break;
-		}
-		case G_KEY:
-		{
-			ChangeCurrentGeometry();
-			break;
-		}
-		case TAB_KEY:
-		{
-			break;
-		}
-		case K_KEY:
-		{
-			//Friction increase
-			m_objectFriction -= m_frictionStep;
-			m_objectFriction = Clamp(m_objectFriction, 0.f, 1.f);
-		}
-		break;
-		case L_KEY:
-		{
-			//Friction decrease
-			m_objectFriction += m_frictionStep;
-			m_objectFriction = Clamp(m_objectFriction, 0.f, 1.f);
-		}
-		break;
-		case NUM_1:
-		{
-			//Decrease Linear Drag
-			m_objectLinearDrag -= m_linearDragStep;
-		}
-		break;
-		case NUM_2:
-		{
-			//Increase Linear Drag
-			m_objectLinearDrag += m_linearDragStep;
-		}
-		break;
-		case NUM_3:
-		{
-			//Decrease Angular Drag
-			m_objectAngularDrag -= m_angularDragStep;
-		}
-		break;
-		case NUM_4:
-		{
-			//Increase Angular Drag
-			m_objectAngularDrag += m_angularDragStep;
-		}
-		break;
-		case NUM_5:
-		{
-			//Toggle X freedom
-			m_xFreedom = !m_xFreedom;
-		}
-		break;
-		case NUM_6:
-		{
-			//Toggle Y freedom
-			m_yFreedom = !m_yFreedom;
-		}
-		break;
-		case NUM_7:
-		{
-			//Toggle rotation freedom
-			m_rotationFreedom = !m_rotationFreedom;
-		}
-		break;
-		case NUM_8:
-		{
-			//Save the game
-			SaveToFile("Data/Gameplay/SaveGame.xml");
-		}
-		break;
-		case NUM_9:
-		{
-			//Load the game
-			LoadFromFile("Data/Gameplay/SaveGame.xml");
-		}
-		break;
-		case N_KEY:
-		m_objectMass -= m_massStep;
-		m_objectMass = Clamp(m_objectMass, 0.1f, 10.f);
-		break;
-		case M_KEY:
-		m_objectMass += m_massStep;
-		m_objectMass = Clamp(m_objectMass, 0.1f, 10.f);
-		break;
-		case KEY_LESSER:
-		m_objectRestitution -= m_restitutionStep;
-		m_objectRestitution = Clamp(m_objectRestitution, 0.f, 1.f);
-		break;
-		case KEY_GREATER:
-		m_objectRestitution += m_restitutionStep;
-		m_objectRestitution  = Clamp(m_objectRestitution, 0.f, 1.f);
-		break;
-		case F1_KEY:
-		{
-			break;
-		}
-		break;
-		case F2_KEY:
-		{
-			//F2 spawns a static disc on the cursor position
-			Geometry* geometry = new Geometry(*g_physicsSystem, STATIC_SIMULATION, CAPSULE_GEOMETRY, m_gameCursor->GetCursorPositon());
-			geometry->m_rigidbody->m_material.restitution = m_objectRestitution;
-			geometry->m_rigidbody->m_mass = INFINITY;
-			geometry->m_rigidbody->m_friction = m_objectFriction;
-			geometry->m_rigidbody->m_angularDrag = m_objectLinearDrag;
-			geometry->m_rigidbody->m_linearDrag = m_objectAngularDrag;
-			geometry->m_collider->SetMomentForObject();
+		g_devConsole->PrintString(Rgba::RED, Stringf("Could not write step hashes to %s", filePath.c_str()));
+	}
+	return true;
+}
 
-			m_allGeometry.push_back(geometry);
-		}
-		break;
-		case F3_KEY:
-		{
-			//F3 spawns a dynamic box on the cursor position
-			Geometry* geometry = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, BOX_GEOMETRY, m_gameCursor->GetCursorPositon(), 0.f, 3.f, m_gameCursor->GetCursorPositon() + Vec2(10.f, 10.f));
-			geometry->m_rigidbody->m_mass = m_objectMass;
-			geometry->m_rigidbody->m_friction = m_objectFriction;
-			geometry->m_rigidbody->m_angularDrag = m_objectLinearDrag;
-			geometry->m_rigidbody->m_linearDrag = m_objectAngularDrag;
-			geometry->m_collider->SetMomentForObject();
-			geometry->m_rigidbody->m_material.restitution = m_objectRestitution;
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_SaveSnapshot(EventArgs& args)
+{
+	std::string filePath = args.GetValue("file", "Data/Gameplay/SaveGame.snapshot");
 
+	//Reported through OnSaveComplete when the writer is done
+	g_theApp->GetGame()->QueueSave(filePath);
+	return true;
+}
 
-			m_allGeometry.push_back(geometry);
-		}
-		break;
-		case F4_KEY:
-		{
-			//F4 spawns a dynamic box on the cursor position (Rotated by 90 degrees
-			Geometry* geometry = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, BOX_GEOMETRY, m_gameCursor->GetCursorPositon(), 90.f, 3.f, m_gameCursor->GetCursorPositon() + Vec2(10.f, 10.f));
-			geometry->m_rigidbody->m_mass = m_objectMass;
-			geometry->m_rigidbody->m_friction = m_objectFriction;
-			geometry->m_rigidbody->m_angularDrag = m_objectLinearDrag;
-			geometry->m_rigidbody->m_linearDrag = m_objectAngularDrag;
-			geometry->m_collider->SetMomentForObject();
-			geometry->m_rigidbody->m_material.restitution = m_objectRestitution;
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_Autosave(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	game->m_autosaveIntervalSeconds = args.GetValue("interval", 30.f);
+	game->m_autosavePath = args.GetValue("file", "Data/Gameplay/AutoSave.snapshot");
+	game->m_lastAutosaveTime = GetCurrentTimeSeconds();
 
-			m_allGeometry.push_back(geometry);
-		}
-		break;
-		case F5_KEY:
-		break;
-		case F6_KEY:
-		break;
-		case F7_KEY:
-		break;
-		default:
-		break;
+	if (game->m_autosaveIntervalSeconds > 0.f)
+	{
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Autosaving to %s every %.1f seconds", game->m_autosavePath.c_str(), game->m_autosaveIntervalSeconds));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::WHITE, "Autosave off");
 	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-int Game::GetNextValidGeometryIndex(int index)
+STATIC bool Game::Command_StartCheckpoints(EventArgs& args)
 {
-	int vectorSize = static_cast<int>(m_allGeometry.size());
+	std::string pathPrefix = args.GetValue("file", "Data/Gameplay/Checkpoint");
+	float intervalSeconds = args.GetValue("interval", 5.f);
 
-	int end = index;
-	index = (index + 1) % vectorSize;
-
-	while(index != end)
+	if (g_theApp->GetGame()->StartCheckpoints(pathPrefix, intervalSeconds))
 	{
-		if(m_allGeometry[index] != nullptr)
-		{
-			return index;
-		}
-		else
-		{
-			index = (index + 1) % vectorSize;
-		}
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Checkpointing to %s every %.1f seconds", pathPrefix.c_str(), intervalSeconds));
 	}
-
-	return end;
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not start checkpoints at " + pathPrefix);
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugEnabled()
+STATIC bool Game::Command_StopCheckpoints(EventArgs& args)
 {
-	g_debugMode = !g_debugMode;
+	UNUSED(args);
+	Game* game = g_theApp->GetGame();
+
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Stopped checkpoints after %d deltas", game->m_checkpointLog.GetNumCheckpoints()));
+	game->StopCheckpoints();
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleKeyReleased(unsigned char keyCode)
+STATIC bool Game::Command_LoadCheckpoint(EventArgs& args)
 {
+	std::string pathPrefix = args.GetValue("file", "Data/Gameplay/Checkpoint");
+	int checkpointIndex = args.GetValue("index", -1);
 
-	switch( keyCode )
+	WorldSnapshot snapshot;
+	if (!CheckpointLog::Rebuild(pathPrefix, checkpointIndex, snapshot))
 	{
-		case UP_ARROW:
-		case DOWN_ARROW:
-		case RIGHT_ARROW:
-		case LEFT_ARROW:
-		m_gameCursor->HandleKeyReleased(keyCode);
-
-		break;
-		default:
-		break;
+		g_devConsole->PrintString(Rgba::RED, "Could not rebuild checkpoint from " + pathPrefix);
+		return true;
 	}
+
+	g_theApp->GetGame()->RestoreSnapshot(snapshot);
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Restored %d objects from %s", (int)snapshot.m_records.size(), pathPrefix.c_str()));
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleCharacter(unsigned char charCode)
+STATIC bool Game::Command_RecordHistory(EventArgs& args)
 {
-	if (g_devConsole->IsOpen())
+	Game* game = g_theApp->GetGame();
+	if (!args.GetValue("enabled", true))
 	{
-		g_devConsole->HandleCharacter(charCode);
-		return;
+		game->StopHistory();
+		game->PrintHistoryStats();
+		return true;
 	}
+
+	QuantizationSettings settings;
+	settings.m_positionError = args.GetValue("positionError", settings.m_positionError);
+	settings.m_rotationErrorDegrees = args.GetValue("rotationError", settings.m_rotationErrorDegrees);
+	settings.m_velocityError = args.GetValue("velocityError", settings.m_velocityError);
+	settings.m_angularVelocityError = args.GetValue("angularError", settings.m_angularVelocityError);
+	int keyframeInterval = args.GetValue("keyframes", 120);
+
+	game->StartHistory(settings, keyframeInterval);
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Recording history, position error %.4f rotation error %.3f", settings.m_positionError, settings.m_rotationErrorDegrees));
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseLBDown()
+STATIC bool Game::Command_SaveHistory(EventArgs& args)
 {
-	int numGeometry = static_cast<int>(m_allGeometry.size()) ;
+	std::string filePath = args.GetValue("file", "Data/Gameplay/History.pstream");
+	Game* game = g_theApp->GetGame();
 
-	if(numGeometry == 0)
+	if (game->m_historyStream.SaveToFile(filePath))
 	{
-		return true;
+		game->PrintHistoryStats();
+		g_devConsole->PrintString(Rgba::GREEN, "Saved history to " + filePath);
 	}
-
-	//Select object for possession
-	float distMinSq = 200.f;
-	m_selectedIndex = 0;
-	for(int geometryIndex = 0; geometryIndex < numGeometry; geometryIndex++)
+	else
 	{
-		if(m_allGeometry[geometryIndex] == nullptr)
-		{
-			continue;
-		}
-
-		float distSq = GetDistanceSquared2D(m_gameCursor->GetCursorPositon(), m_allGeometry[geometryIndex]->m_transform.m_position);
-		if(distMinSq > distSq)
-		{
-			distMinSq = distSq;
-			m_selectedIndex = geometryIndex;
-		}
+		g_devConsole->PrintString(Rgba::RED, "Could not save history to " + filePath);
 	}
-
-	//Now select the actual object
-	m_selectedGeometry = m_allGeometry[m_selectedIndex];
-	g_selectedSimType = m_selectedGeometry->m_rigidbody->GetSimulationType();
-
-	m_selectedGeometry->m_rigidbody->SetSimulationMode(STATIC_SIMULATION);
-	m_gameCursor->SetCursorPosition(m_selectedGeometry->m_transform.m_position);
 	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseLBUp()
+STATIC bool Game::Command_Rewind(EventArgs& args)
 {
-	if(m_selectedGeometry == nullptr)
+	Game* game = g_theApp->GetGame();
+	if (!args.GetValue("enabled", true))
 	{
+		game->m_rewindTimeline.Clear();
+		game->m_scrubFrame = -1;
+		g_devConsole->PrintString(Rgba::WHITE, "Rewind off");
 		return true;
 	}
 
-	//De-select object
-	m_selectedGeometry->m_rigidbody->SetSimulationMode(g_selectedSimType);
-	m_selectedGeometry->m_rigidbody->m_velocity = Vec2::ZERO;
-	m_selectedGeometry->m_rigidbody->m_mass = m_objectMass;
-	m_selectedGeometry->m_rigidbody->m_friction = m_objectFriction;
-	m_selectedGeometry->m_rigidbody->m_linearDrag = m_objectLinearDrag;
-	m_selectedGeometry->m_rigidbody->m_angularDrag = m_objectAngularDrag;
-	m_selectedGeometry->m_rigidbody->m_material.restitution = m_objectRestitution;
-	m_selectedGeometry->m_rigidbody->SetConstraints(m_xFreedom, m_yFreedom, m_rotationFreedom);
-
-	m_selectedGeometry = nullptr;
-	m_selectedIndex = -1;
+	if (!game->m_rewindTimeline.IsActive())
+	{
+		game->m_rewindTimeline.Reset(game->m_worldBounds, args.GetValue("capacity", REWIND_CAPACITY_FRAMES));
+	}
 
-	return true;
-}
+	//Negative goes back, positive goes forward towards the newest frame
+	int numFrames = args.GetValue("frames", 0);
+	if (numFrames != 0)
+	{
+		game->ScrubTimeline(numFrames);
+	}
 
-//------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseRBDown()
-{
-	m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Rewind buffer: %d frames, %.1f KB", game->m_rewindTimeline.GetNumFrames(), (float)game->m_rewindTimeline.GetNumBytes() / 1024.f));
 	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseRBUp()
+STATIC bool Game::Command_GeometryRender(EventArgs& args)
 {
+	Game* game = g_theApp->GetGame();
+	std::string mode = args.GetValue("mode", "");
 
-	m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-
-	Geometry* geometry;
-
-	//Calculate the object center, rotation and bounds
-	Vec2 disp = m_mouseStart - m_mouseEnd;
-	Vec2 norm = disp.GetNormalized();
-	float length = disp.GetLength();
-
-	Vec2 center = m_mouseEnd + length * norm * 0.5f;
-	float rotationDegrees = disp.GetAngleDegrees() + 90.f;
-
-	//Switch on geometry type and construct required collider
-	switch( m_geometryType )
+	if (mode == "debug")
 	{
-	case TYPE_UNKNOWN:
-	break;
-	case AABB2_GEOMETRY:
-	break;
-	case DISC_GEOMETRY:
-	break;
-	case BOX_GEOMETRY:
+		game->m_geometryRenderMode = GEOMETRY_RENDER_DEBUG;
+	}
+	else if (mode == "batched")
 	{
-		//Calculate Centre from mouse Start and End
-		
-
-		if(m_isStatic)
-		{
-			geometry = new Geometry(*g_physicsSystem, STATIC_SIMULATION, BOX_GEOMETRY, center, rotationDegrees, length);
-			geometry->m_rigidbody->m_mass = INFINITY;
-			geometry->m_rigidbody->SetConstraints(false, false, false);
-			geometry->m_rigidbody->m_collider->SetCollisionEvent("StaticCollisionEvent");
-		}
-		else
-		{
-			geometry = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, BOX_GEOMETRY, center, rotationDegrees, length);
-			geometry->m_rigidbody->m_mass = m_objectMass;
-			geometry->m_rigidbody->SetConstraints(m_xFreedom, m_yFreedom, m_rotationFreedom);
-			geometry->m_rigidbody->m_collider->SetCollisionEvent("DynamicCollisionEvent");
-		}
-		geometry->m_rigidbody->m_material.restitution = m_objectRestitution;
-		geometry->m_rigidbody->m_friction = m_objectFriction;
-		geometry->m_rigidbody->m_angularDrag = m_objectAngularDrag;
-		geometry->m_rigidbody->m_linearDrag = m_objectLinearDrag;
-		geometry->m_collider->SetMomentForObject();
-		m_allGeometry.push_back(geometry);
-
+		game->m_geometryRenderMode = GEOMETRY_RENDER_BATCHED;
 	}
-	break;
-	case CAPSULE_GEOMETRY:
+	else if (mode == "instanced")
 	{
-		if(m_isStatic)
-		{
-			geometry = new Geometry(*g_physicsSystem, STATIC_SIMULATION, CAPSULE_GEOMETRY, m_mouseStart, rotationDegrees, 0.f, m_mouseEnd);
-			geometry->m_rigidbody->m_mass = INFINITY;
-			geometry->m_rigidbody->SetConstraints(false, false, false);
-			geometry->m_rigidbody->m_collider->SetCollisionEvent("StaticCollisionEvent");
-		}
-		else
-		{
-			geometry = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, CAPSULE_GEOMETRY, m_mouseStart, rotationDegrees, 0.f, m_mouseEnd);
-			geometry->m_rigidbody->m_mass = m_objectMass;
-			geometry->m_rigidbody->SetConstraints(m_xFreedom, m_yFreedom, m_rotationFreedom);
-			geometry->m_rigidbody->m_collider->SetCollisionEvent("DynamicCollisionEvent");
-		}
-		geometry->m_rigidbody->m_friction = m_objectFriction;
-		geometry->m_rigidbody->m_angularDrag = m_objectAngularDrag;
-		geometry->m_rigidbody->m_linearDrag = m_objectLinearDrag;
-		geometry->m_collider->SetMomentForObject();
-		geometry->m_rigidbody->m_material.restitution = m_objectRestitution;
-
-		m_allGeometry.push_back(geometry);
+		game->m_geometryRenderMode = GEOMETRY_RENDER_INSTANCED;
+	}
+	else if (mode != "")
+	{
+		g_devConsole->PrintString(Rgba::RED, "Unknown mode " + mode + ", use debug, batched or instanced");
+		return false;
 	}
+
+	//Stats are from the last frame drawn in that mode
+	switch (game->m_geometryRenderMode)
+	{
+	case GEOMETRY_RENDER_DEBUG:
+	g_devConsole->PrintString(Rgba::WHITE, "Geometry render: physics debug render");
 	break;
-	case NUM_GEOMETRY_TYPES:
+	case GEOMETRY_RENDER_BATCHED:
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Geometry render: batched, %d shapes, %d vertices in 1 draw", game->m_geometryRenderer.GetNumShapes(), (int)game->m_geometryRenderer.GetVertices().size()));
+	break;
+	case GEOMETRY_RENDER_INSTANCED:
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Geometry render: instanced, %d instances, %d vertices in 1 draw", game->m_instancedRenderer.GetNumInstances(), (int)game->m_instancedRenderer.GetVertices().size()));
 	break;
 	default:
 	break;
 	}
-
 	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseScroll(float wheelDelta)
+STATIC bool Game::Command_Culling(EventArgs& args)
 {
-	m_zoomLevel += wheelDelta;
-	m_zoomLevel = Clamp(m_zoomLevel, 0.00001f, MAX_ZOOM_STEPS);
-
-	//Recalculate mins and maxes based on the zoom level
-	float newMinX = 0.f + m_zoomLevel * SCREEN_ASPECT;
-	float newMinY = 0.f + m_zoomLevel;
-
-	float newMaxX = WORLD_WIDTH - m_zoomLevel * SCREEN_ASPECT;
-	float newMaxY = WORLD_HEIGHT - m_zoomLevel;
-
-	m_mainCamera->SetOrthoView(Vec2(newMinX, newMinY), Vec2(newMaxX, newMaxY));
+	Game* game = g_theApp->GetGame();
+	game->m_isCullingEnabled = args.GetValue("enabled", !game->m_isCullingEnabled);
 
+	if (game->m_isCullingEnabled)
+	{
+		int numVisible = (game->m_simulationThread != nullptr) ? (int)game->m_visibleBodies.size() : (int)game->m_visibleGeometry.size();
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Culling on: %d of %d bodies visible, %d broadphase cells of size %.1f", numVisible, (int)game->m_allGeometry.size(), game->m_broadphase.GetNumCells(), game->m_broadphase.GetCellSize()));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::WHITE, "Culling off, every body is drawn");
+	}
 	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::Render() const
+STATIC bool Game::Command_PhysicsStats(EventArgs& args)
 {
-	//Get the ColorTargetView from rendercontext
-	ColorTargetView *colorTargetView = g_renderContext->GetFrameColorTarget();
-
-	//Setup what we are rendering to
-	m_mainCamera->SetColorTarget(colorTargetView);
-	m_devConsoleCamera->SetColorTarget(colorTargetView);
-
-	g_renderContext->BeginCamera(*m_mainCamera);
-
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-		
-	g_renderContext->ClearColorTargets(*g_clearScreenColor);
-
-	g_renderContext->BindShader( m_shader );
-
-	RenderAllGeometry();
+	UNUSED(args);
+	const PhysicsStats& stats = g_physicsWorld->GetStats();
 
-	RenderWorldBounds();
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Bodies: %d (%d static, %d dynamic)", stats.m_numBodies, stats.m_numStatic, stats.m_numDynamic));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Shapes: %d AABB2, %d disc, %d box, %d capsule", stats.m_numByShape[AABB2_GEOMETRY], stats.m_numByShape[DISC_GEOMETRY], stats.m_numByShape[BOX_GEOMETRY], stats.m_numByShape[CAPSULE_GEOMETRY]));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Triggers: %d, bodies inside triggers: %d", stats.m_numTriggers, stats.m_numTriggerOverlaps));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Contact events: %d last step, %d total", stats.m_numContactEvents, stats.m_numContactEventsTotal));
 
-	RenderPersistantUI();
+	Game* game = g_theApp->GetGame();
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Last step: physics %.3f ms, broadphase %.3f ms", game->m_physicsStepSeconds * 1000.0, game->m_broadphaseSeconds * 1000.0));
+	return true;
+}
 
-	if(m_toggleUI)
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_WorldBench(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	int numWorlds = args.GetValue("worlds", 8);
+	int numSteps = args.GetValue("steps", 600);
+	int numThreads = args.GetValue("threads", 0);
+	if (numWorlds <= 0 || numSteps <= 0)
 	{
-		RenderOnScreenInfo();
+		g_devConsole->PrintString(Rgba::RED, "WorldBench needs at least one world and one step");
+		return false;
 	}
 
-	RenderDebugObjectInfo();
+	//Every world starts as a copy of the current scene, all of them sharing one compiled board
+	WorldSnapshot snapshot;
+	game->CaptureSnapshot(snapshot);
+	int numRecords = static_cast<int>(snapshot.m_records.size());
+	std::shared_ptr<const StaticBoard> board = StaticBoard::Compile(snapshot.m_records.data(), numRecords);
 
-	m_gameCursor->Render();
+	std::vector<PhysicsWorld*> worlds;
+	std::vector<std::vector<Geometry*>> worldGeometry(numWorlds);
+	worlds.reserve(numWorlds);
+	for (int worldIndex = 0; worldIndex < numWorlds; worldIndex++)
+	{
+		worlds.push_back(new PhysicsWorld(Vec2(0.f, WORLD_GRAVITY_Y), game->GetSceneSeed()));
+		worlds[worldIndex]->AttachStaticBoard(board);
+		worlds[worldIndex]->GetBoardGeometry(worldGeometry[worldIndex]);
+		worlds[worldIndex]->CreateDynamicGeometryBatch(snapshot.m_records.data(), numRecords, worldGeometry[worldIndex]);
+	}
 
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+	PhysicsWorldRunner runner(numThreads);
+	double startSeconds = GetCurrentTimeSeconds();
+	runner.StepAll(worlds, DETERMINISTIC_TIME_STEP, numSteps);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
 
-	g_renderContext->EndCamera();
+	//Identical worlds have to stay identical no matter which thread stepped them
+	uint64_t firstHash = PhysicsWorld::ComputeStateHash(worldGeometry[0], worlds[0]->GetNumSteps());
+	int numMismatched = 0;
+	for (int worldIndex = 1; worldIndex < numWorlds; worldIndex++)
+	{
+		if (PhysicsWorld::ComputeStateHash(worldGeometry[worldIndex], worlds[worldIndex]->GetNumSteps()) != firstHash)
+		{
+			numMismatched++;
+		}
+	}
 
-}
+	double worldStepsPerSecond = (elapsedSeconds > 0.0) ? static_cast<double>(numWorlds) * numSteps / elapsedSeconds : 0.0;
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("%d worlds of %d bodies (%d from one shared board), %d steps on %d threads: %.1f ms, %.0f world steps per second", numWorlds, numRecords, board->GetNumBodies(), numSteps, runner.GetNumThreads(), elapsedSeconds * 1000.0, worldStepsPerSecond));
+	g_devConsole->PrintString((numMismatched == 0) ? Rgba::GREEN : Rgba::RED, Stringf("Final state hash %016llx, %d of %d worlds differ", static_cast<unsigned long long>(firstHash), numMismatched, numWorlds));
 
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderWorldBounds() const
-{
-	std::vector<Vertex_PCU> boxVerts;
-	AddVertsForBoundingBox(boxVerts, m_worldBounds, Rgba::DARK_GREY, 2.f);
-	
-	g_renderContext->DrawVertexArray(boxVerts);
+	//Bodies go before the world that owns their physics system, the world frees its board bodies itself
+	for (int worldIndex = 0; worldIndex < numWorlds; worldIndex++)
+	{
+		for (size_t geometryIndex = 0; geometryIndex < worldGeometry[worldIndex].size(); geometryIndex++)
+		{
+			Geometry* geometry = worldGeometry[worldIndex][geometryIndex];
+			if (!worlds[worldIndex]->IsBoardGeometry(geometry))
+			{
+				delete geometry;
+			}
+		}
+		delete worlds[worldIndex];
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderOnScreenInfo() const
+STATIC bool Game::Command_BallBatch(EventArgs& args)
 {
-	//Count the number of objects
-	int staticVectorSize = static_cast<int>(g_physicsSystem->m_rbBucket->m_RbBucket[STATIC_SIMULATION].size());
-	int dynamicVectorSize = static_cast<int>(g_physicsSystem->m_rbBucket->m_RbBucket[DYNAMIC_SIMULATION].size());
-	int staticCount = 0;
-	int dynamicCount = 0;
+	Game* game = g_theApp->GetGame();
+	int numBalls = args.GetValue("count", 4096);
+	int maxSteps = args.GetValue("steps", 1800);
+	float speed = args.GetValue("speed", 20.f);
+	float spreadDegrees = args.GetValue("spread", 60.f);
+	float ballRadius = args.GetValue("radius", DISC_MIN_RADIUS);
+	if (numBalls <= 0 || maxSteps <= 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, "BallBatch needs at least one ball and one step");
+		return false;
+	}
 
-	Vec2 camMinBounds = m_mainCamera->GetOrthoBottomLeft();
-	Vec2 camMaxBounds = m_mainCamera->GetOrthoTopRight();
+	//The attached board already has a peg grid, unless static bodies were added, edited or the balls are too big for it
+	double startSeconds = GetCurrentTimeSeconds();
+	const StaticBoard* staticBoard = g_physicsWorld->GetStaticBoard().get();
+	bool canUseBoard = staticBoard != nullptr && g_physicsWorld->IsBoardIntact() && ballRadius <= staticBoard->GetPegBoard().GetMaxBallRadius()
+		&& g_physicsWorld->GetStats().m_numStatic == staticBoard->GetNumBodies();
 
-	for(int staticIndex = 0; staticIndex < staticVectorSize; staticIndex++)
+	PegBoard builtBoard;
+	if (!canUseBoard)
 	{
-		if(g_physicsSystem->m_rbBucket->m_RbBucket[STATIC_SIMULATION][staticIndex] != nullptr)
-		{
-			staticCount++;
-		}
+		builtBoard.Build(game->m_allGeometry, ballRadius);
+	}
+	const PegBoard& board = canUseBoard ? staticBoard->GetPegBoard() : builtBoard;
+	double buildSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	//A fan of launches pointing down from the cursor, seeded by the scene so a run can be repeated
+	DeterministicRNG rng(game->GetSceneSeed());
+	Vec2 launchPosition = game->GetCursorWorldPosition();
+	std::vector<BallLaunch> launches(numBalls);
+	for (int ballIndex = 0; ballIndex < numBalls; ballIndex++)
+	{
+		float radians = (-90.f + rng.GetRandomFloatInRange(-0.5f, 0.5f) * spreadDegrees) * 0.01745329f;
+		launches[ballIndex].m_position = launchPosition;
+		launches[ballIndex].m_velocity = Vec2(cosf(radians), sinf(radians)) * speed * rng.GetRandomFloatInRange(0.5f, 1.f);
 	}
 
-	for(int dynamicIndex = 0; dynamicIndex < dynamicVectorSize; dynamicIndex++)
+	BallBatch batch;
+	batch.m_ballRadius = ballRadius;
+	batch.SetWorldBounds(game->m_worldBounds);
+	batch.AddPocket(game->m_boxTriggerShape);
+	batch.AddPocket(game->m_capsuleTriggerShape);
+	batch.Reset(launches);
+
+	startSeconds = GetCurrentTimeSeconds();
+	int numStepsRun = batch.Run(board, maxSteps);
+	double runSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	int numPocketHits[2] = {};
+	int numLeftBoard = 0;
+	int numResting = 0;
+	int numRunning = 0;
+	const std::vector<BallResult>& results = batch.GetResults();
+	for (int ballIndex = 0; ballIndex < numBalls; ballIndex++)
 	{
-		if(g_physicsSystem->m_rbBucket->m_RbBucket[DYNAMIC_SIMULATION][dynamicIndex] != nullptr)
+		int outcome = results[ballIndex].m_outcome;
+		if (outcome >= 0)
+		{
+			numPocketHits[outcome]++;
+		}
+		else if (outcome == BALL_LEFT_BOARD)
+		{
+			numLeftBoard++;
+		}
+		else if (outcome == BALL_RESTING)
+		{
+			numResting++;
+		}
+		else
 		{
-			dynamicCount++;
+			numRunning++;
 		}
 	}
 
-	int lineIndex = 2;
-
-	//Display static and dynamic object count
-	std::string printStringStatic = "Number of Static Objects : ";
-	printStringStatic += std::to_string(staticCount);
-
-	std::string printStringDynamic = "Number of Dynamic Objects : ";
-	printStringDynamic += std::to_string(dynamicCount);
-
-	std::vector<Vertex_PCU> textVerts;
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringStatic, Rgba::WHITE);
-	lineIndex++;
-
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringDynamic, Rgba::WHITE);
-	lineIndex += 3;
-
-	//Mass Information
-	std::string printStringMassClamp = "Mass Clamped between 0.1 and 10.0";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringMassClamp, Rgba::WHITE);
-	lineIndex++;
+	double ballStepsPerSecond = (runSeconds > 0.0) ? static_cast<double>(numBalls) * numStepsRun / runSeconds : 0.0;
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("%d balls against %d peg segments, %d steps: %s %.2f ms, run %.1f ms, %.0f ball steps per second", numBalls, board.GetNumSegments(), numStepsRun, canUseBoard ? "shared board" : "board build", buildSeconds * 1000.0, runSeconds * 1000.0, ballStepsPerSecond));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Box pocket %d, capsule pocket %d, left board %d, resting %d, still running %d", numPocketHits[0], numPocketHits[1], numLeftBoard, numResting, numRunning));
+	return true;
+}
 
-	//Mass values
-	std::string printStringMass = "Object Mass (Adjust with N , M) : ";
-	printStringMass += std::to_string(m_objectMass);
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringMass, Rgba::WHITE);
-	lineIndex++;
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_SimThread(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	bool isEnabled = args.GetValue("enabled", game->m_simulationThread == nullptr);
 
-	//Restitution information
-	std::string printStringRestitutionClamp = "Restitution Clamped between 0 and 1";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringRestitutionClamp, Rgba::WHITE);
-	lineIndex++;
+	if (!isEnabled)
+	{
+		delete game->m_simulationThread;
+		game->m_simulationThread = nullptr;
+		g_devConsole->PrintString(Rgba::WHITE, "Simulation runs on the game thread");
+		return true;
+	}
 
-	//Restitution values
-	std::string printStringRestitution = "Object Restitution (Adjust with < , > ) : ";
-	printStringRestitution += std::to_string(m_objectRestitution);
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringRestitution, Rgba::WHITE);
-	lineIndex += 3;
+	//Fixed steps run several times a frame against recorded input, they stay on the game thread
+	if (game->IsDeterministic())
+	{
+		g_devConsole->PrintString(Rgba::RED, "Deterministic runs always step on the game thread");
+		return false;
+	}
 
-	//Friction
-	std::string printStringFriction = "Object Friction (Adjust with K , L ) : ";
-	printStringFriction += std::to_string(m_objectFriction);
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringFriction, Rgba::YELLOW);
-	lineIndex++;
+	if (game->m_simulationThread == nullptr)
+	{
+		game->m_simulationThread = new SimulationThread(RunSimulationJob);
+		game->m_isFrontSnapshotStale = true;
+	}
 
-	//Linear Drag
-	std::string printStringLDrag = "Object Linear Drag (Adjust with NUM_1 , NUM_2 ) : ";
-	printStringLDrag += std::to_string(m_objectLinearDrag);
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringLDrag, Rgba::YELLOW);
-	lineIndex++;
+	g_devConsole->PrintString(Rgba::GREEN, "Simulation runs on its own thread, each frame draws the step before it");
+	return true;
+}
 
-	//Angular Drag
-	std::string printStringADrag = "Object Angular Drag (Adjust with NUM_3 , NUM_4 ) : ";
-	printStringADrag += std::to_string(m_objectAngularDrag);
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringADrag, Rgba::YELLOW);
-	lineIndex += 3;
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Game::RunSimulationJob(float deltaTime)
+{
+	g_theApp->GetGame()->UpdateSimulation(deltaTime);
+}
 
-	//Constraint X
-	std::string printStringXCon = "Constraint On X (Toggle with NUM_5) : ";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringXCon, Rgba::WHITE);
-	Rgba constraintColor = Rgba::WHITE;
-	if (m_xFreedom)
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Game::PrintSimulationMessage(const Rgba& color, const std::string& message)
+{
+	//The console is drawn while a job runs, so the job's messages are printed after it is waited on
+	Game* game = g_theApp->GetGame();
+	if (game != nullptr && game->m_simulationThread != nullptr && game->m_simulationThread->IsCurrentThread())
 	{
-		constraintColor = Rgba::GREEN;
-		printStringXCon = "FREE";
+		game->m_simulationThread->QueueMessage(color, message);
+		return;
 	}
-	else
+
+	g_devConsole->PrintString(color, message);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_PhysicsStream(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	bool isEnabled = args.GetValue("enabled", true);
+	if (!isEnabled)
 	{
-		constraintColor = Rgba::RED;
-		printStringXCon = "LOCKED";
+		game->StopPhysicsStatsStream();
+		return true;
 	}
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight * 40.f, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringXCon, constraintColor);
-	lineIndex++;
 
-	//Constraint Y
-	std::string printStringYCon = "Constraint On Y (Toggle with NUM_6) : ";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringYCon, Rgba::WHITE);
-	constraintColor = Rgba::WHITE;
-	if (m_yFreedom)
+	std::string filePath = args.GetValue("file", "Data/Gameplay/PhysicsStats.csv");
+	if (game->StartPhysicsStatsStream(filePath))
 	{
-		constraintColor = Rgba::GREEN;
-		printStringYCon = "FREE";
+		g_devConsole->PrintString(Rgba::GREEN, "Streaming physics stats to " + filePath);
 	}
 	else
 	{
-		constraintColor = Rgba::RED;
-		printStringYCon = "LOCKED";
+		g_devConsole->PrintString(Rgba::RED, "Could not open " + filePath);
 	}
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight * 40.f, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringYCon, constraintColor);
-	lineIndex++;
+	return true;
+}
 
-	//Constraint rotation
-	std::string printStringRotCon = "Constraint On Z (Toggle with NUM_7) : ";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringRotCon, Rgba::WHITE);
-	constraintColor = Rgba::WHITE;
-	if (m_rotationFreedom)
-	{
-		constraintColor = Rgba::GREEN;
-		printStringRotCon = "FREE";
-	}
-	else
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::Command_CastPreview(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	std::string shape = args.GetValue("shape", "ray");
+	int count = args.GetValue("count", 64);
+	float radius = args.GetValue("radius", 1.f);
+	float length = args.GetValue("length", 4.f);
+	float distance = args.GetValue("distance", 100.f);
+
+	game->m_numPreviewCasts = (count > 0) ? count : 0;
+	if (game->m_numPreviewCasts == 0)
 	{
-		constraintColor = Rgba::RED;
-		printStringRotCon = "LOCKED";
+		game->m_previewHits.clear();
+		g_devConsole->PrintString(Rgba::WHITE, "Cast preview off");
+		return true;
 	}
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight * 40.f, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringRotCon, constraintColor);
-	lineIndex += 3;
 
-	//Simulation type
-	std::string printStringSimType = "Simulation (Space Key) : ";
-	if(m_isStatic)
+	//Direction and start are filled in each frame
+	if (shape == "disc")
 	{
-		printStringSimType += "Static";
+		game->m_previewCastShape = ShapeCast::MakeDisc(Vec2::ZERO, radius, Vec2(1.f, 0.f), distance);
 	}
-	else
+	else if (shape == "capsule")
 	{
-		printStringSimType += "Dynamic";
+		game->m_previewCastShape = ShapeCast::MakeCapsule(Vec2(0.f, -length * 0.5f), Vec2(0.f, length * 0.5f), radius, Vec2(1.f, 0.f), distance);
 	}
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringSimType, Rgba::ORANGE);
-	lineIndex++;
-
-	std::string printStringObjType = "Geometry (G Key) : ";
-	switch( m_geometryType )
+	else
 	{
-	case TYPE_UNKNOWN:
-	break;
-	case AABB2_GEOMETRY:
-	printStringObjType += "AABB2";
-	break;
-	case DISC_GEOMETRY:
-	printStringObjType += "DISC";
-	break;
-	case BOX_GEOMETRY:
-	printStringObjType += "OBB";
-	break;
-	case CAPSULE_GEOMETRY:
-	printStringObjType += "CAPSULE";
-	break;
-	case NUM_GEOMETRY_TYPES:
-	break;
-	default:
-	break;
+		game->m_previewCastShape = ShapeCast::MakeRay(Vec2::ZERO, Vec2(1.f, 0.f), distance);
 	}
 
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringObjType, Rgba::ORANGE);
-	lineIndex += 3;
+	double startTime = GetCurrentTimeSeconds();
+	game->UpdateCastPreview(game->GetCursorWorldPosition());
+	double castMS = (GetCurrentTimeSeconds() - startTime) * 1000.0;
 
-	//Time
-	std::string printStringTime = "Pause Game (X_KEY)";
-	Rgba timeColor = Rgba::GREEN;
-	if (g_gameClock->IsPaused())
+	int numHits = 0;
+	for (int castIndex = 0; castIndex < (int)game->m_previewHits.size(); castIndex++)
 	{
-		timeColor = Rgba::RED;
+		numHits += game->m_previewHits[castIndex].DidHit() ? 1 : 0;
 	}
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringTime, timeColor);
-	lineIndex++;
-
-	printStringTime = "Resume Game (Z_KEY)";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringTime, Rgba::GREEN);
-	lineIndex++;
-
-	printStringTime = "Dilation 0.1 (C_KEY)";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringTime, Rgba::WHITE);
-	lineIndex++;
-
-	printStringTime = "Dilation 2.0 (V_KEY)";
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringTime, Rgba::WHITE);
-	lineIndex++;
-
-	//Mouse Debug
-	std::string printStringMousePos = "Mouse Position : ";
-	printStringMousePos += std::to_string(g_windowContext->GetClientMousePosition().x);
-	printStringMousePos += ", ";
-	printStringMousePos += std::to_string(g_windowContext->GetClientMousePosition().y);
-
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMinBounds.y + 10.f), m_fontHeight, printStringMousePos, Rgba::WHITE);
-
-	std::string printStringClientBounds = "Client Bounds: ";
-	printStringClientBounds += std::to_string(g_windowContext->GetClientBounds().x);
-	printStringClientBounds += ", ";
-	printStringClientBounds += std::to_string(g_windowContext->GetClientBounds().y);
-
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMinBounds.x + m_fontHeight, camMinBounds.y + 10.f - m_fontHeight), m_fontHeight, printStringClientBounds, Rgba::WHITE);
-
-	g_renderContext->BindTextureViewWithSampler(0U, m_squirrelFont->GetTexture());
-	g_renderContext->DrawVertexArray(textVerts);
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderPersistantUI() const
-{
-	Vec2 camMinBounds = m_mainCamera->GetOrthoBottomLeft();
-	Vec2 camMaxBounds = m_mainCamera->GetOrthoTopRight();
 
-	//Toggle UI 
-	std::string printString = "Toggle Control Scheme (LCTRL Button) ";
-	std::vector<Vertex_PCU> textVerts;
-	m_squirrelFont->AddVertsForText2D(textVerts, Vec2(camMaxBounds.x - 90.f, camMaxBounds.y - m_fontHeight), m_fontHeight, printString, Rgba::ORANGE);
-
-	g_renderContext->BindTextureViewWithSampler(0U, m_squirrelFont->GetTexture());
-	g_renderContext->DrawVertexArray(textVerts);
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Cast preview: %d %s casts, %d hit, %.3f ms on %d threads", game->m_numPreviewCasts, shape.c_str(), numHits, castMS, game->m_castBatch.GetNumThreadsUsed()));
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderAllGeometry() const
+STATIC bool Game::Command_LoadSnapshot(EventArgs& args)
 {
-	// display debug information
-	g_physicsSystem->DebugRender( g_renderContext ); 
+	std::string filePath = args.GetValue("file", "Data/Gameplay/SaveGame.snapshot");
 
+	if (g_theApp->GetGame()->LoadSnapshot(filePath))
+	{
+		g_devConsole->PrintString(Rgba::GREEN, "Loaded snapshot from " + filePath);
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not load snapshot from " + filePath);
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugRenderToScreen() const
+STATIC bool Game::Command_LoadMappedScene(EventArgs& args)
 {
-	Camera& debugCamera = g_debugRenderer->Get2DCamera();
-	debugCamera.m_colorTargetView = g_renderContext->GetFrameColorTarget();
-
-	g_renderContext->BindShader(m_shader);
-	g_renderContext->BeginCamera(debugCamera);
-
-	g_debugRenderer->DebugRenderToScreen();
-
-	g_renderContext->EndCamera();
+	std::string filePath = args.GetValue("file", "Data/Gameplay/SaveGame.snapshot");
 
+	double startTime = GetCurrentTimeSeconds();
+	Game* game = g_theApp->GetGame();
+	if (game->LoadMappedScene(filePath))
+	{
+		double loadMS = (GetCurrentTimeSeconds() - startTime) * 1000.0;
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Mapped %s: %d static bodies, %d total in %.2f ms", filePath.c_str(), g_physicsWorld->GetStaticBoard()->GetNumBodies(), (int)game->m_allGeometry.size(), loadMS));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not map scene " + filePath);
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugRenderToCamera() const
+void Game::HandleKeyPressed(unsigned char keyCode)
+{
+	//The App routes keys to the dev console before they get here, replayed keys must not be swallowed by it
+	switch( keyCode )
+	{
+		case W_KEY:
+		case S_KEY:
+		case A_KEY:
+		case D_KEY:
+		//m_gameCursor->HandleKeyPressed(keyCode);
+		UpdateCameraMovement(keyCode);
+		break;
+		case LCTRL_KEY:
+		{
+			m_toggleUI = !m_toggleUI;
+		}
+		break;
+		case SPACE_KEY:
+		{
+			ToggleSimType();
+			break;
+		}
+		case DEL_KEY:
+		{
+			if(m_selectedGeometry == nullptr)
+			{
+				return;
+			}
+
+			//Destroyed at the start of the next step, garbage collection then removes it
+			g_physicsWorld->QueueDestroyBody(m_selectedGeometry->m_id);
+			m_selectedGeometry = nullptr;
+			break;
+		}
+		case G_KEY:
+		{
+			ChangeCurrentGeometry();
+			break;
+		}
+		case TAB_KEY:
+		{
+			break;
+		}
+		case K_KEY:
+		{
+			//Friction increase
+			m_objectFriction -= m_frictionStep;
+			m_objectFriction = Clamp(m_objectFriction, 0.f, 1.f);
+		}
+		break;
+		case L_KEY:
+		{
+			//Friction decrease
+			m_objectFriction += m_frictionStep;
+			m_objectFriction = Clamp(m_objectFriction, 0.f, 1.f);
+		}
+		break;
+		case NUM_1:
+		{
+			//Decrease Linear Drag
+			m_objectLinearDrag -= m_linearDragStep;
+		}
+		break;
+		case NUM_2:
+		{
+			//Increase Linear Drag
+			m_objectLinearDrag += m_linearDragStep;
+		}
+		break;
+		case NUM_3:
+		{
+			//Decrease Angular Drag
+			m_objectAngularDrag -= m_angularDragStep;
+		}
+		break;
+		case NUM_4:
+		{
+			//Increase Angular Drag
+			m_objectAngularDrag += m_angularDragStep;
+		}
+		break;
+		case NUM_5:
+		{
+			//Toggle X freedom
+			m_xFreedom = !m_xFreedom;
+		}
+		break;
+		case NUM_6:
+		{
+			//Toggle Y freedom
+			m_yFreedom = !m_yFreedom;
+		}
+		break;
+		case NUM_7:
+		{
+			//Toggle rotation freedom
+			m_rotationFreedom = !m_rotationFreedom;
+		}
+		break;
+		case NUM_8:
+		{
+			//Save the game, written in the background
+			QueueSave("Data/Gameplay/SaveGame.xml");
+		}
+		break;
+		case NUM_9:
+		{
+			//Load the game
+			LoadFromFile("Data/Gameplay/SaveGame.xml");
+		}
+		break;
+		case N_KEY:
+		m_objectMass -= m_massStep;
+		m_objectMass = Clamp(m_objectMass, 0.1f, 10.f);
+		break;
+		case M_KEY:
+		m_objectMass += m_massStep;
+		m_objectMass = Clamp(m_objectMass, 0.1f, 10.f);
+		break;
+		case KEY_LESSER:
+		m_objectRestitution -= m_restitutionStep;
+		m_objectRestitution = Clamp(m_objectRestitution, 0.f, 1.f);
+		break;
+		case KEY_GREATER:
+		m_objectRestitution += m_restitutionStep;
+		m_objectRestitution  = Clamp(m_objectRestitution, 0.f, 1.f);
+		break;
+		case F1_KEY:
+		{
+			break;
+		}
+		break;
+		case F2_KEY:
+		{
+			//F2 spawns a static disc on the cursor position
+			QueueSpawn(STATIC_SIMULATION, CAPSULE_GEOMETRY, GetCursorWorldPosition());
+		}
+		break;
+		case F3_KEY:
+		{
+			//F3 spawns a dynamic box on the cursor position
+			QueueSpawn(DYNAMIC_SIMULATION, BOX_GEOMETRY, GetCursorWorldPosition(), 0.f, 3.f, GetCursorWorldPosition() + Vec2(10.f, 10.f));
+		}
+		break;
+		case F4_KEY:
+		{
+			//F4 spawns a dynamic box on the cursor position (Rotated by 90 degrees
+			QueueSpawn(DYNAMIC_SIMULATION, BOX_GEOMETRY, GetCursorWorldPosition(), 90.f, 3.f, GetCursorWorldPosition() + Vec2(10.f, 10.f));
+		}
+		break;
+		case F5_KEY:
+		break;
+		case F6_KEY:
+		break;
+		case F7_KEY:
+		break;
+		default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int Game::GetNextValidGeometryIndex(int index)
+{
+	int vectorSize = static_cast<int>(m_allGeometry.size());
+
+	int end = index;
+	index = (index + 1) % vectorSize;
+
+	while(index != end)
+	{
+		if(m_allGeometry[index] != nullptr)
+		{
+			return index;
+		}
+		else
+		{
+			index = (index + 1) % vectorSize;
+		}
+	}
+
+	return end;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugEnabled()
+{
+	g_debugMode = !g_debugMode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::HandleKeyReleased(unsigned char keyCode)
+{
+
+	switch( keyCode )
+	{
+		case UP_ARROW:
+		case DOWN_ARROW:
+		case RIGHT_ARROW:
+		case LEFT_ARROW:
+		m_gameCursor->HandleKeyReleased(keyCode);
+
+		break;
+		default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::HandleCharacter(unsigned char charCode)
+{
+	if (g_devConsole->IsOpen())
+	{
+		g_devConsole->HandleCharacter(charCode);
+		return;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseLBDown()
+{
+	//Select the closest object for possession
+	Geometry* pickedGeometry = m_broadphase.QueryNearest(GetCursorWorldPosition(), PICK_RADIUS);
+	if(pickedGeometry == nullptr)
+	{
+		return true;
+	}
+
+	//Now select the actual object, it is held static from the next step
+	m_selectedGeometry = pickedGeometry;
+	g_physicsWorld->QueueBeginHold(m_selectedGeometry->m_id);
+	m_gameCursor->SetCursorPosition(m_selectedGeometry->m_transform.m_position);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseLBUp()
+{
+	if(m_selectedGeometry == nullptr)
+	{
+		return true;
+	}
+
+	//De-select object, dropped at rest with the current properties from the next step
+	uint32_t bodyID = m_selectedGeometry->m_id;
+	g_physicsWorld->QueueEndHold(bodyID);
+	g_physicsWorld->QueueSetVelocity(bodyID, Vec2::ZERO);
+	g_physicsWorld->QueueSetMaterial(bodyID, m_objectMass, m_objectFriction, m_objectRestitution, m_objectLinearDrag, m_objectAngularDrag);
+	g_physicsWorld->QueueSetConstraints(bodyID, m_xFreedom, m_yFreedom, m_rotationFreedom);
+
+	m_selectedGeometry = nullptr;
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseRBDown()
+{
+	m_mouseStart = GetCursorWorldPosition();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseRBUp()
+{
+
+	m_mouseEnd = GetCursorWorldPosition();
+
+	//Calculate the object center, rotation and bounds
+	Vec2 disp = m_mouseStart - m_mouseEnd;
+	Vec2 norm = disp.GetNormalized();
+	float length = disp.GetLength();
+
+	Vec2 center = m_mouseEnd + length * norm * 0.5f;
+	float rotationDegrees = disp.GetAngleDegrees() + 90.f;
+
+	eSimulationType simulationType = m_isStatic ? STATIC_SIMULATION : DYNAMIC_SIMULATION;
+	const char* collisionEvent = m_isStatic ? "StaticCollisionEvent" : "DynamicCollisionEvent";
+	uint32_t bodyID = 0;
+
+	//Switch on geometry type and queue the required collider
+	switch( m_geometryType )
+	{
+	case TYPE_UNKNOWN:
+	break;
+	case AABB2_GEOMETRY:
+	break;
+	case DISC_GEOMETRY:
+	break;
+	case BOX_GEOMETRY:
+	bodyID = QueueSpawn(simulationType, BOX_GEOMETRY, center, rotationDegrees, length, Vec2::ZERO, collisionEvent);
+	break;
+	case CAPSULE_GEOMETRY:
+	bodyID = QueueSpawn(simulationType, CAPSULE_GEOMETRY, m_mouseStart, rotationDegrees, 0.f, m_mouseEnd, collisionEvent);
+	break;
+	case NUM_GEOMETRY_TYPES:
+	break;
+	default:
+	break;
+	}
+
+	if (bodyID != 0)
+	{
+		//Static bodies are pinned in place, dynamic ones take the current freedoms
+		if (m_isStatic)
+		{
+			g_physicsWorld->QueueSetConstraints(bodyID, false, false, false);
+		}
+		else
+		{
+			g_physicsWorld->QueueSetConstraints(bodyID, m_xFreedom, m_yFreedom, m_rotationFreedom);
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseScroll(float wheelDelta)
+{
+	m_zoomLevel += wheelDelta;
+	m_zoomLevel = Clamp(m_zoomLevel, 0.00001f, MAX_ZOOM_STEPS);
+
+	//Recalculate mins and maxes based on the zoom level
+	float newMinX = 0.f + m_zoomLevel * SCREEN_ASPECT;
+	float newMinY = 0.f + m_zoomLevel;
+
+	float newMaxX = WORLD_WIDTH - m_zoomLevel * SCREEN_ASPECT;
+	float newMaxY = WORLD_HEIGHT - m_zoomLevel;
+
+	m_mainCamera->SetOrthoView(Vec2(newMinX, newMinY), Vec2(newMaxX, newMaxY));
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::Render() const
+{
+	PROFILE_SCOPE("Game Render");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_RENDER);
+
+	//Get the ColorTargetView from rendercontext
+	ColorTargetView *colorTargetView = g_renderContext->GetFrameColorTarget();
+
+	//Setup what we are rendering to
+	m_mainCamera->SetColorTarget(colorTargetView);
+	m_devConsoleCamera->SetColorTarget(colorTargetView);
+
+	g_renderContext->BeginCamera(*m_mainCamera);
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+		
+	g_renderContext->ClearColorTargets(*g_clearScreenColor);
+
+	g_renderContext->BindShader( m_shader );
+
+	CollectVisibleGeometry();
+
+	RenderAllGeometry();
+
+	RenderWorldBounds();
+
+	RenderPersistantUI();
+
+	if(m_toggleUI)
+	{
+		RenderOnScreenInfo();
+	}
+
+	RenderDebugObjectInfo();
+
+	RenderCastPreview();
+
+	m_gameCursor->Render();
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+
+	g_renderContext->EndCamera();
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderWorldBounds() const
+{
+	//World bounds are set once in StartUp
+	if (m_worldBoundsVerts.empty())
+	{
+		AddVertsForBoundingBox(m_worldBoundsVerts, m_worldBounds, Rgba::DARK_GREY, 2.f);
+	}
+	
+	g_renderContext->DrawVertexArray(m_worldBoundsVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderOnScreenInfo() const
+{
+	PROFILE_SCOPE("Render HUD");
+
+	//Object counts are kept as bodies come and go
+	const PhysicsStats& stats = m_isRenderingSnapshot ? GetFrontSnapshot().m_stats : g_physicsWorld->GetStats();
+	int staticCount = stats.m_numStatic;
+	int dynamicCount = stats.m_numDynamic;
+
+	Vec2 camMinBounds = m_mainCamera->GetOrthoBottomLeft();
+	Vec2 camMaxBounds = m_mainCamera->GetOrthoTopRight();
+
+	int lineIndex = 2;
+	BitmapFont& font = *m_squirrelFont;
+	m_onScreenText.BeginFrame();
+
+	//Display static and dynamic object count
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Number of Static Objects : %d", staticCount), Rgba::WHITE);
+	lineIndex++;
+
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Number of Dynamic Objects : %d", dynamicCount), Rgba::WHITE);
+	lineIndex += 3;
+
+	//Mass Information
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Mass Clamped between 0.1 and 10.0", Rgba::WHITE);
+	lineIndex++;
+
+	//Mass values
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Object Mass (Adjust with N , M) : %f", m_objectMass), Rgba::WHITE);
+	lineIndex++;
+
+	//Restitution information
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Restitution Clamped between 0 and 1", Rgba::WHITE);
+	lineIndex++;
+
+	//Restitution values
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Object Restitution (Adjust with < , > ) : %f", m_objectRestitution), Rgba::WHITE);
+	lineIndex += 3;
+
+	//Friction
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Object Friction (Adjust with K , L ) : %f", m_objectFriction), Rgba::YELLOW);
+	lineIndex++;
+
+	//Linear Drag
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Object Linear Drag (Adjust with NUM_1 , NUM_2 ) : %f", m_objectLinearDrag), Rgba::YELLOW);
+	lineIndex++;
+
+	//Angular Drag
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, g_frameAllocator->Format("Object Angular Drag (Adjust with NUM_3 , NUM_4 ) : %f", m_objectAngularDrag), Rgba::YELLOW);
+	lineIndex += 3;
+
+	//Constraints
+	const char* constraintLabels[3] = { "Constraint On X (Toggle with NUM_5) : ", "Constraint On Y (Toggle with NUM_6) : ", "Constraint On Z (Toggle with NUM_7) : " };
+	bool constraintFreedoms[3] = { m_xFreedom, m_yFreedom, m_rotationFreedom };
+	for (int constraintIndex = 0; constraintIndex < 3; constraintIndex++)
+	{
+		bool isFree = constraintFreedoms[constraintIndex];
+		m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, constraintLabels[constraintIndex], Rgba::WHITE);
+		m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight * 40.f, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, isFree ? "FREE" : "LOCKED", isFree ? Rgba::GREEN : Rgba::RED);
+		lineIndex++;
+	}
+	lineIndex += 2;
+
+	//Simulation type
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, m_isStatic ? "Simulation (Space Key) : Static" : "Simulation (Space Key) : Dynamic", Rgba::ORANGE);
+	lineIndex++;
+
+	const char* printStringObjType = "Geometry (G Key) : ";
+	switch( m_geometryType )
+	{
+	case TYPE_UNKNOWN:
+	break;
+	case AABB2_GEOMETRY:
+	printStringObjType = "Geometry (G Key) : AABB2";
+	break;
+	case DISC_GEOMETRY:
+	printStringObjType = "Geometry (G Key) : DISC";
+	break;
+	case BOX_GEOMETRY:
+	printStringObjType = "Geometry (G Key) : OBB";
+	break;
+	case CAPSULE_GEOMETRY:
+	printStringObjType = "Geometry (G Key) : CAPSULE";
+	break;
+	case NUM_GEOMETRY_TYPES:
+	break;
+	default:
+	break;
+	}
+
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, printStringObjType, Rgba::ORANGE);
+	lineIndex += 3;
+
+	//Time
+	Rgba timeColor = Rgba::GREEN;
+	if (g_gameClock->IsPaused())
+	{
+		timeColor = Rgba::RED;
+	}
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Pause Game (X_KEY)", timeColor);
+	lineIndex++;
+
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Resume Game (Z_KEY)", Rgba::GREEN);
+	lineIndex++;
+
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Dilation 0.1 (C_KEY)", Rgba::WHITE);
+	lineIndex++;
+
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMaxBounds.y - m_fontHeight * lineIndex), m_fontHeight, "Dilation 2.0 (V_KEY)", Rgba::WHITE);
+	lineIndex++;
+
+	//Mouse Debug
+	IntVec2 mousePosition = g_windowContext->GetClientMousePosition();
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMinBounds.y + 10.f), m_fontHeight, g_frameAllocator->Format("Mouse Position : %d, %d", mousePosition.x, mousePosition.y), Rgba::WHITE);
+
+	IntVec2 clientBounds = g_windowContext->GetClientBounds();
+	m_onScreenText.AddText(font, Vec2(camMinBounds.x + m_fontHeight, camMinBounds.y + 10.f - m_fontHeight), m_fontHeight, g_frameAllocator->Format("Client Bounds: %d, %d", clientBounds.x, clientBounds.y), Rgba::WHITE);
+
+	m_onScreenText.Draw(*g_renderContext, font);
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderPersistantUI() const
+{
+	Vec2 camMinBounds = m_mainCamera->GetOrthoBottomLeft();
+	Vec2 camMaxBounds = m_mainCamera->GetOrthoTopRight();
+
+	//Toggle UI 
+	m_persistantText.BeginFrame();
+	m_persistantText.AddText(*m_squirrelFont, Vec2(camMaxBounds.x - 90.f, camMaxBounds.y - m_fontHeight), m_fontHeight, "Toggle Control Scheme (LCTRL Button) ", Rgba::ORANGE);
+
+	int scrubFrame = m_isRenderingSnapshot ? GetFrontSnapshot().m_scrubFrame : m_scrubFrame;
+	if (scrubFrame >= 0)
+	{
+		int numRewindFrames = m_isRenderingSnapshot ? GetFrontSnapshot().m_numRewindFrames : m_rewindTimeline.GetNumFrames();
+		const char* printString = g_frameAllocator->Format("Rewind frame %d / %d (Q/E to scrub, Z to resume from here)", scrubFrame + 1, numRewindFrames);
+		m_persistantText.AddText(*m_squirrelFont, Vec2(camMinBounds.x + 2.f, camMaxBounds.y - m_fontHeight), m_fontHeight, printString, Rgba::ORANGE);
+	}
+
+	m_persistantText.Draw(*g_renderContext, *m_squirrelFont);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderAllGeometry() const
+{
+	PROFILE_SCOPE("Render Geometry");
+
+	switch (m_geometryRenderMode)
+	{
+	case GEOMETRY_RENDER_DEBUG:
+	{
+		// display debug information
+		g_physicsWorld->GetPhysicsSystem().DebugRender( g_renderContext ); 
+	}
+	break;
+	case GEOMETRY_RENDER_BATCHED:
+	{
+		m_geometryRenderer.BeginBatch();
+		if (m_isRenderingSnapshot)
+		{
+			m_geometryRenderer.AddAllBodies(m_visibleBodies);
+		}
+		else
+		{
+			m_geometryRenderer.AddAllGeometry(GetVisibleGeometry());
+		}
+
+		//Triggers are not geometry, draw them from the shapes they were made with
+		Rgba triggerFill = Rgba(1.f, 0.5f, 0.f, 0.25f);
+		m_geometryRenderer.AddShape(m_boxTriggerShape, m_boxTriggerShape.m_position, m_boxTriggerShape.m_rotationDegrees, triggerFill, Rgba::ORANGE);
+		m_geometryRenderer.AddShape(m_capsuleTriggerShape, m_capsuleTriggerShape.m_position, m_capsuleTriggerShape.m_rotationDegrees, triggerFill, Rgba::ORANGE);
+
+		m_geometryRenderer.DrawBatch(*g_renderContext);
+	}
+	break;
+	case GEOMETRY_RENDER_INSTANCED:
+	{
+		m_instancedRenderer.BeginFrame();
+		if (m_isRenderingSnapshot)
+		{
+			m_instancedRenderer.AddAllBodies(m_visibleBodies);
+		}
+		else
+		{
+			m_instancedRenderer.AddAllGeometry(GetVisibleGeometry());
+		}
+		m_instancedRenderer.AddShape(m_boxTriggerShape, m_boxTriggerShape.m_position, m_boxTriggerShape.m_rotationDegrees, INSTANCE_COLOR_TRIGGER);
+		m_instancedRenderer.AddShape(m_capsuleTriggerShape, m_capsuleTriggerShape.m_position, m_capsuleTriggerShape.m_rotationDegrees, INSTANCE_COLOR_TRIGGER);
+
+		m_instancedRenderer.BuildVertices();
+		m_instancedRenderer.DrawInstances(*g_renderContext);
+	}
+	break;
+	default:
+	break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CollectVisibleGeometry() const
+{
+	PROFILE_SCOPE("Collect Visible");
+
+	m_visibleGeometry.clear();
+	m_visibleBodies.clear();
+	if (!m_isCullingEnabled)
+	{
+		if (m_isRenderingSnapshot)
+		{
+			GetFrontSnapshot().GetAllBodies(m_visibleBodies);
+		}
+		return;
+	}
+
+	//Pad by a little so outlines on the edge of the screen are not cut
+	Vec2 padding = Vec2(1.f, 1.f);
+	AABB2 cameraBounds = AABB2(m_mainCamera->GetOrthoBottomLeft() - padding, m_mainCamera->GetOrthoTopRight() + padding);
+	if (m_isRenderingSnapshot)
+	{
+		//The broadphase is being rebuilt by the job, the snapshot carries its own grid
+		GetFrontSnapshot().QueryAABB(cameraBounds, m_visibleBodies);
+	}
+	else
+	{
+		m_broadphase.QueryAABB(cameraBounds, m_visibleGeometry);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const std::vector<Geometry*>& Game::GetVisibleGeometry() const
+{
+	return m_isCullingEnabled ? m_visibleGeometry : m_allGeometry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const RenderSnapshot& Game::GetFrontSnapshot() const
+{
+	return m_renderSnapshots[m_frontSnapshot];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugRenderToScreen() const
+{
+	Camera& debugCamera = g_debugRenderer->Get2DCamera();
+	debugCamera.m_colorTargetView = g_renderContext->GetFrameColorTarget();
+
+	g_renderContext->BindShader(m_shader);
+	g_renderContext->BeginCamera(debugCamera);
+
+	g_debugRenderer->DebugRenderToScreen();
+
+	g_renderContext->EndCamera();
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugRenderToCamera() const
 {
 	Camera& debugCamera3D = *m_mainCamera;
 	debugCamera3D.m_colorTargetView = g_renderContext->GetFrameColorTarget();
 
-	g_renderContext->BindShader(m_shader);
-	g_renderContext->BeginCamera(debugCamera3D);
+	g_renderContext->BindShader(m_shader);
+	g_renderContext->BeginCamera(debugCamera3D);
+
+	g_debugRenderer->Setup3DCamera(&debugCamera3D);
+	g_debugRenderer->DebugRenderToCamera();
+
+	g_renderContext->EndCamera();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::PostRender()
+{
+	if(!m_isDebugSetup)
+	{
+		//SetStartupDebugRenderObjects();
+
+		ColorTargetView* ctv = g_renderContext->GetFrameColorTarget();
+		//Setup debug render client data
+		g_debugRenderer->SetClientDimensions( ctv->m_height, ctv->m_width );
+		g_debugRenderer->SetWorldSize2D(m_mainCamera->GetOrthoBottomLeft(), m_mainCamera->GetOrthoTopRight());
+
+		m_isDebugSetup = true;
+	}
+
+	//All screen Debug information
+	DebugRenderToScreen();
+
+	if(m_isRenderingSnapshot)
+	{
+		//The job collected its own garbage
+		FinishSimulationFrame();
+	}
+	else
+	{
+		m_isFrontSnapshotStale = true;
+
+		//Deterministic runs collect garbage inside the fixed step instead
+		if(!m_isDeterministic)
+		{
+			ClearGarbageEntities();
+		}
+	}
+
+	//Frame boundary, safe to capture the world for saving
+	UpdateSaves();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::Update( float deltaTime )
+{
+	PROFILE_SCOPE("Game Update");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_GAME);
+
+	//UpdateCamera(deltaTime);
+
+	m_gameCursor->Update(deltaTime);
+	if(m_isCursorOverridden)
+	{
+		m_gameCursor->SetCursorPosition(m_cursorOverride);
+	}
+
+	//The grabbed object follows the cursor, moved at the start of the step
+	if(m_selectedGeometry != nullptr)
+	{
+		g_physicsWorld->QueueSetTransform(m_selectedGeometry->m_id, m_gameCursor->GetCursorPositon());
+	}
+
+	if (g_devConsole->GetFrameCount() > 1 && !m_consoleDebugOnce)
+	{
+		//We have rendered the 1st frame
+		m_devConsoleCamera->SetOrthoView(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT));
+		m_consoleDebugOnce = true;
+	}
+
+	//The job can't read the window, hand it the cursor
+	m_castStart = GetCursorWorldPosition();
+
+	//Debug rendering draws the live bodies, those frames step here
+	m_isRenderingSnapshot = CanThreadSimulation();
+	if (!m_isRenderingSnapshot)
+	{
+		UpdateSimulation(deltaTime);
+		return;
+	}
+
+	//Frames that stepped here left the front snapshot behind the world
+	if (m_isFrontSnapshotStale)
+	{
+		CaptureRenderSnapshot(m_renderSnapshots[m_frontSnapshot]);
+		m_isFrontSnapshotStale = false;
+	}
+
+	m_simulationThread->StartJob(deltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateSimulation( float deltaTime )
+{
+	PROFILE_SCOPE("Update Simulation");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_GAME);
+
+	UpdateGeometry(deltaTime);
+
+	if(m_isDeterministic)
+	{
+		//Garbage collection has to happen on a step boundary or the body set depends on the frame rate
+		ClearGarbageEntities();
+
+		if(!m_stateHashLog.RecordStep(ComputeStateHash()))
+		{
+			g_devConsole->PrintString(Rgba::RED, Stringf("Simulation diverged from reference at step %d", m_simulationStep));
+		}
+		m_simulationStep++;
+	}
+
+	UpdateCheckpoints(deltaTime);
+
+	if(m_isRecordingHistory)
+	{
+		//Step numbers only advance in deterministic mode, count our own frames otherwise
+		int historyStep = m_isDeterministic ? m_simulationStep : m_historyStep;
+		CaptureBodyStates(m_historyCapture);
+		m_historyStream.AppendFrame(m_historyCapture, historyStep);
+		m_historyStep++;
+	}
+
+	RecordRewindFrame();
+
+	//Bodies have moved, render and queries this frame read from here
+	double broadphaseStartSeconds = GetCurrentTimeSeconds();
+	m_broadphase.Rebuild(m_allGeometry);
+	m_broadphaseSeconds = GetCurrentTimeSeconds() - broadphaseStartSeconds;
+
+	if (m_physicsStatsStream.IsOpen())
+	{
+		WritePhysicsStatsRow();
+	}
+
+	UpdateCastPreview(m_castStart);
+
+	if (m_isRenderingSnapshot)
+	{
+		//PostRender collects garbage when it runs on the game thread
+		ClearGarbageEntities();
+		CaptureRenderSnapshot(m_renderSnapshots[1 - m_frontSnapshot]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::FinishSimulationFrame()
+{
+	m_simulationThread->WaitForJob();
+	m_simulationThread->PrintQueuedMessages();
+
+	//Render is done with the front snapshot, the job's copy is drawn next frame
+	m_frontSnapshot = 1 - m_frontSnapshot;
+	m_isRenderingSnapshot = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CaptureRenderSnapshot(RenderSnapshot& out_snapshot) const
+{
+	out_snapshot.Capture(m_allGeometry);
+	out_snapshot.m_stats = g_physicsWorld->GetStats();
+	out_snapshot.m_previewCasts = m_previewCasts;
+	out_snapshot.m_previewHits = m_previewHits;
+	out_snapshot.m_numRewindFrames = m_rewindTimeline.GetNumFrames();
+	out_snapshot.m_scrubFrame = m_scrubFrame;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::CanThreadSimulation() const
+{
+	return m_simulationThread != nullptr && m_geometryRenderMode != GEOMETRY_RENDER_DEBUG;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateCastPreview(const Vec2& castStart)
+{
+	PROFILE_SCOPE("Cast Preview");
+
+	if (m_numPreviewCasts <= 0)
+	{
+		return;
+	}
+
+	m_previewCasts.resize(m_numPreviewCasts);
+	for (int castIndex = 0; castIndex < m_numPreviewCasts; castIndex++)
+	{
+		float radians = 6.2831853f * static_cast<float>(castIndex) / static_cast<float>(m_numPreviewCasts);
+		ShapeCast& cast = m_previewCasts[castIndex];
+		cast = m_previewCastShape;
+		cast.m_start = castStart;
+		cast.m_direction = Vec2(cosf(radians), sinf(radians));
+	}
+
+	m_castBatch.CastAll(m_broadphase, m_previewCasts, m_previewHits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateGeometry( float deltaTime )
+{
+	PROFILE_SCOPE("Physics Step");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_PHYSICS);
+
+	// let physics system play out
+	double stepStartSeconds = GetCurrentTimeSeconds();
+	g_physicsWorld->Step(deltaTime);
+	m_physicsStepSeconds = GetCurrentTimeSeconds() - stepStartSeconds;
+
+	//Bodies spawned by queued commands join the game here
+	g_physicsWorld->TakeCreatedGeometry(m_allGeometry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateCamera(float deltaTime)
+{
+	//Reuse the camera, the ortho view is reset below so shake never accumulates
+	if (m_mainCamera == nullptr)
+	{
+		m_mainCamera = new Camera();
+	}
+	Vec2 orthoBottomLeft = Vec2(0.f,0.f);
+	Vec2 orthoTopRight = Vec2(WORLD_WIDTH, WORLD_HEIGHT);
+	m_mainCamera->SetOrthoView(orthoBottomLeft, orthoTopRight);
+
+	float shakeX = 0.f;
+	float shakeY = 0.f;
+
+	if(g_shakeAmount > 0)
+	{
+		shakeX = g_randomNumGen->GetRandomFloatInRange(-g_shakeAmount, g_shakeAmount);
+		shakeY = g_randomNumGen->GetRandomFloatInRange(-g_shakeAmount, g_shakeAmount);
+
+		g_shakeAmount -= deltaTime * CAMERA_SHAKE_REDUCTION_PER_SECOND;
+	}
+	else
+	{
+		g_shakeAmount = 0;
+	}
+
+	Vec2 translate2D = Vec2(shakeX, shakeY);
+	translate2D.ClampLength(MAX_SHAKE);
+	m_mainCamera->Translate2D(translate2D);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateCameraMovement( unsigned char keyCode )
+{
+	switch( keyCode )
+	{
+	case W_KEY:
+	{
+		if(m_mainCamera->GetOrthoTopRight().y < m_worldBounds.m_maxBounds.y)
+		{
+			//Move the camera up
+			m_mainCamera->Translate2D(Vec2(0.f, 1.0f));
+		}
+	}
+	break;
+	case S_KEY:
+	{
+		if(m_mainCamera->GetOrthoBottomLeft().y > m_worldBounds.m_minBounds.y)
+		{
+			//Move the camera down
+			m_mainCamera->Translate2D(Vec2(0.f, -1.0f));
+		}
+	}
+	break;
+	case A_KEY:
+	{
+		//For when we are over world bounds
+		if(m_mainCamera->GetOrthoTopRight().x > m_worldBounds.m_maxBounds.x)
+		{
+			//Move the camera left
+			m_mainCamera->Translate2D(Vec2(-1.f, 0.0f));
+		}
+
+		//For when we are inside the world bounds
+		if(m_mainCamera->GetOrthoBottomLeft().x > m_worldBounds.m_minBounds.x)
+		{
+			//Move the camera left
+			m_mainCamera->Translate2D(Vec2(-1.f, 0.0f));
+		}
+	}
+	break;
+	case D_KEY:
+	{
+		//When we are bigger than the world bounds
+		if(m_mainCamera->GetOrthoBottomLeft().x < m_worldBounds.m_minBounds.x)
+		{
+			//Move the camera right
+			m_mainCamera->Translate2D(Vec2(1.f, 0.0f));
+		}
+
+		//For when we are inside the world bounds
+		if(m_mainCamera->GetOrthoTopRight().x < m_worldBounds.m_maxBounds.x)
+		{
+			//Move the camera right
+			m_mainCamera->Translate2D(Vec2(1.f, 0.0f));
+		}
+	}
+	break;
+	default:
+	break;
+	}
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ClearGarbageEntities()
+{
+	PROFILE_SCOPE("Clear Garbage");
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_PHYSICS);
+	double startSeconds = GetCurrentTimeSeconds();
+	int numCollected = 0;
+
+	//Kill any entity off screen
+	for (int geometryIndex = 0; geometryIndex < m_allGeometry.size(); geometryIndex++)
+	{
+		if (!m_allGeometry[geometryIndex]->m_rigidbody->m_isAlive)
+		{
+			m_allGeometry[geometryIndex]->ReleaseRigidbody();
+			m_allGeometry[geometryIndex]->m_collider = nullptr;
+			m_allGeometry[geometryIndex]->m_rigidbody = nullptr;
+		}
+
+		if(m_allGeometry[geometryIndex] == nullptr)
+		{
+			continue;
+		}
+
+		bool isOffRight = (m_allGeometry[geometryIndex]->m_transform.m_position.x > m_worldBounds.m_maxBounds.x);
+		bool isOffLeft = (m_allGeometry[geometryIndex]->m_transform.m_position.x < m_worldBounds.m_minBounds.x);
+		bool isOffBottom = (m_allGeometry[geometryIndex]->m_transform.m_position.y < m_worldBounds.m_minBounds.y);
+		bool isOffTop = (m_allGeometry[geometryIndex]->m_transform.m_position.y > m_worldBounds.m_maxBounds.y);
+
+		if(isOffRight || isOffLeft || isOffTop || isOffBottom)
+		{
+			if(m_allGeometry[geometryIndex] == m_selectedGeometry)
+			{
+				m_selectedGeometry = nullptr;
+			}
+
+			DestroyGeometry(m_allGeometry[geometryIndex]);
+			m_allGeometry[geometryIndex] = nullptr;
+			m_allGeometry.erase(m_allGeometry.begin() + geometryIndex);
+			geometryIndex--;
+			numCollected++;
+		}
 
-	g_debugRenderer->Setup3DCamera(&debugCamera3D);
-	g_debugRenderer->DebugRenderToCamera();
+	}
 
-	g_renderContext->EndCamera();
+	g_physicsWorld->GetPhysicsSystem().PurgeDeletedObjects();
+
+	for (int geometryIndex = 0; geometryIndex < m_allGeometry.size(); geometryIndex++)
+	{
+		if (m_allGeometry[geometryIndex]->m_rigidbody == nullptr)
+		{
+			//Destroy commands can come from anywhere, not only the selection
+			if(m_allGeometry[geometryIndex] == m_selectedGeometry)
+			{
+				m_selectedGeometry = nullptr;
+			}
+
+			DestroyGeometry(m_allGeometry[geometryIndex]);
+			m_allGeometry[geometryIndex] = nullptr;
+			m_allGeometry.erase(m_allGeometry.begin() + geometryIndex);
+			geometryIndex--;
+			numCollected++;
+		}
+	}
+
+	g_physicsWorld->OnBodiesCollected(numCollected);
+	m_garbageSeconds += GetCurrentTimeSeconds() - startSeconds;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::PostRender()
+bool Game::StartPhysicsStatsStream(const std::string& filePath)
 {
-	if(!m_isDebugSetup)
+	if (!m_physicsStatsStream.Open(filePath, PhysicsStatsStream::GetFormatForPath(filePath)))
 	{
-		//SetStartupDebugRenderObjects();
+		return false;
+	}
 
-		ColorTargetView* ctv = g_renderContext->GetFrameColorTarget();
-		//Setup debug render client data
-		g_debugRenderer->SetClientDimensions( ctv->m_height, ctv->m_width );
-		g_debugRenderer->SetWorldSize2D(m_mainCamera->GetOrthoBottomLeft(), m_mainCamera->GetOrthoTopRight());
+	//The first row only counts events from here on
+	m_streamedStats = g_physicsWorld->GetStats();
+	m_garbageSeconds = 0.0;
+	return true;
+}
 
-		m_isDebugSetup = true;
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StopPhysicsStatsStream()
+{
+	if (!m_physicsStatsStream.IsOpen())
+	{
+		return;
 	}
 
-	//All screen Debug information
-	DebugRenderToScreen();
+	m_physicsStatsStream.Close();
+	g_devConsole->PrintString(Rgba::GREEN, Stringf("Wrote %d physics stat rows to %s", m_physicsStatsStream.GetNumRows(), m_physicsStatsStream.GetFilePath().c_str()));
+}
 
-	ClearGarbageEntities();
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::WritePhysicsStatsRow()
+{
+	const PhysicsStats& stats = g_physicsWorld->GetStats();
+
+	PhysicsStatsRow row;
+	row.m_step = m_isDeterministic ? m_simulationStep : m_physicsStatsStream.GetNumRows();
+	row.m_timeSeconds = GetCurrentTimeSeconds();
+	row.m_numBodies = stats.m_numBodies;
+	row.m_numStatic = stats.m_numStatic;
+	row.m_numDynamic = stats.m_numDynamic;
+	row.m_numAwake = CountAwakeBodies();
+	row.m_numTriggers = stats.m_numTriggers;
+	row.m_numBroadphasePairs = m_broadphase.CountOverlappingPairs();
+	row.m_numContacts = stats.m_numContactEventsTotal - m_streamedStats.m_numContactEventsTotal;
+	row.m_numTriggerEnters = stats.m_numTriggerEntersTotal - m_streamedStats.m_numTriggerEntersTotal;
+	row.m_numTriggerExits = stats.m_numTriggerExitsTotal - m_streamedStats.m_numTriggerExitsTotal;
+	row.m_numCollected = stats.m_numCollectedTotal - m_streamedStats.m_numCollectedTotal;
+	row.m_physicsStepMS = static_cast<float>(m_physicsStepSeconds * 1000.0);
+	row.m_garbageMS = static_cast<float>(m_garbageSeconds * 1000.0);
+	row.m_broadphaseMS = static_cast<float>(m_broadphaseSeconds * 1000.0);
+
+	m_physicsStatsStream.AppendRow(row);
+	m_streamedStats = stats;
+	m_garbageSeconds = 0.0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::Update( float deltaTime )
+int Game::CountAwakeBodies() const
 {
-	//UpdateCamera(deltaTime);
+	float awakeSpeedSquared = PHYSICS_AWAKE_SPEED * PHYSICS_AWAKE_SPEED;
+	int numAwake = 0;
+	for (int geometryIndex = 0; geometryIndex < (int)m_allGeometry.size(); geometryIndex++)
+	{
+		Rigidbody2D* rigidbody = m_allGeometry[geometryIndex]->m_rigidbody;
+		if (rigidbody == nullptr || rigidbody->GetSimulationType() != DYNAMIC_SIMULATION)
+		{
+			continue;
+		}
 
-	m_gameCursor->Update(deltaTime);
+		const Vec2& velocity = rigidbody->m_velocity;
+		if (velocity.x * velocity.x + velocity.y * velocity.y > awakeSpeedSquared || fabsf(rigidbody->m_angularVelocity) > PHYSICS_AWAKE_SPEED)
+		{
+			numAwake++;
+		}
+	}
 
-	UpdateGeometry(deltaTime);
+	return numAwake;
+}
 
-	if(m_selectedGeometry != nullptr)
-	{
-		m_selectedGeometry->m_transform.m_position = m_gameCursor->GetCursorPositon();
-	}
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CheckCollisions()
+{
+	//Look for any collisions and call required methods for collision handling
+	
+}
 
-	if (g_devConsole->GetFrameCount() > 1 && !m_consoleDebugOnce)
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::IsAlive()
+{
+	//Check if alive
+	return m_isGameAlive;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC Vec2 Game::GetClientToWorldPosition2D( IntVec2 mousePosInClient, IntVec2 ClientBounds )
+{
+	Clamp(static_cast<float>(mousePosInClient.x), 0.f, static_cast<float>(ClientBounds.x));
+	Clamp(static_cast<float>(mousePosInClient.y), 0.f, static_cast<float>(ClientBounds.y));
+
+	float posOnX = RangeMapFloat(static_cast<float>(mousePosInClient.x), 0.0f, static_cast<float>(ClientBounds.x), 0.f, WORLD_WIDTH);
+	float posOnY = RangeMapFloat(static_cast<float>(mousePosInClient.y), static_cast<float>(ClientBounds.y), 0.f, 0.f, WORLD_HEIGHT);
+
+	return Vec2(posOnX, posOnY);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 Game::GetCursorWorldPosition() const
+{
+	if(m_isCursorOverridden)
 	{
-		//We have rendered the 1st frame
-		m_devConsoleCamera->SetOrthoView(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT));
-		m_consoleDebugOnce = true;
+		return m_cursorOverride;
 	}
 
+	return GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::UpdateGeometry( float deltaTime )
+void Game::SetCursorOverride(const Vec2& worldPosition)
 {
-	// let physics system play out
-	g_physicsSystem->Update(deltaTime);
+	m_isCursorOverridden = true;
+	m_cursorOverride = worldPosition;
+	m_gameCursor->SetCursorPosition(worldPosition);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::UpdateCamera(float deltaTime)
+void Game::ClearCursorOverride()
 {
-	m_mainCamera = new Camera();
-	Vec2 orthoBottomLeft = Vec2(0.f,0.f);
-	Vec2 orthoTopRight = Vec2(WORLD_WIDTH, WORLD_HEIGHT);
-	m_mainCamera->SetOrthoView(orthoBottomLeft, orthoTopRight);
+	m_isCursorOverridden = false;
+}
 
-	float shakeX = 0.f;
-	float shakeY = 0.f;
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ToggleSimType()
+{
+	m_isStatic = !m_isStatic;
+}
 
-	if(g_shakeAmount > 0)
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ChangeCurrentGeometry()
+{
+	if(m_geometryType == BOX_GEOMETRY)
 	{
-		shakeX = g_randomNumGen->GetRandomFloatInRange(-g_shakeAmount, g_shakeAmount);
-		shakeY = g_randomNumGen->GetRandomFloatInRange(-g_shakeAmount, g_shakeAmount);
-
-		g_shakeAmount -= deltaTime * CAMERA_SHAKE_REDUCTION_PER_SECOND;
+		m_geometryType = CAPSULE_GEOMETRY;
 	}
 	else
 	{
-		g_shakeAmount = 0;
+		m_geometryType = BOX_GEOMETRY;
 	}
-
-	Vec2 translate2D = Vec2(shakeX, shakeY);
-	translate2D.ClampLength(MAX_SHAKE);
-	m_mainCamera->Translate2D(translate2D);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::UpdateCameraMovement( unsigned char keyCode )
+uint32_t Game::QueueSpawn(eSimulationType simulationType, eGeometryType geometryType, const Vec2& position, float rotationDegrees, float length, const Vec2& endPosition, const char* collisionEvent)
 {
-	switch( keyCode )
+	PhysicsCommand spawn;
+	spawn.m_simulationType = simulationType;
+	spawn.m_geometryType = geometryType;
+	spawn.m_position = position;
+	spawn.m_rotationDegrees = rotationDegrees;
+	spawn.m_length = length;
+	spawn.m_endPosition = endPosition;
+	spawn.m_collisionEvent = collisionEvent;
+
+	spawn.m_mass = (simulationType == STATIC_SIMULATION) ? INFINITY : m_objectMass;
+	spawn.m_friction = m_objectFriction;
+	spawn.m_restitution = m_objectRestitution;
+	spawn.m_linearDrag = m_objectLinearDrag;
+	spawn.m_angularDrag = m_objectAngularDrag;
+
+	uint32_t bodyID = g_physicsWorld->QueueCreateBody(spawn);
+	if (bodyID == 0)
 	{
-	case W_KEY:
+		g_devConsole->PrintString(Rgba::RED, "Physics command queue is full, spawn dropped");
+	}
+
+	return bodyID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SaveToFile(const std::string& filePath)
+{
+	//Synchronous save, the key and console go through QueueSave instead
+	WorldSnapshot snapshot;
+	CaptureSnapshot(snapshot);
+
+	if (!snapshot.SaveToXmlFile(filePath))
 	{
-		if(m_mainCamera->GetOrthoTopRight().y < m_worldBounds.m_maxBounds.y)
-		{
-			//Move the camera up
-			m_mainCamera->Translate2D(Vec2(0.f, 1.0f));
-		}
+		g_devConsole->PrintString(Rgba::RED, "Could not save to " + filePath);
 	}
-	break;
-	case S_KEY:
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::LoadFromFile(const std::string& filePath)
+{
+	//Delete all existing objects
+	DestroyAllGeometry();
+
+	//Stream the file a tag at a time, only a small batch of bodies is ever held in memory
+	XmlStreamReader reader;
+	if (!reader.Open(filePath))
 	{
-		if(m_mainCamera->GetOrthoBottomLeft().y > m_worldBounds.m_minBounds.y)
-		{
-			//Move the camera down
-			m_mainCamera->Translate2D(Vec2(0.f, -1.0f));
-		}
+		ERROR_AND_DIE(">> Error loading Save Game XML file ");
+		return;
 	}
-	break;
-	case A_KEY:
+
+	XmlStreamElement element;
+	GeometrySnapshotRecord record;
+	int colliderType = -1;
+
+	std::vector<GeometrySnapshotRecord> batch;
+	batch.reserve(XML_LOAD_BATCH_SIZE);
+	std::vector<GeometrySnapshotRecord> staticRecords;
+
+	while (reader.ReadNextElement(element))
 	{
-		//For when we are over world bounds
-		if(m_mainCamera->GetOrthoTopRight().x > m_worldBounds.m_maxBounds.x)
+		if (element.m_name == "SavedGeometry")
 		{
-			//Move the camera left
-			m_mainCamera->Translate2D(Vec2(-1.f, 0.0f));
+			if (!element.m_isEndTag)
+			{
+				int numObjects = element.GetAttribute("Count", 0);
+				int numStatic = element.GetAttribute("StaticCount", 0);
+
+				m_allGeometry.reserve(numObjects);
+				staticRecords.reserve(numStatic);
+				g_physicsWorld->ReserveRigidbodies(DYNAMIC_SIMULATION, numObjects - numStatic);
+			}
 		}
+		else if (element.m_name == "GeometryData")
+		{
+			if (!element.m_isEndTag)
+			{
+				record = GeometrySnapshotRecord();
+				colliderType = -1;
+				continue;
+			}
 
-		//For when we are inside the world bounds
-		if(m_mainCamera->GetOrthoBottomLeft().x > m_worldBounds.m_minBounds.x)
+			//Static bodies are held back for the board
+			if (record.m_simulationType == STATIC_SIMULATION)
+			{
+				staticRecords.push_back(record);
+				continue;
+			}
+
+			batch.push_back(record);
+			if ((int)batch.size() == XML_LOAD_BATCH_SIZE)
+			{
+				g_physicsWorld->CreateGeometryBatch(batch.data(), (int)batch.size(), m_allGeometry);
+				batch.clear();
+			}
+		}
+		else if (element.m_name == "RigidBody")
 		{
-			//Move the camera left
-			m_mainCamera->Translate2D(Vec2(-1.f, 0.0f));
+			ReadRigidbodyElement(element, record, colliderType);
+		}
+		else if (element.m_name == "Collider")
+		{
+			ReadColliderElement(element, colliderType, record);
+		}
+		else if (element.m_name == "Transform")
+		{
+			record.m_position = element.GetAttribute("Position", Vec2::ZERO);
+			record.m_rotation = element.GetAttribute("Rotation", 0.f);
+			record.m_scale = element.GetAttribute("Scale", Vec2::ZERO);
 		}
 	}
+
+	if (reader.HasError())
+	{
+		ERROR_AND_DIE(">> Error loading Save Game XML file ");
+	}
+
+	g_physicsWorld->CreateGeometryBatch(batch.data(), (int)batch.size(), m_allGeometry);
+	AttachStaticBoard(staticRecords.data(), (int)staticRecords.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ReadRigidbodyElement(const XmlStreamElement& element, GeometrySnapshotRecord& record, int& out_colliderType)
+{
+	record.m_simulationType = element.GetAttribute("SimType", 0);
+	out_colliderType = element.GetAttribute("Shape", 0);
+	record.m_mass = element.GetAttribute("Mass", 0.1f);
+	record.m_friction = element.GetAttribute("Friction", 0.f);
+	record.m_angularDrag = element.GetAttribute("AngularDrag", 0.f);
+	record.m_linearDrag = element.GetAttribute("LinearDrag", 0.f);
+	record.m_constraints = element.GetAttribute("Freedom", Vec3::ONE);
+	record.m_momentOfInertia = element.GetAttribute("Moment", INFINITY);
+	record.m_restitution = element.GetAttribute("Restitution", 1.f);
+
+	if (record.m_simulationType == STATIC_SIMULATION)
+	{
+		record.m_constraints = Vec3(0.f, 0.f, 0.f);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ReadColliderElement(const XmlStreamElement& element, int colliderType, GeometrySnapshotRecord& record)
+{
+	switch (colliderType)
+	{
+	case COLLIDER_AABB2:
+	{
+		record.m_geometryType = AABB2_GEOMETRY;
+		record.m_size = element.GetAttribute("Size", Vec2::ZERO);
+	}
 	break;
-	case D_KEY:
+	case COLLIDER_DISC:
 	{
-		//When we are bigger than the world bounds
-		if(m_mainCamera->GetOrthoBottomLeft().x < m_worldBounds.m_minBounds.x)
-		{
-			//Move the camera right
-			m_mainCamera->Translate2D(Vec2(1.f, 0.0f));
-		}
+		record.m_geometryType = DISC_GEOMETRY;
+		record.m_radius = element.GetAttribute("Radius", 0.f);
+	}
+	break;
+	case COLLIDER_BOX:
+	{
+		record.m_geometryType = BOX_GEOMETRY;
+		record.m_position = element.GetAttribute("Center", Vec2::ZERO);
+		record.m_size = element.GetAttribute("Size", Vec2::ZERO);
+		record.m_shapeRotation = element.GetAttribute("Rotation", 0.f);
+		record.m_bodyRotation = record.m_shapeRotation;
+	}
+	break;
+	case COLLIDER_CAPSULE:
+	{
+		record.m_geometryType = CAPSULE_GEOMETRY;
+		record.m_start = element.GetAttribute("Start", Vec2::ZERO);
+		record.m_end = element.GetAttribute("End", Vec2::ZERO);
+		record.m_radius = element.GetAttribute("Radius", 0.f);
 
-		//For when we are inside the world bounds
-		if(m_mainCamera->GetOrthoTopRight().x < m_worldBounds.m_maxBounds.x)
+		Vec2 disp = record.m_start - record.m_end;
+		record.m_shapeRotation = disp.GetAngleDegrees() + 90.f;
+		record.m_bodyRotation = record.m_shapeRotation;
+		record.m_position = record.m_start;
+
+		if (record.m_simulationType == STATIC_SIMULATION)
 		{
-			//Move the camera right
-			m_mainCamera->Translate2D(Vec2(1.f, 0.0f));
+			record.m_mass = INFINITY;
 		}
 	}
 	break;
 	default:
+	{
+		ERROR_AND_DIE("The rigidbody shape in XML file is unknown");
+	}
 	break;
 	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::SaveSnapshot(const std::string& filePath) const
+{
+	WorldSnapshot snapshot;
+	CaptureSnapshot(snapshot);
+
+	return snapshot.SaveToFile(filePath);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CaptureSnapshot(WorldSnapshot& out_snapshot) const
+{
+	out_snapshot.m_records.clear();
+	out_snapshot.m_records.reserve(m_allGeometry.size());
+
+	int numGeometry = static_cast<int>(m_allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		if (m_allGeometry[index] == nullptr || m_allGeometry[index]->m_rigidbody == nullptr)
+		{
+			continue;
+		}
+
+		out_snapshot.m_records.emplace_back();
+		out_snapshot.m_records.back().SetFromGeometry(*m_allGeometry[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::QueueSave(const std::string& filePath)
+{
+	//Capture happens here between frames, the writer thread does everything else
+	WorldSnapshot snapshot;
+	m_saveWriter->AcquireSnapshot(snapshot);
+	CaptureSnapshot(snapshot);
+
+	bool isXml = filePath.size() >= 4 && filePath.compare(filePath.size() - 4, 4, ".xml") == 0;
+	m_saveWriter->QueueSave(filePath, isXml ? SAVE_FORMAT_XML : SAVE_FORMAT_SNAPSHOT, snapshot);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateSaves()
+{
+	m_saveWriter->DispatchCompletedSaves();
+
+	if (m_autosaveIntervalSeconds <= 0.f)
+	{
+		return;
+	}
+
+	double currentTime = GetCurrentTimeSeconds();
+	if (currentTime - m_lastAutosaveTime < m_autosaveIntervalSeconds)
+	{
+		return;
+	}
 
+	//Skip a beat rather than pile up saves behind a slow disk
+	if (!m_saveWriter->IsBusy())
+	{
+		QueueSave(m_autosavePath);
+	}
+	m_lastAutosaveTime = currentTime;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::ClearGarbageEntities()
+STATIC void Game::OnSaveComplete(const SaveResult& result)
 {
-	//Kill any entity off screen
-	for (int geometryIndex = 0; geometryIndex < m_allGeometry.size(); geometryIndex++)
+	if (result.m_succeeded)
 	{
-		if (!m_allGeometry[geometryIndex]->m_rigidbody->m_isAlive)
-		{
-			m_allGeometry[geometryIndex]->m_collider = nullptr;
-			m_allGeometry[geometryIndex]->m_rigidbody = nullptr;
-		}
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Saved %d objects to %s (%.1f ms on the writer thread)", result.m_numRecords, result.m_filePath.c_str(), result.m_writeSeconds * 1000.0));
+	}
+	else
+	{
+		g_devConsole->PrintString(Rgba::RED, "Could not save to " + result.m_filePath);
+	}
+}
 
-		if(m_allGeometry[geometryIndex] == nullptr)
-		{
-			continue;
-		}
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::LoadSnapshot(const std::string& filePath)
+{
+	WorldSnapshot snapshot;
+	if (!snapshot.LoadFromFile(filePath))
+	{
+		return false;
+	}
 
-		bool isOffRight = (m_allGeometry[geometryIndex]->m_transform.m_position.x > m_worldBounds.m_maxBounds.x);
-		bool isOffLeft = (m_allGeometry[geometryIndex]->m_transform.m_position.x < m_worldBounds.m_minBounds.x);
-		bool isOffBottom = (m_allGeometry[geometryIndex]->m_transform.m_position.y < m_worldBounds.m_minBounds.y);
-		bool isOffTop = (m_allGeometry[geometryIndex]->m_transform.m_position.y > m_worldBounds.m_maxBounds.y);
+	RestoreSnapshot(snapshot);
+	return true;
+}
 
-		if(isOffRight || isOffLeft || isOffTop || isOffBottom)
-		{
-			if(m_allGeometry[geometryIndex] == m_selectedGeometry)
-			{
-				m_selectedGeometry = nullptr;
-			}
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RestoreSnapshot(const WorldSnapshot& snapshot)
+{
+	DestroyAllGeometry();
 
-			delete m_allGeometry[geometryIndex];
-			m_allGeometry[geometryIndex] = nullptr;
-			m_allGeometry.erase(m_allGeometry.begin() + geometryIndex);
-			geometryIndex--;
-		}
+	int numRecords = static_cast<int>(snapshot.m_records.size());
+	AttachStaticBoard(snapshot.m_records.data(), numRecords);
+	g_physicsWorld->CreateDynamicGeometryBatch(snapshot.m_records.data(), numRecords, m_allGeometry);
+}
 
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::StartCheckpoints(const std::string& pathPrefix, float intervalSeconds)
+{
+	CaptureSnapshot(m_checkpointCapture);
+	if (!m_checkpointLog.Begin(pathPrefix, m_checkpointCapture))
+	{
+		return false;
 	}
 
-	g_physicsSystem->PurgeDeletedObjects();
+	m_checkpointIntervalSeconds = intervalSeconds;
+	m_timeSinceCheckpoint = 0.f;
+	return true;
+}
 
-	for (int geometryIndex = 0; geometryIndex < m_allGeometry.size(); geometryIndex++)
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StopCheckpoints()
+{
+	m_checkpointLog.End();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CaptureBodyStates(std::vector<BodyStateRecord>& out_bodies) const
+{
+	out_bodies.clear();
+
+	int numGeometry = static_cast<int>(m_allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
 	{
-		if (m_allGeometry[geometryIndex]->m_rigidbody == nullptr)
+		const Geometry* geometry = m_allGeometry[index];
+		if (geometry == nullptr || geometry->m_rigidbody == nullptr || geometry->m_rigidbody->GetSimulationType() != DYNAMIC_SIMULATION)
 		{
-			delete m_allGeometry[geometryIndex];
-			m_allGeometry[geometryIndex] = nullptr;
-			m_allGeometry.erase(m_allGeometry.begin() + geometryIndex);
-			geometryIndex--;
+			continue;
 		}
+
+		out_bodies.emplace_back();
+		out_bodies.back().SetFromGeometry(*geometry);
+	}
+
+	//The stream wants id order, which is creation order unless a load restored older ids
+	auto isLess = [](const BodyStateRecord& a, const BodyStateRecord& b) { return a.m_id < b.m_id; };
+	if (!std::is_sorted(out_bodies.begin(), out_bodies.end(), isLess))
+	{
+		std::sort(out_bodies.begin(), out_bodies.end(), isLess);
 	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::CheckCollisions()
+void Game::StartHistory(const QuantizationSettings& settings, int keyframeInterval)
 {
-	//Look for any collisions and call required methods for collision handling
-	
+	m_historyStream.Reset(m_worldBounds, settings, keyframeInterval);
+	m_isRecordingHistory = true;
+	m_historyStep = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::IsAlive()
+void Game::StopHistory()
 {
-	//Check if alive
-	return m_isGameAlive;
+	m_isRecordingHistory = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-STATIC Vec2 Game::GetClientToWorldPosition2D( IntVec2 mousePosInClient, IntVec2 ClientBounds )
+void Game::PrintHistoryStats() const
 {
-	Clamp(static_cast<float>(mousePosInClient.x), 0.f, static_cast<float>(ClientBounds.x));
-	Clamp(static_cast<float>(mousePosInClient.y), 0.f, static_cast<float>(ClientBounds.y));
-
-	float posOnX = RangeMapFloat(static_cast<float>(mousePosInClient.x), 0.0f, static_cast<float>(ClientBounds.x), 0.f, WORLD_WIDTH);
-	float posOnY = RangeMapFloat(static_cast<float>(mousePosInClient.y), static_cast<float>(ClientBounds.y), 0.f, 0.f, WORLD_HEIGHT);
+	int numFrames = m_historyStream.GetNumFrames();
+	double kiloBytes = static_cast<double>(m_historyStream.GetNumBytes()) / 1024.0;
+	double bytesPerFrame = numFrames > 0 ? static_cast<double>(m_historyStream.GetNumBytes()) / numFrames : 0.0;
 
-	return Vec2(posOnX, posOnY);
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("History: %d frames, %.1f KB, %.1f bytes per frame", numFrames, kiloBytes, bytesPerFrame));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::ToggleSimType()
+void Game::RecordRewindFrame()
 {
-	m_isStatic = !m_isStatic;
+	PROFILE_SCOPE("Rewind Record");
+
+	//Nothing moves while paused, and that is when the buffer gets scrubbed
+	if (!m_rewindTimeline.IsActive() || g_gameClock->IsPaused())
+	{
+		return;
+	}
+
+	if (m_scrubFrame >= 0)
+	{
+		//Simulating again after a scrub, the frames after it are a different future now
+		m_rewindTimeline.BranchFrom(m_scrubFrame);
+		m_scrubFrame = -1;
+	}
+
+	//Keep the full record of new bodies so they can be brought back after they die
+	uint32_t highestArchivedID = m_rewindTimeline.GetHighestArchivedID();
+	int numGeometry = static_cast<int>(m_allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		const Geometry* geometry = m_allGeometry[index];
+		if (geometry == nullptr || geometry->m_id <= highestArchivedID || geometry->m_rigidbody == nullptr)
+		{
+			continue;
+		}
+
+		if (geometry->m_rigidbody->GetSimulationType() == DYNAMIC_SIMULATION)
+		{
+			GeometrySnapshotRecord record;
+			record.SetFromGeometry(*geometry);
+			m_rewindTimeline.ArchiveBody(record);
+		}
+	}
+
+	CaptureBodyStates(m_rewindCapture);
+	m_rewindTimeline.RecordFrame(m_rewindCapture);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::ChangeCurrentGeometry()
+void Game::ScrubTimeline(int numFrames)
 {
-	if(m_geometryType == BOX_GEOMETRY)
+	int numBufferedFrames = m_rewindTimeline.GetNumFrames();
+	if (numBufferedFrames == 0)
 	{
-		m_geometryType = CAPSULE_GEOMETRY;
+		return;
 	}
-	else
+
+	int currentFrame = (m_scrubFrame >= 0) ? m_scrubFrame : numBufferedFrames - 1;
+	int targetFrame = std::max(0, std::min(currentFrame + numFrames, numBufferedFrames - 1));
+
+	if (RestoreRewindFrame(targetFrame))
 	{
-		m_geometryType = BOX_GEOMETRY;
+		m_scrubFrame = targetFrame;
 	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::SaveToFile(const std::string& filePath)
+bool Game::RestoreRewindFrame(int frameIndex)
 {
-	//Save all your shit to the file
-	tinyxml2::XMLDocument saveDoc;
-
-	tinyxml2::XMLNode* rootNode = saveDoc.NewElement("SavedGeometry");
-	saveDoc.InsertFirstChild(rootNode);
-
-	int numObjects = (int)m_allGeometry.size();
-	for (int index = 0; index < numObjects; index++)
-	{
-		//Save all the object properties using XML
-		XMLElement* geometry = saveDoc.NewElement("GeometryData");
-		XMLElement* rbElem = saveDoc.NewElement("RigidBody");
-		geometry->InsertEndChild(rbElem);
-
-		//Rigidbody data
-		rbElem->SetAttribute("SimType", m_allGeometry[index]->m_rigidbody->GetSimulationType());
-		rbElem->SetAttribute("Shape", m_allGeometry[index]->m_collider->m_colliderType);
-		rbElem->SetAttribute("Mass", m_allGeometry[index]->m_rigidbody->m_mass);
-		rbElem->SetAttribute("Friction", m_allGeometry[index]->m_rigidbody->m_friction);
-		rbElem->SetAttribute("AngularDrag", m_allGeometry[index]->m_rigidbody->m_angularDrag);
-		rbElem->SetAttribute("LinearDrag", m_allGeometry[index]->m_rigidbody->m_linearDrag);
-		rbElem->SetAttribute("Freedom", m_allGeometry[index]->m_rigidbody->m_constraints.GetAsString().c_str());
-		rbElem->SetAttribute("Moment", m_allGeometry[index]->m_rigidbody->m_momentOfInertia);
-		rbElem->SetAttribute("Restitution", m_allGeometry[index]->m_rigidbody->m_material.restitution);
-
-		XMLElement* colElem = saveDoc.NewElement("Collider");
-		geometry->InsertEndChild(colElem);
-
-		//Collider data
-		eColliderType2D type = m_allGeometry[index]->m_collider->GetType();
-		Collider2D* collider = m_allGeometry[index]->m_collider;
-		
-		switch (type)
+	if (!m_rewindTimeline.DecodeFrame(frameIndex, m_rewindCapture))
+	{
+		return false;
+	}
+
+	//The held object may not exist in that frame. A hold already applied is ended here, one still queued is cancelled below
+	if (m_selectedGeometry != nullptr)
+	{
+		m_selectedGeometry->EndHold();
+		g_physicsWorld->CancelCommands(m_selectedGeometry->m_id);
+		m_selectedGeometry = nullptr;
+	}
+
+	//Dynamic bodies alive now, sorted by id to walk alongside the frame
+	std::vector<std::pair<uint32_t, int>> liveBodies;
+	int numGeometry = static_cast<int>(m_allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		const Geometry* geometry = m_allGeometry[index];
+		if (geometry != nullptr && geometry->m_rigidbody != nullptr && geometry->m_rigidbody->GetSimulationType() == DYNAMIC_SIMULATION)
 		{
-			case COLLIDER_BOX:
-			{
-				BoxCollider2D* boxCollider = reinterpret_cast<BoxCollider2D*>(collider);
-				colElem->SetAttribute("Center", boxCollider->GetWorldShape().GetCenter().GetAsString().c_str());
-				colElem->SetAttribute("Size", (Vec2(boxCollider->GetWorldShape().GetHalfExtents()) * 2.f).GetAsString().c_str());
-				colElem->SetAttribute("Rotation", boxCollider->m_rigidbody->m_rotation);
-			}
-			break;
-			case COLLIDER_CAPSULE:
-			{
-				CapsuleCollider2D* col = reinterpret_cast<CapsuleCollider2D*>(collider);
-				colElem->SetAttribute("Start", col->GetReferenceShape().m_start.GetAsString().c_str());
-				colElem->SetAttribute("End", col->GetReferenceShape().m_end.GetAsString().c_str());
-				colElem->SetAttribute("Radius", col->GetCapsuleRadius());
-			}
-			break;
+			liveBodies.push_back(std::make_pair(geometry->m_id, index));
+		}
+	}
+	std::sort(liveBodies.begin(), liveBodies.end());
+
+	//Edits queued before the restore were aimed at the present, not at the frame being restored. Bodies brought back
+	//keep their ids, so their old commands would land on them too. Runs on the game thread with the simulation idle
+	for (size_t index = 0; index < liveBodies.size(); index++)
+	{
+		g_physicsWorld->CancelCommands(liveBodies[index].first);
+	}
+	for (size_t index = 0; index < m_rewindCapture.size(); index++)
+	{
+		g_physicsWorld->CancelCommands(m_rewindCapture[index].m_id);
+	}
+
+	size_t liveIndex = 0;
+	for (int frameBodyIndex = 0; frameBodyIndex < (int)m_rewindCapture.size(); frameBodyIndex++)
+	{
+		const BodyStateRecord& body = m_rewindCapture[frameBodyIndex];
+
+		//Alive now but not yet created in that frame
+		while (liveIndex < liveBodies.size() && liveBodies[liveIndex].first < body.m_id)
+		{
+			int geometryIndex = liveBodies[liveIndex].second;
+			DestroyGeometry(m_allGeometry[geometryIndex]);
+			m_allGeometry[geometryIndex] = nullptr;
+			liveIndex++;
 		}
 
-		//Transform stuff
-		XMLElement* tranformElem = saveDoc.NewElement("Transform");
-		geometry->InsertEndChild(tranformElem);
+		if (liveIndex < liveBodies.size() && liveBodies[liveIndex].first == body.m_id)
+		{
+			body.ApplyToGeometry(*m_allGeometry[liveBodies[liveIndex].second]);
+			liveIndex++;
+			continue;
+		}
 
-		tranformElem->SetAttribute("Position", m_allGeometry[index]->m_transform.m_position.GetAsString().c_str());
-		tranformElem->SetAttribute("Rotation", m_allGeometry[index]->m_transform.m_rotation);
-		tranformElem->SetAttribute("Scale", m_allGeometry[index]->m_transform.m_scale.GetAsString().c_str());
-		
-		rootNode->InsertEndChild(geometry);
+		//Died since that frame, bring it back
+		const GeometrySnapshotRecord* archived = m_rewindTimeline.FindArchivedBody(body.m_id);
+		if (archived == nullptr)
+		{
+			continue;
+		}
+
+		GeometrySnapshotRecord record = *archived;
+		body.ApplyToRecord(record);
+		m_allGeometry.push_back(g_physicsWorld->CreateGeometry(record));
+		m_rewindTimeline.ArchiveBody(record);
 	}
-	
-	//Save to the file
-	tinyxml2::XMLError eResult = saveDoc.SaveFile(filePath.c_str());
 
-	if (eResult != tinyxml2::XML_SUCCESS)
+	for (; liveIndex < liveBodies.size(); liveIndex++)
 	{
-		printf("Error: %i\n", eResult);
-		ASSERT_RECOVERABLE(true, Stringf("Error: %i\n", eResult));
+		int geometryIndex = liveBodies[liveIndex].second;
+		DestroyGeometry(m_allGeometry[geometryIndex]);
+		m_allGeometry[geometryIndex] = nullptr;
 	}
+
+	m_allGeometry.erase(std::remove(m_allGeometry.begin(), m_allGeometry.end(), nullptr), m_allGeometry.end());
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::LoadFromFile(const std::string& filePath)
+void Game::UpdateCheckpoints(float deltaTime)
 {
-	//Delete all existing objects
+	PROFILE_SCOPE("Checkpoints");
+
+	if (!m_checkpointLog.IsActive())
+	{
+		return;
+	}
+
+	m_timeSinceCheckpoint += deltaTime;
+	if (m_timeSinceCheckpoint < m_checkpointIntervalSeconds)
+	{
+		return;
+	}
+
+	m_timeSinceCheckpoint = 0.f;
+	CaptureSnapshot(m_checkpointCapture);
+	if (!m_checkpointLog.Append(m_checkpointCapture, m_simulationStep))
+	{
+		PrintSimulationMessage(Rgba::RED, "Checkpoint write failed, stopping checkpoints");
+		m_checkpointLog.End();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DestroyAllGeometry()
+{
+	//Board bodies are left with the world, the next AttachStaticBoard keeps them or replaces them
 	for (int index = 0; index < (int)m_allGeometry.size(); index++)
 	{
-		delete m_allGeometry[index];
+		if (g_physicsWorld->IsBoardGeometry(m_allGeometry[index]))
+		{
+			m_broadphase.Remove(m_allGeometry[index]);
+		}
+		else
+		{
+			DestroyGeometry(m_allGeometry[index]);
+		}
 		m_allGeometry[index] = nullptr;
 	}
-	 
+
 	m_allGeometry.erase(m_allGeometry.begin(), m_allGeometry.end());
+	m_selectedGeometry = nullptr;
 
-	//Open the xml file and parse it
-	tinyxml2::XMLDocument saveDoc;
-	saveDoc.LoadFile(filePath.c_str());
+	//Commands queued against the old scene would spawn into or edit the new one. Every caller runs on the game thread
+	//from a handler or the constructor and destructor, where the simulation thread is idle
+	g_physicsWorld->DiscardCommands();
+}
 
-	if (saveDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DestroyGeometry(Geometry* geometry)
+{
+	if (geometry == nullptr)
 	{
-		//printf("\n >> Error loading XML file from %s ", filePath);
-		//printf("\n >> Error ID : %i ", saveDoc.ErrorID());
-		//printf("\n >> Error line number is : %i", saveDoc.ErrorLineNum());
-		//printf("\n >> Error name : %s", saveDoc.ErrorName());
-		
-		ERROR_AND_DIE(">> Error loading Save Game XML file ");
 		return;
 	}
-	else
+
+	if (m_rewindTimeline.IsActive())
 	{
-		//Load from the file and spawn required objects
-		XMLElement* rootElement = saveDoc.RootElement();
+		m_rewindTimeline.NoteDestroyed(geometry->m_id);
+	}
 
-		XMLElement* geometry = rootElement->FirstChildElement();
+	m_broadphase.Remove(geometry);
 
-		while(geometry != nullptr)
-		{
-			//Read RB data first
-			XMLElement* elem = geometry->FirstChildElement("RigidBody");
+	if (g_physicsWorld->IsBoardGeometry(geometry))
+	{
+		//The world owns it, just let the physics system purge the body. The board is no longer intact after this
+		geometry->ReleaseRigidbody();
+		geometry->m_collider = nullptr;
+		geometry->m_rigidbody = nullptr;
+		return;
+	}
 
-			int type = ParseXmlAttribute(*elem, "SimType", 0);
-			int shape = ParseXmlAttribute(*elem, "Shape", 0);
-			float mass = ParseXmlAttribute(*elem, "Mass", 0.1f);
-			float friction = ParseXmlAttribute(*elem, "Friction", 0.f);
-			float angularDrag = ParseXmlAttribute(*elem, "AngularDrag", 0.f);
-			float linearDrag = ParseXmlAttribute(*elem, "LinearDrag", 0.f);
-			Vec3 freedom = ParseXmlAttribute(*elem, "Freedom", Vec3::ONE);
-			float moment = ParseXmlAttribute(*elem, "Moment", INFINITY);
-			float restitution = ParseXmlAttribute(*elem, "Restitution", 1.f);
+	delete geometry;
+}
 
-			//Read Collider data 
-			elem = elem->NextSiblingElement("Collider");
-			Geometry* entity = nullptr;
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::AttachStaticBoard(const GeometrySnapshotRecord* records, int numRecords, const std::shared_ptr<const MappedFile>& mappedFile)
+{
+	std::shared_ptr<const StaticBoard> board = StaticBoard::Compile(records, numRecords, mappedFile);
+	bool isNewBoard = g_physicsWorld->AttachStaticBoard(board);
 
-			switch (shape)
-			{
-			case COLLIDER_BOX:
-			{
-				Vec2 center = ParseXmlAttribute(*elem, "Center", Vec2::ZERO);
-				Vec2 size = ParseXmlAttribute(*elem, "Size", Vec2::ZERO);
-				float rotation = ParseXmlAttribute(*elem, "Rotation", 0.f);
-
-				if (type == STATIC_SIMULATION)
-				{
-					if (size.x == 80.f)
-					{
-						entity = new Geometry(*g_physicsSystem, STATIC_SIMULATION, BOX_GEOMETRY, center, rotation, size.y, Vec2::ZERO, true);
-					}
-					else
-					{
-						entity = new Geometry(*g_physicsSystem, STATIC_SIMULATION, BOX_GEOMETRY, center, rotation, size.y);
-					}
-					entity->m_rigidbody->m_mass = mass;
-					entity->m_rigidbody->SetConstraints(false, false, false);
-				}
-				else
-				{
-					entity = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, BOX_GEOMETRY, center, rotation, size.y);
-					entity->m_rigidbody->m_mass = mass;
-					entity->m_rigidbody->SetConstraints(freedom);
-				}
-				entity->m_rigidbody->m_material.restitution = restitution;
-				entity->m_rigidbody->m_friction = friction;
-				entity->m_rigidbody->m_angularDrag = angularDrag;
-				entity->m_rigidbody->m_linearDrag = linearDrag;
-				entity->m_rigidbody->m_momentOfInertia = moment;
-			}
-			break;
-			case COLLIDER_CAPSULE:
-			{
-				Vec2 start = ParseXmlAttribute(*elem, "Start", Vec2::ZERO);
-				Vec2 end = ParseXmlAttribute(*elem, "End", Vec2::ZERO);
-				float radius = ParseXmlAttribute(*elem, "Radius", 0.f);
-				UNUSED(radius);
-
-				Vec2 disp = start - end;
-				Vec2 norm = disp.GetNormalized();
-				float length = disp.GetLength();
-
-				Vec2 center = end + length * norm * 0.5f;
-				float rotationDegrees = disp.GetAngleDegrees() + 90.f;
-
-				if (type == STATIC_SIMULATION)
-				{
-					entity = new Geometry(*g_physicsSystem, STATIC_SIMULATION, CAPSULE_GEOMETRY, start, rotationDegrees, 0.f, end);
-					entity->m_rigidbody->m_mass = INFINITY;
-					entity->m_rigidbody->SetConstraints(false, false, false);
-				}
-				else
-				{
-					entity = new Geometry(*g_physicsSystem, DYNAMIC_SIMULATION, CAPSULE_GEOMETRY, start, rotationDegrees, 0.f, end);
-					entity->m_rigidbody->m_mass = mass;
-					entity->m_rigidbody->SetConstraints(freedom);
-				}
-				entity->m_rigidbody->m_friction = friction;
-				entity->m_rigidbody->m_angularDrag = angularDrag;
-				entity->m_rigidbody->m_linearDrag = linearDrag;
-				entity->m_rigidbody->m_momentOfInertia = moment;
-				entity->m_rigidbody->m_material.restitution = restitution;
-			}
-			break;
-			default:
-			{
-				ERROR_AND_DIE("The rigidbody shape in XML file is unknown");
-			}
-			break;
-			}
+	std::vector<Geometry*> boardGeometry;
+	g_physicsWorld->GetBoardGeometry(boardGeometry);
+	m_allGeometry.insert(m_allGeometry.begin(), boardGeometry.begin(), boardGeometry.end());
+	return isNewBoard;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::LoadMappedScene(const std::string& filePath)
+{
+	//Shared so a new board can keep the mapping open, otherwise it closes on return once the dynamic bodies are built
+	std::shared_ptr<MappedFile> mappedFile = std::make_shared<MappedFile>();
+	if (!mappedFile->Open(filePath) || mappedFile->GetSize() < sizeof(WorldSnapshotHeader))
+	{
+		return false;
+	}
+
+	const unsigned char* fileData = static_cast<const unsigned char*>(mappedFile->GetData());
+	const WorldSnapshotHeader* header = reinterpret_cast<const WorldSnapshotHeader*>(fileData);
+	if (!WorldSnapshot::IsHeaderValid(*header))
+	{
+		return false;
+	}
 
-			//Read Collider data 
-			elem = elem->NextSiblingElement("Transform");
+	//Divided rather than multiplied, a large count would overflow a 32 bit size_t and pass
+	size_t numRecords = header->m_numRecords;
+	if ((mappedFile->GetSize() - sizeof(WorldSnapshotHeader)) / sizeof(GeometrySnapshotRecord) < numRecords)
+	{
+		return false;
+	}
 
-			Vec2 position = ParseXmlAttribute(*elem, "Position", Vec2::ZERO);
-			float rotation = ParseXmlAttribute(*elem, "Rotation", 0.f);
-			Vec2 scale = ParseXmlAttribute(*elem, "Scale", Vec2::ZERO);
+	//Records are 4 byte fields right after a 16 byte header, so they can be read where they sit in the mapping
+	const GeometrySnapshotRecord* records = reinterpret_cast<const GeometrySnapshotRecord*>(fileData + sizeof(WorldSnapshotHeader));
 
-			entity->m_transform.m_position = position;
-			entity->m_transform.m_rotation = rotation;
-			entity->m_transform.m_scale = scale;
+	DestroyAllGeometry();
 
-			m_allGeometry.push_back(entity);
+	//The board reads its records in place and keeps the mapping, unless the same board is already alive, in which case that
+	//one and its bodies are kept. Files saved before static records were written first get copied out instead
+	AttachStaticBoard(records, static_cast<int>(numRecords), mappedFile);
+	g_physicsWorld->CreateDynamicGeometryBatch(records, static_cast<int>(numRecords), m_allGeometry);
 
-			//Proceed to next sibling
-			geometry = geometry->NextSiblingElement();
-		}
-	}
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderDebugObjectInfo() const
+uint64_t Game::ComputeStateHash() const
 {
-	Vec2 mousePos = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	PROFILE_SCOPE("State Hash");
 
-	//Render the debug information of the object under the cursor
-	int numGeometry = static_cast<int>(m_allGeometry.size());
-	for(int index = 0; index < numGeometry; index++)
-	{
-		if (m_allGeometry[index]->m_collider == nullptr)
-		{
-			continue;
-		}
+	return PhysicsWorld::ComputeStateHash(m_allGeometry, m_simulationStep);
+}
 
-		if(m_allGeometry[index]->m_collider->Contains(m_gameCursor->GetCursorPositon()))
-		{
-			//Print the debug information
-			std::vector<Vertex_PCU> lineVerts;
-			Vec2 offSetPos = mousePos + m_debugOffset;
-			AddVertsForLine2D(lineVerts, mousePos, offSetPos, 0.5f, Rgba::WHITE);
-			
-			int numStrings = 0;
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderDebugObjectInfo() const
+{
+	PROFILE_SCOPE("Render Hover Info");
 
-			std::vector<Vertex_PCU> textVerts;
+	Vec2 mousePos = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
 
-			std::string printPosition = "Position : ";
-			printPosition += std::to_string(m_allGeometry[index]->m_transform.m_position.x);
-			printPosition += ", ";
-			printPosition += std::to_string(m_allGeometry[index]->m_transform.m_position.y);
+	m_hoverText.BeginFrame();
+	m_hoverLineVerts.clear();
 
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos, m_debugFontHeight, printPosition);
+	//Render the debug information of the object under the cursor, the grid only checks the cell the cursor is in
+	m_hoverBodies.clear();
+	if (m_isRenderingSnapshot)
+	{
+		GetFrontSnapshot().QueryPoint(m_gameCursor->GetCursorPositon(), m_hoverBodies);
+	}
+	else
+	{
+		m_hoverGeometry.clear();
+		m_broadphase.QueryPoint(m_gameCursor->GetCursorPositon(), m_hoverGeometry);
 
-			++numStrings;
+		m_hoverCaptures.resize(m_hoverGeometry.size());
+		for (size_t index = 0; index < m_hoverGeometry.size(); index++)
+		{
+			m_hoverCaptures[index].SetFromGeometry(*m_hoverGeometry[index]);
+			m_hoverBodies.push_back(&m_hoverCaptures[index]);
+		}
+	}
 
-			std::string printMass = "Mass : ";
-			printMass += std::to_string(m_allGeometry[index]->m_rigidbody->m_mass);
+	int numBodies = static_cast<int>(m_hoverBodies.size());
+	for(int index = 0; index < numBodies; index++)
+	{
+		const RenderBody& body = *m_hoverBodies[index];
 
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printMass);
+		//Print the debug information
+		Vec2 offSetPos = mousePos + m_debugOffset;
+		AddVertsForLine2D(m_hoverLineVerts, mousePos, offSetPos, 0.5f, Rgba::WHITE);
+		
+		int numStrings = 0;
+		BitmapFont& font = *m_squirrelFont;
 
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos, m_debugFontHeight, g_frameAllocator->Format("Position : %f, %f", body.m_position.x, body.m_position.y), Rgba::WHITE);
+		++numStrings;
 
-			std::string printVelocity = "Velocity : ";
-			printVelocity += std::to_string(m_allGeometry[index]->m_rigidbody->m_velocity.x);
-			printVelocity += ", ";
-			printVelocity += std::to_string(m_allGeometry[index]->m_rigidbody->m_velocity.y);
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Mass : %f", body.m_mass), Rgba::WHITE);
+		++numStrings;
 
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printVelocity);
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Velocity : %f, %f", body.m_velocity.x, body.m_velocity.y), Rgba::WHITE);
+		++numStrings;
 
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Friction : %f", body.m_friction), Rgba::YELLOW);
+		++numStrings;
 
-			std::string printFriction = "Friction : ";
-			printFriction += std::to_string(m_allGeometry[index]->m_rigidbody->m_friction);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printFriction, Rgba::YELLOW);
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Restitution : %f", body.m_restitution), Rgba::WHITE);
+		++numStrings;
 
-			std::string printRestitution = "Restitution : ";
-			printRestitution += std::to_string(m_allGeometry[index]->m_rigidbody->m_material.restitution);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printRestitution);
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Linear Drag : %f", body.m_linearDrag), Rgba::YELLOW);
+		++numStrings;
 
-			std::string printLDrag = "Linear Drag : ";
-			printLDrag += std::to_string(m_allGeometry[index]->m_rigidbody->m_linearDrag);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printLDrag, Rgba::YELLOW);
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Angular Drag : %f", body.m_angularDrag), Rgba::YELLOW);
+		++numStrings;
 
-			std::string printADrag = "Angular Drag : ";
-			printADrag += std::to_string(m_allGeometry[index]->m_rigidbody->m_angularDrag);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printADrag, Rgba::YELLOW);
-			++numStrings;
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Moment of Inertia : %f", body.m_momentOfInertia), Rgba::WHITE);
+		++numStrings;
+			
+		m_hoverText.AddText(font, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, g_frameAllocator->Format("Angular Velocity: %f", body.m_angularVelocity), Rgba::WHITE);
+		++numStrings;
 
-			std::string printMoment = "Moment of Inertia : ";
-			printMoment += std::to_string(m_allGeometry[index]->m_rigidbody->m_momentOfInertia);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printMoment);
-			++numStrings;
-				
-			std::string printAngular = "Angular Velocity: ";
-			printAngular += std::to_string(m_allGeometry[index]->m_rigidbody->m_angularVelocity);
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0, m_debugFontHeight * numStrings), m_debugFontHeight, printAngular);
-			++numStrings;
+		const char* printConstraints = g_frameAllocator->Format("Constraints | X= %s | Y= %s | Rotation= %s", m_xFreedom ? "FREE" : "LOCKED", m_yFreedom ? "FREE" : "LOCKED", m_rotationFreedom ? "FREE" : "LOCKED");
+		m_hoverText.AddText(font, offSetPos - Vec2(0.f, m_debugFontHeight * numStrings), m_debugFontHeight, printConstraints, Rgba::ORANGE);
+		++numStrings;
+	}
 
-			std::string printConstraints = "Constraints | X= ";
-			if(m_xFreedom)			{				printConstraints += "FREE";			}
-			else					{				printConstraints += "LOCKED";		}
-			
-			printConstraints += " | Y= ";
-			if (m_yFreedom)			{				printConstraints += "FREE";			}
-			else					{				printConstraints += "LOCKED";		}
-			
-			printConstraints += " | Rotation= ";
-			if (m_rotationFreedom)	{				printConstraints += "FREE";			}
-			else					{				printConstraints += "LOCKED";		}
+	if (!m_hoverLineVerts.empty())
+	{
+		g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+		g_renderContext->DrawVertexArray(m_hoverLineVerts);
+		m_hoverText.Draw(*g_renderContext, *m_squirrelFont);
+	}
+}
 
-			m_squirrelFont->AddVertsForText2D(textVerts, offSetPos - Vec2(0.f, m_debugFontHeight * numStrings), m_debugFontHeight, printConstraints, Rgba::ORANGE);
-			++numStrings;
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderCastPreview() const
+{
+	const std::vector<ShapeCast>& previewCasts = m_isRenderingSnapshot ? GetFrontSnapshot().m_previewCasts : m_previewCasts;
+	const std::vector<CastHit>& previewHits = m_isRenderingSnapshot ? GetFrontSnapshot().m_previewHits : m_previewHits;
+	if (m_numPreviewCasts <= 0 || previewHits.size() != previewCasts.size())
+	{
+		return;
+	}
 
-			g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-			g_renderContext->DrawVertexArray(lineVerts);
-			g_renderContext->BindTextureViewWithSampler(0U, m_squirrelFont->GetTexture());
-			g_renderContext->DrawVertexArray(textVerts);
+	//Misses run the full distance, hits stop where the shape touched and show the surface normal
+	m_previewVerts.clear();
+	int numCasts = static_cast<int>(previewCasts.size());
+	for (int castIndex = 0; castIndex < numCasts; castIndex++)
+	{
+		const ShapeCast& cast = previewCasts[castIndex];
+		const CastHit& hit = previewHits[castIndex];
+		if (hit.DidHit())
+		{
+			AddVertsForLine2D(m_previewVerts, cast.m_start, hit.m_position, 0.2f, Rgba::RED);
+			AddVertsForLine2D(m_previewVerts, hit.m_point, hit.m_point + hit.m_normal * 2.f, 0.2f, Rgba::YELLOW);
+		}
+		else
+		{
+			AddVertsForLine2D(m_previewVerts, cast.m_start, cast.m_start + cast.m_direction * cast.m_maxDistance, 0.2f, Rgba::WHITE);
 		}
 	}
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+	g_renderContext->DrawVertexArray(m_previewVerts);
 }
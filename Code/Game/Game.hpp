@@ -8,27 +8,53 @@
 
 //Game systems
 #include "Game/GameCommon.hpp"
+#include "Game/BroadphaseGrid.hpp"
+#include "Game/CheckpointLog.hpp"
 #include "Game/Geometry.hpp"
+#include "Game/GeometryBatchRenderer.hpp"
+#include "Game/HudTextBatch.hpp"
+#include "Game/InstancedShapeRenderer.hpp"
+#include "Game/PhysicsStatsStream.hpp"
+#include "Game/PhysicsWorld.hpp"
+#include "Game/RenderSnapshot.hpp"
+#include "Game/RewindTimeline.hpp"
+#include "Game/ShapeCast.hpp"
+#include "Game/SnapshotStream.hpp"
+#include "Game/StateHashLog.hpp"
 
 //------------------------------------------------------------------------------------------------------------------------------
 class Texture;
 class BitmapFont;
 class SpriteAnimDefenition;
 class Image;
+class AsyncSaveWriter;
+class MappedFile;
 class GameCursor;
 class Geometry;
 class Shader;
+class SimulationThread;
 class Trigger2D;
 struct Camera;
+struct GeometrySnapshotRecord;
+struct SaveResult;
+struct XmlStreamElement;
 struct IntVec2;
 
+//------------------------------------------------------------------------------------------------------------------------------
+enum eGeometryRenderMode
+{
+	GEOMETRY_RENDER_DEBUG,			// PhysicsSystem::DebugRender
+	GEOMETRY_RENDER_BATCHED,		// Tessellated every frame into one batch
+	GEOMETRY_RENDER_INSTANCED,		// Cached unit meshes plus one instance per body
+};
+
 //------------------------------------------------------------------------------------------------------------------------------
 class Game
 {
 
 public:
 
-	Game();
+	explicit Game(unsigned int sceneSeed, bool isDeterministic = false);
 	~Game();
 	
 	static bool				TestEvent(EventArgs& args);
@@ -38,6 +64,28 @@ public:
 	static bool				BoxTriggerExit(EventArgs& args);
 	static bool				CapsuleTriggerEnter(EventArgs& args);
 	static bool				CapsuleTriggerExit(EventArgs& args);
+	static bool				Command_SaveStateHashes(EventArgs& args);
+	static bool				Command_SaveSnapshot(EventArgs& args);
+	static bool				Command_LoadSnapshot(EventArgs& args);
+	static bool				Command_LoadMappedScene(EventArgs& args);
+	static bool				Command_Autosave(EventArgs& args);
+	static bool				Command_StartCheckpoints(EventArgs& args);
+	static bool				Command_StopCheckpoints(EventArgs& args);
+	static bool				Command_LoadCheckpoint(EventArgs& args);
+	static bool				Command_RecordHistory(EventArgs& args);
+	static bool				Command_SaveHistory(EventArgs& args);
+	static bool				Command_Rewind(EventArgs& args);
+	static bool				Command_GeometryRender(EventArgs& args);
+	static bool				Command_Culling(EventArgs& args);
+	static bool				Command_PhysicsStats(EventArgs& args);
+	static bool				Command_CastPreview(EventArgs& args);
+	static bool				Command_PhysicsStream(EventArgs& args);
+	static bool				Command_WorldBench(EventArgs& args);
+	static bool				Command_BallBatch(EventArgs& args);
+	static bool				Command_SimThread(EventArgs& args);
+	static void				OnSaveComplete(const SaveResult& result);
+	static void				RunSimulationJob(float deltaTime);
+	static void				PrintSimulationMessage(const Rgba& color, const std::string& message);
 
 	void					StartUp();
 	void					ShutDown();
@@ -59,7 +107,11 @@ public:
 	void					RenderOnScreenInfo() const;
 	void					RenderPersistantUI() const;
 	void					RenderAllGeometry() const;
+	void					CollectVisibleGeometry() const;
+	const std::vector<Geometry*>&	GetVisibleGeometry() const;
+	const RenderSnapshot&	GetFrontSnapshot() const;
 	void					RenderDebugObjectInfo() const;
+	void					RenderCastPreview() const;
 
 	void					DebugRenderToScreen() const;
 	void					DebugRenderToCamera() const;
@@ -70,6 +122,13 @@ public:
 	void					UpdateGeometry( float deltaTime );
 	void					UpdateCamera( float deltaTime );
 	void					UpdateCameraMovement(unsigned char keyCode);
+	void					UpdateCastPreview(const Vec2& castStart);
+
+	// Everything in Update past input and the cursor, run on the simulation thread when there is one
+	void					UpdateSimulation( float deltaTime );
+	void					FinishSimulationFrame();
+	void					CaptureRenderSnapshot(RenderSnapshot& out_snapshot) const;
+	bool					CanThreadSimulation() const;
 
 	void					ClearGarbageEntities();
 	void					CheckCollisions();
@@ -77,26 +136,83 @@ public:
 	bool					IsAlive();
 
 	static Vec2				GetClientToWorldPosition2D(IntVec2 mousePosInClient, IntVec2 ClientBounds);
+	Vec2					GetCursorWorldPosition() const;
+	void					SetCursorOverride(const Vec2& worldPosition);
+	void					ClearCursorOverride();
 
 	void					ToggleSimType();
 	void					ChangeCurrentGeometry();
 
+	// Spawns go through the physics world's command queue with the current object properties. Returns the new body's id
+	uint32_t				QueueSpawn(eSimulationType simulationType, eGeometryType geometryType, const Vec2& position, float rotationDegrees = 0.f, float length = 0.f, const Vec2& endPosition = Vec2::ZERO, const char* collisionEvent = nullptr);
+
 	// XML File save and load methods
 	void					SaveToFile(const std::string& filePath);
 	void					LoadFromFile(const std::string& filePath);
+	void					ReadRigidbodyElement(const XmlStreamElement& element, GeometrySnapshotRecord& record, int& out_colliderType);
+	void					ReadColliderElement(const XmlStreamElement& element, int colliderType, GeometrySnapshotRecord& record);
+
+	// Binary snapshot save and load methods
+	bool					SaveSnapshot(const std::string& filePath) const;
+	bool					LoadSnapshot(const std::string& filePath);
+	void					CaptureSnapshot(WorldSnapshot& out_snapshot) const;
+	void					RestoreSnapshot(const WorldSnapshot& snapshot);
+
+	// Base snapshot plus deltas
+	bool					StartCheckpoints(const std::string& pathPrefix, float intervalSeconds);
+	void					StopCheckpoints();
+	void					UpdateCheckpoints(float deltaTime);
+
+	// Quantized per step history of dynamic bodies
+	void					CaptureBodyStates(std::vector<BodyStateRecord>& out_bodies) const;
+	void					StartHistory(const QuantizationSettings& settings, int keyframeInterval);
+	void					StopHistory();
+	void					PrintHistoryStats() const;
+
+	// Rewind and scrub through the last few seconds
+	void					RecordRewindFrame();
+	void					ScrubTimeline(int numFrames);
+	bool					RestoreRewindFrame(int frameIndex);
+
+	// Background saving, format picked from the extension (.xml or binary snapshot)
+	void					QueueSave(const std::string& filePath);
+	void					UpdateSaves();
+	void					DestroyAllGeometry();
+	void					DestroyGeometry(Geometry* geometry);
+
+	// Static bodies come from a shared board, reloading the same board keeps its bodies. Returns true if they were created
+	bool					AttachStaticBoard(const GeometrySnapshotRecord* records, int numRecords, const std::shared_ptr<const MappedFile>& mappedFile = nullptr);
+
+	// Large static boards, read in place from a mapped snapshot
+	bool					LoadMappedScene(const std::string& filePath);
+
+	// Per step physics counters streamed to a CSV or JSON lines file
+	bool					StartPhysicsStatsStream(const std::string& filePath);
+	void					StopPhysicsStatsStream();
+	void					WritePhysicsStatsRow();
+	int						CountAwakeBodies() const;
+
+	// Deterministic simulation
+	uint64_t				ComputeStateHash() const;
+	inline bool				IsDeterministic() const { return m_isDeterministic; }
+	inline unsigned int		GetSceneSeed() const { return m_sceneSeed; }
+	inline int				GetSimulationStep() const { return m_simulationStep; }
 
 private:
 
 	bool					m_isGameAlive = false;
 	bool					m_consoleDebugOnce = false;
 
+	bool					m_isDeterministic = false;
+	unsigned int			m_sceneSeed = 0U;
+	int						m_simulationStep = 0;
+
 public:
 
 	BitmapFont*				m_squirrelFont = nullptr;
 	GameCursor*				m_gameCursor = nullptr;
-	std::vector<Geometry*>  m_allGeometry;
+	std::vector<Geometry*>  m_allGeometry;		// Starts with the bodies of g_physicsWorld's static board
 	Geometry*				m_selectedGeometry = nullptr;
-	int						m_selectedIndex;
 	float					m_fontHeight = 2.5f;
 
 	float					m_objectMass = 1.0f;
@@ -130,6 +246,10 @@ public:
 	Vec2					m_mouseStart = Vec2::ZERO;
 	Vec2					m_mouseEnd = Vec2::ZERO;
 
+	//Used by input replay to drive the cursor instead of the window
+	bool					m_isCursorOverridden = false;
+	Vec2					m_cursorOverride = Vec2::ZERO;
+
 	float					m_zoomLevel = 0.0f;
 	float					m_zoomMultiplier = 10.f;
 
@@ -144,4 +264,71 @@ public:
 
 	Trigger2D*				m_boxTrigger = nullptr;
 	Trigger2D*				m_capsuleTrigger = nullptr;
+	GeometryShape			m_boxTriggerShape;
+	GeometryShape			m_capsuleTriggerShape;
+
+	//Rebuilt every frame in Render, keep their memory between frames
+	mutable GeometryBatchRenderer	m_geometryRenderer;
+	mutable InstancedShapeRenderer	m_instancedRenderer;
+	eGeometryRenderMode		m_geometryRenderMode = GEOMETRY_RENDER_BATCHED;
+
+	//Rebuilt at the end of every Update
+	BroadphaseGrid			m_broadphase;
+	mutable std::vector<Geometry*>	m_visibleGeometry;
+	mutable std::vector<Geometry*>	m_hoverGeometry;
+	bool					m_isCullingEnabled = true;
+
+	//With a simulation thread, frames whose job is running draw the front snapshot while the job fills the back one
+	SimulationThread*		m_simulationThread = nullptr;
+	RenderSnapshot			m_renderSnapshots[2];
+	int						m_frontSnapshot = 0;
+	bool					m_isRenderingSnapshot = false;		// A job is running and Render must not touch the world
+	bool					m_isFrontSnapshotStale = true;		// The world changed without a job, capture before the next one
+	Vec2					m_castStart = Vec2::ZERO;			// Cursor as of the last Update, the job can't read the window
+	mutable std::vector<const RenderBody*>	m_visibleBodies;
+	mutable std::vector<const RenderBody*>	m_hoverBodies;
+	mutable std::vector<RenderBody>	m_hoverCaptures;		// Hovered bodies copied out of the world when drawing it directly
+
+	//Fan of casts out from the cursor, redone every frame while m_numPreviewCasts is above 0
+	ShapeCastBatch			m_castBatch;
+	ShapeCast				m_previewCastShape;
+	int						m_numPreviewCasts = 0;
+	std::vector<ShapeCast>	m_previewCasts;
+	std::vector<CastHit>	m_previewHits;
+	mutable std::vector<Vertex_PCU>	m_previewVerts;
+
+	//HUD text and lines keep their vertices between frames
+	mutable HudTextBatch	m_onScreenText;
+	mutable HudTextBatch	m_persistantText;
+	mutable HudTextBatch	m_hoverText;
+	mutable std::vector<Vertex_PCU>	m_hoverLineVerts;
+	mutable std::vector<Vertex_PCU>	m_worldBoundsVerts;
+
+	StateHashLog			m_stateHashLog;
+
+	//Stage times from the last step, garbage collection adds up until the next stats row
+	double					m_physicsStepSeconds = 0.0;
+	double					m_garbageSeconds = 0.0;
+	double					m_broadphaseSeconds = 0.0;
+	PhysicsStatsStream		m_physicsStatsStream;
+	PhysicsStats			m_streamedStats;				// Totals as of the last row, rows report the difference
+
+	AsyncSaveWriter*		m_saveWriter = nullptr;
+	float					m_autosaveIntervalSeconds = 0.f;
+	std::string				m_autosavePath = "Data/Gameplay/AutoSave.snapshot";
+	double					m_lastAutosaveTime = 0.0;
+
+	CheckpointLog			m_checkpointLog;
+	WorldSnapshot			m_checkpointCapture;
+	float					m_checkpointIntervalSeconds = 5.f;
+	float					m_timeSinceCheckpoint = 0.f;
+
+	SnapshotStream			m_historyStream;
+	std::vector<BodyStateRecord>	m_historyCapture;
+	bool					m_isRecordingHistory = false;
+	int						m_historyStep = 0;
+
+	RewindTimeline			m_rewindTimeline;
+	std::vector<BodyStateRecord>	m_rewindCapture;
+	int						m_scrubFrame = -1;
 };
@@ -5,7 +5,10 @@
 
 class AudioSystem;
 class Clock;
+class FrameAllocator;
+class FrameProfiler;
 class InputSystem;
+class PhysicsWorld;
 class RandomNumberGenerator;
 class RenderContext;
 
@@ -30,10 +33,28 @@ constexpr float DISC_MAX_RADIUS = 5.0f;
 
 constexpr float MAX_ZOOM_STEPS = 10.f;
 
+constexpr float WORLD_GRAVITY_Y = -9.8f;
+
+constexpr float DETERMINISTIC_TIME_STEP = 1.f / 60.f;
+constexpr int MAX_FIXED_STEPS_PER_FRAME = 8;
+constexpr int HEADLESS_STEPS_PER_FRAME = 256;
+
+constexpr int XML_LOAD_BATCH_SIZE = 256;
+constexpr int REWIND_CAPACITY_FRAMES = 600;
+constexpr size_t FRAME_ALLOCATOR_BYTES = 256 * 1024;
+constexpr int PROFILER_HISTORY_FRAMES = 120;
+constexpr int PROFILER_CAPTURE_FRAMES = 300;
+constexpr float PICK_RADIUS = 14.142136f;	// Clicks grab the nearest body within this distance
+constexpr float PHYSICS_AWAKE_SPEED = 0.05f;	// Dynamic bodies slower than this count as resting in physics stats
+constexpr int PHYSICS_COMMAND_QUEUE_CAPACITY = 4096;	// Commands waiting for the next step, producers are refused past this
+
 constexpr float CLIENT_ASPECT = 2.0f; // We are requesting a 1:1 aspect (square) window area
 
 extern AudioSystem* g_audio;
 extern Clock* g_gameClock;
+extern FrameAllocator* g_frameAllocator;
+extern FrameProfiler* g_profiler;
 extern InputSystem* g_inputSystem;
+extern PhysicsWorld* g_physicsWorld;
 extern RandomNumberGenerator* g_randomNumGen;
 extern RenderContext* g_renderContext;
\ No newline at end of file
@@ -63,20 +63,20 @@ void GameCursor::Update( float deltaTime )
 
 void GameCursor::Render() const
 {
-	std::vector<Vertex_PCU> ringVerts;
-	AddVertsForRing2D(ringVerts, m_cursorPosition, m_cursorRingRadius, m_cursorThickness, m_cursorColor);
+	m_ringVerts.clear();
+	AddVertsForRing2D(m_ringVerts, m_cursorPosition, m_cursorRingRadius, m_cursorThickness, m_cursorColor);
 
-	std::vector<Vertex_PCU>	lineVerts;
+	m_lineVerts.clear();
 	Vec2 vertLineOffset = Vec2(0.f, m_cursorRingRadius);
 	Vec2 horLineOffset = Vec2(m_cursorRingRadius, 0.f);
 
-	AddVertsForLine2D(lineVerts, m_cursorPosition - vertLineOffset - Vec2(0.f, 0.5f), m_cursorPosition + vertLineOffset + Vec2(0.f, 0.5f), m_cursorThickness, m_cursorColor);
-	AddVertsForLine2D(lineVerts, m_cursorPosition - horLineOffset - Vec2(0.5f, 0.f), m_cursorPosition + horLineOffset + Vec2(0.5f, 0.f), m_cursorThickness, m_cursorColor);
+	AddVertsForLine2D(m_lineVerts, m_cursorPosition - vertLineOffset - Vec2(0.f, 0.5f), m_cursorPosition + vertLineOffset + Vec2(0.f, 0.5f), m_cursorThickness, m_cursorColor);
+	AddVertsForLine2D(m_lineVerts, m_cursorPosition - horLineOffset - Vec2(0.5f, 0.f), m_cursorPosition + horLineOffset + Vec2(0.5f, 0.f), m_cursorThickness, m_cursorColor);
 
 	//g_renderContext->BindTexture(nullptr);
 	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-	g_renderContext->DrawVertexArray(lineVerts);
-	g_renderContext->DrawVertexArray(ringVerts);
+	g_renderContext->DrawVertexArray(m_lineVerts);
+	g_renderContext->DrawVertexArray(m_ringVerts);
 }
 
 void GameCursor::HandleKeyPressed( unsigned char keyCode )
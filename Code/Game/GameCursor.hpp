@@ -3,8 +3,11 @@
 //Engine Systems
 #include "Engine/Renderer/Rgba.hpp"
 
+#include "Engine/Math/Vertex_PCU.hpp"
+
 //Game Systems
 #include "Game/GameCommon.hpp"
+#include <vector>
 
 
 
@@ -35,4 +38,8 @@ private:
 	//Movement Data
 	Vec2			m_movementVector = Vec2::ZERO;
 	float			m_cursorSpeed = 0.25f;
+
+	//Reused every frame
+	mutable std::vector<Vertex_PCU>	m_ringVerts;
+	mutable std::vector<Vertex_PCU>	m_lineVerts;
 };
\ No newline at end of file
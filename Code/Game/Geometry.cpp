@@ -5,95 +5,143 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/PhysicsSystem.hpp"
 #include "Engine/Math/Rigidbody2D.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
 //Game Systems
+#include "Game/DeterministicRNG.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/PhysicsWorld.hpp"
+#include <math.h>
 
-Geometry::Geometry(PhysicsSystem& physicsSystem, eSimulationType simulationType, eGeometryType geometryType, const Vec2& cursorPosition, float rotationDegrees, float length, const Vec2& endPos, bool staticFloor)
+//------------------------------------------------------------------------------------------------------------------------------
+std::atomic<uint32_t> Geometry::s_nextID(1);
+
+//------------------------------------------------------------------------------------------------------------------------------
+static Vec2 RotateByDegrees(const Vec2& vector, float degrees)
 {
-	// First, give it a rigid body to represent itself in the physics system
-	m_rigidbody = physicsSystem.CreateRigidbody(simulationType);
-	m_rigidbody->SetSimulationMode( simulationType ); 
+	float radians = degrees * 0.01745329f;
+	float cosAngle = cosf(radians);
+	float sinAngle = sinf(radians);
+	return Vec2(vector.x * cosAngle - vector.y * sinAngle, vector.x * sinAngle + vector.y * cosAngle);
+}
 
-	m_transform.m_position = cursorPosition;
+Geometry::Geometry(PhysicsWorld& world, eSimulationType simulationType, eGeometryType geometryType, const Vec2& cursorPosition, float rotationDegrees, float length, const Vec2& endPos, bool staticFloor)
+	: m_world(&world)
+{
+	DeterministicRNG& rng = world.GetRNG();
 
-	// give it a shape
+	m_shape.m_geometryType = geometryType;
+	m_shape.m_position = cursorPosition;
+	m_shape.m_rotationDegrees = rotationDegrees;
+
+	// pick the random sizes for the shape
 	switch( geometryType )
 	{
-	case TYPE_UNKNOWN:
-	ERROR_AND_DIE("Unkown Geometry type");
-	break;
 	case AABB2_GEOMETRY:
 	{
-		float thickness;
-		Vec2 minBounds;
-		Vec2 maxBounds;
-
 		if(!staticFloor)
 		{
-			thickness = g_randomNumGen->GetRandomFloatInRange(BOX_MIN_WIDTH, BOX_MAX_WIDTH);
-
-			minBounds = Vec2(-thickness, -thickness);
-			maxBounds = Vec2(thickness, thickness);
+			float thickness = rng.GetRandomFloatInRange(BOX_MIN_WIDTH, BOX_MAX_WIDTH);
+			m_shape.m_size = Vec2(thickness, thickness) * 2.f;
 		}
 		else
 		{
-			thickness = 80.f;
+			float thickness = 80.f;
 			float height = 10.f;
-		
-			minBounds = Vec2(-thickness, -height);
-			maxBounds = Vec2(thickness, height);
-		}
-
-		
-		m_collider = m_rigidbody->SetCollider( new AABB2Collider(minBounds, maxBounds) );  
-		m_collider->m_colliderType = COLLIDER_AABB2;
-		m_collider->m_rigidbody = m_rigidbody;
-
 
+			m_shape.m_size = Vec2(thickness, height) * 2.f;
+		}
 	}
 	break;
 	case DISC_GEOMETRY:
 	{
-		float radius = g_randomNumGen->GetRandomFloatInRange(DISC_MIN_RADIUS, DISC_MAX_RADIUS);
-
-		m_collider = m_rigidbody->SetCollider(new Disc2DCollider(Vec2::ZERO, radius));
-		m_collider->m_colliderType = COLLIDER_DISC;
-		m_collider->m_rigidbody = m_rigidbody;
+		m_shape.m_radius = rng.GetRandomFloatInRange(DISC_MIN_RADIUS, DISC_MAX_RADIUS);
 	}
 	break;
 	case BOX_GEOMETRY:
 	{
-		Vec2 size;
-
 		if(!staticFloor)
 		{
-			size = Vec2(g_randomNumGen->GetRandomFloatInRange(BOX_MIN_WIDTH, BOX_MAX_WIDTH), length);
+			m_shape.m_size = Vec2(rng.GetRandomFloatInRange(BOX_MIN_WIDTH, BOX_MAX_WIDTH), length);
 		}
 		else
 		{
-			size = Vec2(80.f, 10.f);
+			m_shape.m_size = Vec2(80.f, 10.f);
 		}
+	}
+	break;
+	case CAPSULE_GEOMETRY:
+	{
+		m_shape.m_radius = rng.GetRandomFloatInRange(DISC_MIN_RADIUS, DISC_MAX_RADIUS);
+		m_shape.m_start = cursorPosition;
+		m_shape.m_end = endPos;
+	}
+	break;
+	default:
+	break;
+	}
+
+	CreateRigidbodyAndCollider(simulationType);
+}
+
+Geometry::Geometry(PhysicsWorld& world, eSimulationType simulationType, const GeometryShape& shape)
+	: m_world(&world)
+{
+	m_shape = shape;
+	CreateRigidbodyAndCollider(simulationType);
+}
+
+void Geometry::CreateRigidbodyAndCollider(eSimulationType simulationType)
+{
+	PhysicsSystem& physicsSystem = m_world->GetPhysicsSystem();
 
-		m_collider = m_rigidbody->SetCollider( new BoxCollider2D(Vec2::ZERO, size, rotationDegrees) );
-		m_rigidbody->m_rotation = rotationDegrees;
+	m_id = ReserveID();
+
+	// First, give it a rigid body to represent itself in the physics system
+	m_rigidbody = physicsSystem.CreateRigidbody(simulationType);
+	m_rigidbody->SetSimulationMode( simulationType );
+
+	m_transform.m_position = m_shape.m_position;
+	m_geometryType = m_shape.m_geometryType;
+
+	// give it a shape
+	switch( m_geometryType )
+	{
+	case TYPE_UNKNOWN:
+	ERROR_AND_DIE("Unkown Geometry type");
+	break;
+	case AABB2_GEOMETRY:
+	{
+		Vec2 maxBounds = m_shape.m_size * 0.5f;
+		Vec2 minBounds = maxBounds * -1.f;
+
+		m_collider = m_rigidbody->SetCollider( new AABB2Collider(minBounds, maxBounds) );
+		m_collider->m_colliderType = COLLIDER_AABB2;
+		m_collider->m_rigidbody = m_rigidbody;
+	}
+	break;
+	case DISC_GEOMETRY:
+	{
+		m_collider = m_rigidbody->SetCollider(new Disc2DCollider(Vec2::ZERO, m_shape.m_radius));
+		m_collider->m_colliderType = COLLIDER_DISC;
+		m_collider->m_rigidbody = m_rigidbody;
+	}
+	break;
+	case BOX_GEOMETRY:
+	{
+		m_collider = m_rigidbody->SetCollider( new BoxCollider2D(Vec2::ZERO, m_shape.m_size, m_shape.m_rotationDegrees) );
+		m_rigidbody->m_rotation = m_shape.m_rotationDegrees;
 		m_collider->m_colliderType = COLLIDER_BOX;
 		m_collider->m_rigidbody = m_rigidbody;
 	}
 	break;
 	case CAPSULE_GEOMETRY:
 	{
-		float radius = g_randomNumGen->GetRandomFloatInRange(DISC_MIN_RADIUS, DISC_MAX_RADIUS);
-
-		m_transform.m_position ;
-
-		Vec2 disp = endPos - cursorPosition;
+		Vec2 disp = m_shape.m_end - m_shape.m_start;
 		float lengthCapsule = disp.GetLength();
 		Vec2 norm = disp.GetNormalized();
-		m_transform.m_position = cursorPosition + norm * lengthCapsule * 0.5f;
+		m_transform.m_position = m_shape.m_start + norm * lengthCapsule * 0.5f;
 
-		m_collider = m_rigidbody->SetCollider( new CapsuleCollider2D(cursorPosition, endPos, radius) );  
-		m_rigidbody->m_rotation = rotationDegrees;
+		m_collider = m_rigidbody->SetCollider( new CapsuleCollider2D(m_shape.m_start, m_shape.m_end, m_shape.m_radius) );
+		m_rigidbody->m_rotation = m_shape.m_rotationDegrees;
 		m_collider->m_colliderType = COLLIDER_CAPSULE;
 		m_collider->m_rigidbody = m_rigidbody;
 	}
@@ -104,19 +152,198 @@ Geometry::Geometry(PhysicsSystem& physicsSystem, eSimulationType simulationType,
 	default:
 	break;
 	}
-	
+
 	// give it a for the physics system to affect our object
-	m_rigidbody->SetObject( this, &m_transform ); 
+	m_rigidbody->SetObject( this, &m_transform );
 	physicsSystem.AddRigidbodyToVector(m_rigidbody);
+
+	m_world->OnBodyAdded(simulationType, m_geometryType);
+	m_world->RegisterGeometry(this);
+	m_countedSimulationType = simulationType;
+	m_isCounted = true;
+}
+
+void Geometry::SetID(uint32_t id)
+{
+	if (m_isCounted)
+	{
+		m_world->UnregisterGeometry(this);
+	}
+
+	m_id = id;
+
+	//Raise the counter past the id, another thread may be reserving at the same time
+	uint32_t nextID = s_nextID.load();
+	while (id >= nextID && !s_nextID.compare_exchange_weak(nextID, id + 1))
+	{
+	}
+
+	if (m_isCounted)
+	{
+		m_world->RegisterGeometry(this);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint32_t Geometry::ReserveID()
+{
+	return s_nextID.fetch_add(1);
+}
+
+AABB2 Geometry::GetWorldBounds() const
+{
+	Vec2 halfExtents = Vec2::ZERO;
+	switch (m_shape.m_geometryType)
+	{
+	case AABB2_GEOMETRY:
+	{
+		halfExtents = m_shape.m_size * 0.5f;
+	}
+	break;
+	case DISC_GEOMETRY:
+	{
+		halfExtents = Vec2(m_shape.m_radius, m_shape.m_radius);
+	}
+	break;
+	case BOX_GEOMETRY:
+	{
+		float rotationDegrees = (m_rigidbody != nullptr) ? m_rigidbody->m_rotation : m_shape.m_rotationDegrees;
+		float radians = rotationDegrees * 0.01745329f;
+		float absCos = fabsf(cosf(radians));
+		float absSin = fabsf(sinf(radians));
+		Vec2 halfSize = m_shape.m_size * 0.5f;
+		halfExtents = Vec2(absCos * halfSize.x + absSin * halfSize.y, absSin * halfSize.x + absCos * halfSize.y);
+	}
+	break;
+	case CAPSULE_GEOMETRY:
+	{
+		//Big enough for any rotation
+		float reach = (m_shape.m_end - m_shape.m_start).GetLength() * 0.5f + m_shape.m_radius;
+		halfExtents = Vec2(reach, reach);
+	}
+	break;
+	default:
+	break;
+	}
+
+	return AABB2(m_transform.m_position - halfExtents, m_transform.m_position + halfExtents);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Points and radius of the body where it is now. Matches what GeometryBatchRenderer draws
+//------------------------------------------------------------------------------------------------------------------------------
+int Geometry::GetWorldCore(Vec2* out_points, float& out_radius) const
+{
+	float rotationDegrees = (m_rigidbody != nullptr) ? m_rigidbody->m_rotation : m_shape.m_rotationDegrees;
+	return GetShapeCore(m_shape, m_transform.m_position, rotationDegrees, out_points, out_radius);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int Geometry::GetShapeCore(const GeometryShape& shape, const Vec2& position, float rotationDegrees, Vec2* out_points, float& out_radius)
+{
+	out_radius = 0.f;
+
+	switch (shape.m_geometryType)
+	{
+	case AABB2_GEOMETRY:
+	{
+		Vec2 halfSize = shape.m_size * 0.5f;
+		out_points[0] = position + Vec2(-halfSize.x, -halfSize.y);
+		out_points[1] = position + Vec2(halfSize.x, -halfSize.y);
+		out_points[2] = position + Vec2(halfSize.x, halfSize.y);
+		out_points[3] = position + Vec2(-halfSize.x, halfSize.y);
+		return 4;
+	}
+	case DISC_GEOMETRY:
+	{
+		out_points[0] = position;
+		out_radius = shape.m_radius;
+		return 1;
+	}
+	case BOX_GEOMETRY:
+	{
+		Vec2 right = RotateByDegrees(Vec2(shape.m_size.x * 0.5f, 0.f), rotationDegrees);
+		Vec2 up = RotateByDegrees(Vec2(0.f, shape.m_size.y * 0.5f), rotationDegrees);
+		out_points[0] = position - right - up;
+		out_points[1] = position + right - up;
+		out_points[2] = position + right + up;
+		out_points[3] = position - right + up;
+		return 4;
+	}
+	case CAPSULE_GEOMETRY:
+	{
+		Vec2 halfAxis = RotateByDegrees((shape.m_end - shape.m_start) * 0.5f, rotationDegrees - shape.m_rotationDegrees);
+		out_points[0] = position - halfAxis;
+		out_points[1] = position + halfAxis;
+		out_radius = shape.m_radius;
+		return 2;
+	}
+	default:
+	return 0;
+	}
 }
 
 Geometry::~Geometry()
-{	
+{
 	//delete m_rigidbody;
 	//m_rigidbody = nullptr;
 
+	ReleaseRigidbody();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::SetSimulationType(eSimulationType simulationType)
+{
+	m_rigidbody->SetSimulationMode(simulationType);
+
+	if (m_isCounted)
+	{
+		m_world->OnSimulationTypeChanged(m_countedSimulationType, simulationType);
+		m_countedSimulationType = simulationType;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::BeginHold()
+{
+	if (m_isHeld || m_rigidbody == nullptr)
+	{
+		return;
+	}
+
+	m_heldSimulationType = m_rigidbody->GetSimulationType();
+	m_isHeld = true;
+	SetSimulationType(STATIC_SIMULATION);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::EndHold()
+{
+	if (!m_isHeld)
+	{
+		return;
+	}
+
+	m_isHeld = false;
+	if (m_rigidbody != nullptr)
+	{
+		SetSimulationType(m_heldSimulationType);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::ReleaseRigidbody()
+{
 	if (m_rigidbody != nullptr)
 	{
 		m_rigidbody->m_isAlive = false;
 	}
+
+	//Static board blocks are released on destroy and again when the block frees them
+	if (m_isCounted)
+	{
+		m_world->OnBodyRemoved(m_countedSimulationType, m_geometryType);
+		m_world->UnregisterGeometry(this);
+		m_isCounted = false;
+	}
 }
@@ -1,10 +1,13 @@
 #pragma once
 //------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/Transform2.hpp"
 #include "Engine/Math/Rigidbody2D.hpp"
+#include <atomic>
+#include <stdint.h>
 
-class PhysicsSystem;
 class Collider2D;
+class PhysicsWorld;
 
 //------------------------------------------------------------------------------------------------------------------------------
 enum eGeometryType
@@ -20,17 +23,76 @@ enum eGeometryType
 	NUM_GEOMETRY_TYPES
 };
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Everything needed to rebuild a collider exactly, without drawing from the scene RNG
+//------------------------------------------------------------------------------------------------------------------------------
+struct GeometryShape
+{
+	eGeometryType			m_geometryType = TYPE_UNKNOWN;
+	Vec2					m_position = Vec2::ZERO;
+	float					m_rotationDegrees = 0.f;
+	Vec2					m_size = Vec2::ZERO;		// AABB2 and box full size
+	Vec2					m_start = Vec2::ZERO;		// Capsule
+	Vec2					m_end = Vec2::ZERO;			// Capsule
+	float					m_radius = 0.f;				// Disc and capsule
+};
+
+constexpr int GEOMETRY_MAX_CORE_POINTS = 4;
+
 //------------------------------------------------------------------------------------------------------------------------------
 class Geometry
 {
 public:
-	explicit Geometry(PhysicsSystem& physicsSystem, eSimulationType simulationType, eGeometryType geometryType, const Vec2& cursorPosition, float rotationDegrees = 0.f, float length = 0.f, const Vec2& endPos = Vec2::ZERO, bool staticFloor = false);
+	explicit Geometry(PhysicsWorld& world, eSimulationType simulationType, eGeometryType geometryType, const Vec2& cursorPosition, float rotationDegrees = 0.f, float length = 0.f, const Vec2& endPos = Vec2::ZERO, bool staticFloor = false);
+	explicit Geometry(PhysicsWorld& world, eSimulationType simulationType, const GeometryShape& shape);
 	~Geometry();
 
+	//The world and the rigidbody hold this geometry's address, a copy or move would leave them pointing at the old one
+	Geometry(const Geometry&) = delete;
+	Geometry& operator=(const Geometry&) = delete;
+
+	//Restores an id from a save. Later geometry keeps getting ids above it
+	void					SetID(uint32_t id);
+	//Hands out an id for a body that doesn't exist yet, safe from any thread
+	static uint32_t			ReserveID();
+
+	//Loose box around the shape at its current position and rotation
+	AABB2					GetWorldBounds() const;
+
+	//The shape as a convex polygon of up to GEOMETRY_MAX_CORE_POINTS points grown by a radius. Returns the point count
+	int						GetWorldCore(Vec2* out_points, float& out_radius) const;
+	static int				GetShapeCore(const GeometryShape& shape, const Vec2& position, float rotationDegrees, Vec2* out_points, float& out_radius);
+
+	//Go through these rather than the rigidbody so the physics stats stay right
+	void					SetSimulationType(eSimulationType simulationType);
+	void					ReleaseRigidbody();
+
+	//Held bodies are made static and remember the type they had, so holding twice never loses it
+	void					BeginHold();
+	void					EndHold();
+	inline bool				IsHeld() const { return m_isHeld; }
+
+	inline PhysicsWorld*	GetWorld() const { return m_world; }
+
+private:
+	void					CreateRigidbodyAndCollider(eSimulationType simulationType);
+
+	static std::atomic<uint32_t>	s_nextID;
 
 public:
-	Transform2				m_transform; 
+	Transform2				m_transform;
 	Rigidbody2D				*m_rigidbody;
-	Collider2D				*m_collider; 
+	Collider2D				*m_collider;
 	eGeometryType			m_geometryType = TYPE_UNKNOWN;
+	GeometryShape			m_shape;
+	uint32_t				m_id = 0;			// Stable for the life of the body, used to match bodies across saves
+	int						m_broadphaseSlot = -1;	// Set by BroadphaseGrid::Rebuild
+	bool					m_isBoardGeometry = false;	// Lives in its world's static board block, the world frees it
+
+private:
+	PhysicsWorld*			m_world = nullptr;
+	eSimulationType			m_countedSimulationType = STATIC_SIMULATION;
+	bool					m_isCounted = false;	// Body is included in m_world's stats
+	eSimulationType			m_heldSimulationType = STATIC_SIMULATION;
+	bool					m_isHeld = false;
 };
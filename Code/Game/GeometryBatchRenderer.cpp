@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/GeometryBatchRenderer.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+//Game Systems
+#include "Game/RenderSnapshot.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+GeometryBatchRenderer::GeometryBatchRenderer()
+{
+	for (int side = 0; side <= DISC_SIDES; side++)
+	{
+		float radians = 6.2831853f * static_cast<float>(side) / static_cast<float>(DISC_SIDES);
+		m_unitCircle[side] = Vec2(cosf(radians), sinf(radians));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::BeginBatch()
+{
+	m_vertices.clear();
+	m_numShapes = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddAllGeometry(const std::vector<Geometry*>& allGeometry)
+{
+	//One reserve for the whole list, only grows the first time the body count goes up
+	size_t numVerts = m_vertices.size();
+	int numGeometry = static_cast<int>(allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		if (allGeometry[index] != nullptr)
+		{
+			numVerts += GetNumVertsForShape(allGeometry[index]->m_shape.m_geometryType);
+		}
+	}
+	m_vertices.reserve(numVerts);
+
+	for (int index = 0; index < numGeometry; index++)
+	{
+		if (allGeometry[index] != nullptr)
+		{
+			AddGeometry(*allGeometry[index]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddGeometry(const Geometry& geometry)
+{
+	if (geometry.m_rigidbody == nullptr)
+	{
+		return;
+	}
+
+	bool isStatic = geometry.m_rigidbody->GetSimulationType() == STATIC_SIMULATION;
+	const Rgba& fillColor = isStatic ? m_staticFillColor : m_dynamicFillColor;
+	const Rgba& outlineColor = isStatic ? m_staticOutlineColor : m_dynamicOutlineColor;
+
+	AddShape(geometry.m_shape, geometry.m_transform.m_position, geometry.m_rigidbody->m_rotation, fillColor, outlineColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddAllBodies(const std::vector<const RenderBody*>& allBodies)
+{
+	size_t numVerts = m_vertices.size();
+	int numBodies = static_cast<int>(allBodies.size());
+	for (int index = 0; index < numBodies; index++)
+	{
+		numVerts += GetNumVertsForShape(allBodies[index]->m_shape.m_geometryType);
+	}
+	m_vertices.reserve(numVerts);
+
+	for (int index = 0; index < numBodies; index++)
+	{
+		AddBody(*allBodies[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddBody(const RenderBody& body)
+{
+	bool isStatic = body.m_simulationType == STATIC_SIMULATION;
+	const Rgba& fillColor = isStatic ? m_staticFillColor : m_dynamicFillColor;
+	const Rgba& outlineColor = isStatic ? m_staticOutlineColor : m_dynamicOutlineColor;
+
+	AddShape(body.m_shape, body.m_position, body.m_rotationDegrees, fillColor, outlineColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddShape(const GeometryShape& shape, const Vec2& position, float rotationDegrees, const Rgba& fillColor, const Rgba& outlineColor)
+{
+	switch (shape.m_geometryType)
+	{
+	case AABB2_GEOMETRY:
+	{
+		AddBox(position, Vec2(shape.m_size.x * 0.5f, 0.f), Vec2(0.f, shape.m_size.y * 0.5f), fillColor, outlineColor);
+	}
+	break;
+	case DISC_GEOMETRY:
+	{
+		AddDisc(position, shape.m_radius, rotationDegrees, fillColor, outlineColor);
+	}
+	break;
+	case BOX_GEOMETRY:
+	{
+		float radians = rotationDegrees * 0.01745329f;
+		Vec2 right = Vec2(cosf(radians), sinf(radians));
+		Vec2 up = Vec2(-right.y, right.x);
+		AddBox(position, right * (shape.m_size.x * 0.5f), up * (shape.m_size.y * 0.5f), fillColor, outlineColor);
+	}
+	break;
+	case CAPSULE_GEOMETRY:
+	{
+		//The shape keeps the start and end it was made with, turn them by however far the body has rotated since
+		Vec2 halfAxis = (shape.m_end - shape.m_start) * 0.5f;
+		float radians = (rotationDegrees - shape.m_rotationDegrees) * 0.01745329f;
+		float cosAngle = cosf(radians);
+		float sinAngle = sinf(radians);
+		halfAxis = Vec2(halfAxis.x * cosAngle - halfAxis.y * sinAngle, halfAxis.x * sinAngle + halfAxis.y * cosAngle);
+
+		AddCapsule(position - halfAxis, position + halfAxis, shape.m_radius, fillColor, outlineColor);
+	}
+	break;
+	default:
+	return;
+	}
+
+	m_numShapes++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::DrawBatch(RenderContext& renderContext) const
+{
+	if (m_vertices.empty())
+	{
+		return;
+	}
+
+	renderContext.BindTextureViewWithSampler(0U, nullptr);
+	renderContext.DrawVertexArray(m_vertices);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int GeometryBatchRenderer::GetNumVertsForShape(eGeometryType geometryType)
+{
+	switch (geometryType)
+	{
+	case AABB2_GEOMETRY:
+	case BOX_GEOMETRY:
+		//Fill quad plus 4 edges
+		return 6 + 4 * 6;
+	case DISC_GEOMETRY:
+		//Fan, ring and one line to show the rotation
+		return DISC_SIDES * 3 + DISC_SIDES * 6 + 6;
+	case CAPSULE_GEOMETRY:
+		//Middle quad, 2 side lines and a half fan and half ring for each cap
+		return 6 + 2 * 6 + DISC_SIDES * 3 + DISC_SIDES * 6;
+	default:
+		return 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddTriangle(const Vec2& a, const Vec2& b, const Vec2& c, const Rgba& color)
+{
+	m_vertices.push_back(Vertex_PCU(Vec3(a.x, a.y, 0.f), color, Vec2::ZERO));
+	m_vertices.push_back(Vertex_PCU(Vec3(b.x, b.y, 0.f), color, Vec2::ZERO));
+	m_vertices.push_back(Vertex_PCU(Vec3(c.x, c.y, 0.f), color, Vec2::ZERO));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddQuad(const Vec2& bottomLeft, const Vec2& bottomRight, const Vec2& topRight, const Vec2& topLeft, const Rgba& color)
+{
+	AddTriangle(bottomLeft, bottomRight, topRight, color);
+	AddTriangle(bottomLeft, topRight, topLeft, color);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddLine(const Vec2& start, const Vec2& end, const Rgba& color)
+{
+	Vec2 direction = end - start;
+	float length = direction.GetLength();
+	if (length <= 0.f)
+	{
+		//Zero area but still written, every shape writes exactly GetNumVertsForShape vertices
+		AddQuad(start, start, start, start, color);
+		return;
+	}
+
+	float halfThickness = m_outlineThickness * 0.5f;
+	direction = direction * (halfThickness / length);
+	Vec2 normal = Vec2(-direction.y, direction.x);
+
+	//Stretch past the ends by half the thickness so corners close up
+	Vec2 lineStart = start - direction;
+	Vec2 lineEnd = end + direction;
+	AddQuad(lineStart - normal, lineEnd - normal, lineEnd + normal, lineStart + normal, color);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddBox(const Vec2& center, const Vec2& right, const Vec2& up, const Rgba& fillColor, const Rgba& outlineColor)
+{
+	Vec2 bottomLeft = center - right - up;
+	Vec2 bottomRight = center + right - up;
+	Vec2 topRight = center + right + up;
+	Vec2 topLeft = center - right + up;
+
+	AddQuad(bottomLeft, bottomRight, topRight, topLeft, fillColor);
+
+	AddLine(bottomLeft, bottomRight, outlineColor);
+	AddLine(bottomRight, topRight, outlineColor);
+	AddLine(topRight, topLeft, outlineColor);
+	AddLine(topLeft, bottomLeft, outlineColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddDisc(const Vec2& center, float radius, float rotationDegrees, const Rgba& fillColor, const Rgba& outlineColor)
+{
+	float halfThickness = m_outlineThickness * 0.5f;
+	float innerRadius = radius - halfThickness;
+	float outerRadius = radius + halfThickness;
+
+	for (int side = 0; side < DISC_SIDES; side++)
+	{
+		const Vec2& current = m_unitCircle[side];
+		const Vec2& next = m_unitCircle[side + 1];
+
+		AddTriangle(center, center + current * radius, center + next * radius, fillColor);
+		AddQuad(center + current * innerRadius, center + current * outerRadius, center + next * outerRadius, center + next * innerRadius, outlineColor);
+	}
+
+	float radians = rotationDegrees * 0.01745329f;
+	AddLine(center, center + Vec2(cosf(radians), sinf(radians)) * radius, outlineColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddCapsule(const Vec2& start, const Vec2& end, float radius, const Rgba& fillColor, const Rgba& outlineColor)
+{
+	Vec2 axis = end - start;
+	float length = axis.GetLength();
+	Vec2 direction = (length > 0.f) ? axis * (1.f / length) : Vec2(1.f, 0.f);
+	Vec2 normal = Vec2(-direction.y, direction.x) * radius;
+
+	AddQuad(start - normal, end - normal, end + normal, start + normal, fillColor);
+	AddLine(start - normal, end - normal, outlineColor);
+	AddLine(end + normal, start + normal, outlineColor);
+
+	AddHalfDisc(end, direction, radius, fillColor, outlineColor);
+	AddHalfDisc(start, direction * -1.f, radius, fillColor, outlineColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometryBatchRenderer::AddHalfDisc(const Vec2& center, const Vec2& direction, float radius, const Rgba& fillColor, const Rgba& outlineColor)
+{
+	float halfThickness = m_outlineThickness * 0.5f;
+	float innerRadius = radius - halfThickness;
+	float outerRadius = radius + halfThickness;
+
+	//Walk the table from -90 to +90 degrees around direction
+	Vec2 perpendicular = Vec2(-direction.y, direction.x);
+	int quarter = DISC_SIDES / 4;
+	for (int step = -quarter; step < quarter; step++)
+	{
+		const Vec2& currentUnit = m_unitCircle[(step + DISC_SIDES) % DISC_SIDES];
+		const Vec2& nextUnit = m_unitCircle[(step + 1 + DISC_SIDES) % DISC_SIDES];
+
+		Vec2 current = direction * currentUnit.x + perpendicular * currentUnit.y;
+		Vec2 next = direction * nextUnit.x + perpendicular * nextUnit.y;
+
+		AddTriangle(center, center + current * radius, center + next * radius, fillColor);
+		AddQuad(center + current * innerRadius, center + current * outerRadius, center + next * outerRadius, center + next * innerRadius, outlineColor);
+	}
+}
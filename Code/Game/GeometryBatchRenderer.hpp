@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vertex_PCU.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+#include "Game/Geometry.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class RenderContext;
+struct RenderBody;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Writes the fill and outline of every body into one vertex array that is reused frame to frame, then draws it in one call.
+// Building the batch never touches the renderer so the vertices can be checked without a window
+//------------------------------------------------------------------------------------------------------------------------------
+class GeometryBatchRenderer
+{
+public:
+	GeometryBatchRenderer();
+
+	//Clears the vertices but keeps the memory for the next frame
+	void					BeginBatch();
+
+	void					AddAllGeometry(const std::vector<Geometry*>& allGeometry);
+	void					AddGeometry(const Geometry& geometry);
+	void					AddAllBodies(const std::vector<const RenderBody*>& allBodies);
+	void					AddBody(const RenderBody& body);
+	void					AddShape(const GeometryShape& shape, const Vec2& position, float rotationDegrees, const Rgba& fillColor, const Rgba& outlineColor);
+
+	//All shapes are untextured, so the whole batch is one draw
+	void					DrawBatch(RenderContext& renderContext) const;
+
+	inline const std::vector<Vertex_PCU>&	GetVertices() const { return m_vertices; }
+	inline int				GetNumShapes() const { return m_numShapes; }
+
+	static int				GetNumVertsForShape(eGeometryType geometryType);
+
+private:
+	void					AddTriangle(const Vec2& a, const Vec2& b, const Vec2& c, const Rgba& color);
+	void					AddQuad(const Vec2& bottomLeft, const Vec2& bottomRight, const Vec2& topRight, const Vec2& topLeft, const Rgba& color);
+	void					AddLine(const Vec2& start, const Vec2& end, const Rgba& color);
+	void					AddBox(const Vec2& center, const Vec2& right, const Vec2& up, const Rgba& fillColor, const Rgba& outlineColor);
+	void					AddDisc(const Vec2& center, float radius, float rotationDegrees, const Rgba& fillColor, const Rgba& outlineColor);
+	void					AddCapsule(const Vec2& start, const Vec2& end, float radius, const Rgba& fillColor, const Rgba& outlineColor);
+	//Half circle facing along direction, from one side of the capsule to the other
+	void					AddHalfDisc(const Vec2& center, const Vec2& direction, float radius, const Rgba& fillColor, const Rgba& outlineColor);
+
+public:
+	static constexpr int	DISC_SIDES = 32;			// Must be a multiple of 4 so capsule caps land on the table
+
+	float					m_outlineThickness = 0.3f;
+
+	Rgba					m_staticFillColor = Rgba(0.5f, 0.5f, 0.5f, 0.5f);
+	Rgba					m_staticOutlineColor = Rgba(0.8f, 0.8f, 0.8f, 1.f);
+	Rgba					m_dynamicFillColor = Rgba(0.2f, 0.6f, 1.f, 0.5f);
+	Rgba					m_dynamicOutlineColor = Rgba(0.6f, 0.9f, 1.f, 1.f);
+
+private:
+	std::vector<Vertex_PCU>	m_vertices;
+	int						m_numShapes = 0;
+
+	//Unit circle, DISC_SIDES + 1 entries so the last side can read one past the end
+	Vec2					m_unitCircle[DISC_SIDES + 1];
+};
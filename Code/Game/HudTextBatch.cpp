@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/HudTextBatch.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HudTextBatch::BeginFrame()
+{
+	m_numLinesUsed = 0;
+	m_numLinesRebuilt = 0;
+	m_vertices.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HudTextBatch::AddText(BitmapFont& font, const Vec2& position, float height, const char* text, const Rgba& color)
+{
+	if (m_numLinesUsed == static_cast<int>(m_lines.size()))
+	{
+		m_lines.emplace_back();
+	}
+
+	CachedLine& line = m_lines[m_numLinesUsed];
+	m_numLinesUsed++;
+
+	bool isUnchanged = line.m_position.x == position.x && line.m_position.y == position.y && line.m_height == height && IsSameColor(line.m_color, color) && strcmp(line.m_text.c_str(), text) == 0;
+	if (!isUnchanged || line.m_vertices.empty())
+	{
+		//Assigning reuses the string's memory when the new text is no longer than the old
+		line.m_text = text;
+		line.m_position = position;
+		line.m_height = height;
+		line.m_color = color;
+
+		line.m_vertices.clear();
+		font.AddVertsForText2D(line.m_vertices, position, height, line.m_text, color);
+		m_numLinesRebuilt++;
+	}
+
+	m_vertices.insert(m_vertices.end(), line.m_vertices.begin(), line.m_vertices.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HudTextBatch::Draw(RenderContext& renderContext, BitmapFont& font) const
+{
+	if (m_vertices.empty())
+	{
+		return;
+	}
+
+	renderContext.BindTextureViewWithSampler(0U, font.GetTexture());
+	renderContext.DrawVertexArray(m_vertices);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool HudTextBatch::IsSameColor(const Rgba& a, const Rgba& b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
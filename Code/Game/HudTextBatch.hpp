@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vertex_PCU.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitmapFont;
+class RenderContext;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Text drawn every frame with the same calls in the same order. Each call keeps its glyph vertices from last frame and only
+// asks the font again when its text, position, size or color changed. Nothing allocates once every line has been seen
+//------------------------------------------------------------------------------------------------------------------------------
+class HudTextBatch
+{
+public:
+	void					BeginFrame();
+	void					AddText(BitmapFont& font, const Vec2& position, float height, const char* text, const Rgba& color);
+	void					Draw(RenderContext& renderContext, BitmapFont& font) const;
+
+	inline const std::vector<Vertex_PCU>&	GetVertices() const { return m_vertices; }
+	inline int				GetNumLinesRebuilt() const { return m_numLinesRebuilt; }
+
+private:
+	struct CachedLine
+	{
+		std::string			m_text;
+		Vec2				m_position;
+		float				m_height = 0.f;
+		Rgba				m_color;
+		std::vector<Vertex_PCU>	m_vertices;
+	};
+
+	static bool				IsSameColor(const Rgba& a, const Rgba& b);
+
+private:
+	std::vector<CachedLine>	m_lines;
+	int						m_numLinesUsed = 0;
+	int						m_numLinesRebuilt = 0;
+	std::vector<Vertex_PCU>	m_vertices;
+};
@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/InputRecorder.hpp"
+#include <fstream>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputRecorder::StartRecording(unsigned int sceneSeed)
+{
+	StopPlayback();
+
+	m_inputs.clear();
+	m_sceneSeed = sceneSeed;
+	m_numSteps = 0;
+	m_isRecording = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputRecorder::StopRecording(int numSteps)
+{
+	m_numSteps = numSteps;
+	m_isRecording = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputRecorder::RecordInput(eRecordedInputType type, int step, const Vec2& cursorPosition, unsigned char keyCode, float value)
+{
+	if (!m_isRecording)
+	{
+		return;
+	}
+
+	RecordedInput input;
+	input.m_step = static_cast<uint32_t>(step);
+	input.m_type = type;
+	input.m_keyCode = keyCode;
+	input.m_cursorX = cursorPosition.x;
+	input.m_cursorY = cursorPosition.y;
+	input.m_value = value;
+
+	m_inputs.push_back(input);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputRecorder::StartPlayback()
+{
+	m_isRecording = false;
+	m_isPlaying = true;
+	m_playbackIndex = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputRecorder::StopPlayback()
+{
+	m_isPlaying = false;
+	m_playbackIndex = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool InputRecorder::GetNextInputForStep(int step, RecordedInput& out_input)
+{
+	if (!m_isPlaying || m_playbackIndex >= static_cast<int>(m_inputs.size()))
+	{
+		return false;
+	}
+
+	//Inputs are stored in the order they happened, so anything at or before this step is due
+	if (m_inputs[m_playbackIndex].m_step > static_cast<uint32_t>(step))
+	{
+		return false;
+	}
+
+	out_input = m_inputs[m_playbackIndex];
+	m_playbackIndex++;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool InputRecorder::SaveToFile(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	InputLogHeader header;
+	header.m_sceneSeed = m_sceneSeed;
+	header.m_numSteps = static_cast<uint32_t>(m_numSteps);
+	header.m_numInputs = static_cast<uint32_t>(m_inputs.size());
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!m_inputs.empty())
+	{
+		file.write(reinterpret_cast<const char*>(m_inputs.data()), sizeof(RecordedInput) * m_inputs.size());
+	}
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bytes between the read position and the end, so counts from a header can be checked before anything is sized by them
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t GetBytesRemaining(std::ifstream& file)
+{
+	std::streampos position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streampos end = file.tellg();
+	file.seekg(position);
+	return (end > position) ? static_cast<uint64_t>(end - position) : 0U;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool InputRecorder::LoadFromFile(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	InputLogHeader header;
+	InputLogHeader expected;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || memcmp(header.m_fourCC, expected.m_fourCC, sizeof(header.m_fourCC)) != 0 || header.m_version != expected.m_version)
+	{
+		return false;
+	}
+
+	//A corrupt or truncated file must not size the inputs past what is actually there
+	if (GetBytesRemaining(file) < static_cast<uint64_t>(header.m_numInputs) * sizeof(RecordedInput))
+	{
+		return false;
+	}
+
+	m_inputs.resize(header.m_numInputs);
+	if (header.m_numInputs > 0)
+	{
+		file.read(reinterpret_cast<char*>(m_inputs.data()), sizeof(RecordedInput) * m_inputs.size());
+		if (!file.good())
+		{
+			m_inputs.clear();
+			return false;
+		}
+	}
+
+	m_sceneSeed = header.m_sceneSeed;
+	m_numSteps = static_cast<int>(header.m_numSteps);
+	m_playbackIndex = 0;
+	return true;
+}
@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eRecordedInputType : uint8_t
+{
+	INPUT_KEY_PRESSED = 0,
+	INPUT_KEY_RELEASED,
+	INPUT_MOUSE_LB_DOWN,
+	INPUT_MOUSE_LB_UP,
+	INPUT_MOUSE_RB_DOWN,
+	INPUT_MOUSE_RB_UP,
+	INPUT_MOUSE_SCROLL,
+	INPUT_CURSOR_MOVE,		// Cursor position while an object is grabbed, so drags replay exactly
+
+	NUM_RECORDED_INPUT_TYPES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma pack(push, 1)
+struct RecordedInput
+{
+	uint32_t				m_step = 0;
+	uint8_t					m_type = INPUT_KEY_PRESSED;
+	uint8_t					m_keyCode = 0;
+	float					m_cursorX = 0.f;
+	float					m_cursorY = 0.f;
+	float					m_value = 0.f;
+};
+
+struct InputLogHeader
+{
+	char					m_fourCC[4] = { 'P', 'I', 'N', 'P' };
+	uint32_t				m_version = 1;
+	uint32_t				m_sceneSeed = 0;
+	uint32_t				m_numSteps = 0;
+	uint32_t				m_numInputs = 0;
+};
+#pragma pack(pop)
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Records every input that reaches the game with the simulation step it was applied on, and plays it back.
+// Only meaningful in deterministic mode where steps are fixed and the scene is seeded.
+//------------------------------------------------------------------------------------------------------------------------------
+class InputRecorder
+{
+public:
+	void					StartRecording(unsigned int sceneSeed);
+	void					StopRecording(int numSteps);
+	void					RecordInput(eRecordedInputType type, int step, const Vec2& cursorPosition, unsigned char keyCode = 0, float value = 0.f);
+
+	void					StartPlayback();
+	void					StopPlayback();
+	bool					GetNextInputForStep(int step, RecordedInput& out_input);
+
+	bool					SaveToFile(const std::string& filePath) const;
+	bool					LoadFromFile(const std::string& filePath);
+
+	inline bool				IsRecording() const				{ return m_isRecording; }
+	inline bool				IsPlaying() const				{ return m_isPlaying; }
+	inline unsigned int		GetSceneSeed() const			{ return m_sceneSeed; }
+	inline int				GetNumSteps() const				{ return m_numSteps; }
+	inline int				GetNumInputs() const			{ return static_cast<int>(m_inputs.size()); }
+
+private:
+	std::vector<RecordedInput>	m_inputs;
+	unsigned int				m_sceneSeed = 0U;
+	int							m_numSteps = 0;
+	int							m_playbackIndex = 0;
+	bool						m_isRecording = false;
+	bool						m_isPlaying = false;
+};
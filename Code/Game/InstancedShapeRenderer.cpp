@@ -0,0 +1,342 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/InstancedShapeRenderer.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+//Game Systems
+#include "Game/RenderSnapshot.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeInstanceBuffer::Clear()
+{
+	m_positionX.clear();
+	m_positionY.clear();
+	m_rotationDegrees.clear();
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_colorState.clear();
+	m_cos.clear();
+	m_sin.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeInstanceBuffer::AddInstance(const Vec2& position, float rotationDegrees, const Vec2& scale, eInstanceColorState colorState)
+{
+	m_positionX.push_back(position.x);
+	m_positionY.push_back(position.y);
+	m_rotationDegrees.push_back(rotationDegrees);
+	m_scaleX.push_back(scale.x);
+	m_scaleY.push_back(scale.y);
+	m_colorState.push_back(static_cast<uint8_t>(colorState));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void UnitShapeMesh::AddVertex(const Vec2& unitPosition, const Vec2& outlineOffset, bool isOutline)
+{
+	m_x.push_back(unitPosition.x);
+	m_y.push_back(unitPosition.y);
+	m_offsetX.push_back(outlineOffset.x);
+	m_offsetY.push_back(outlineOffset.y);
+	m_isOutline.push_back(isOutline ? 1 : 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+InstancedShapeRenderer::InstancedShapeRenderer()
+{
+	m_fillColors[INSTANCE_COLOR_STATIC] = Rgba(0.5f, 0.5f, 0.5f, 0.5f);
+	m_outlineColors[INSTANCE_COLOR_STATIC] = Rgba(0.8f, 0.8f, 0.8f, 1.f);
+	m_fillColors[INSTANCE_COLOR_DYNAMIC] = Rgba(0.2f, 0.6f, 1.f, 0.5f);
+	m_outlineColors[INSTANCE_COLOR_DYNAMIC] = Rgba(0.6f, 0.9f, 1.f, 1.f);
+	m_fillColors[INSTANCE_COLOR_TRIGGER] = Rgba(1.f, 0.5f, 0.f, 0.25f);
+	m_outlineColors[INSTANCE_COLOR_TRIGGER] = Rgba::ORANGE;
+
+	BuildUnitMeshes();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::BeginFrame()
+{
+	for (int meshIndex = 0; meshIndex < NUM_INSTANCE_MESHES; meshIndex++)
+	{
+		m_instances[meshIndex].Clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddAllGeometry(const std::vector<Geometry*>& allGeometry)
+{
+	int numGeometry = static_cast<int>(allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		if (allGeometry[index] != nullptr)
+		{
+			AddGeometry(*allGeometry[index]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddGeometry(const Geometry& geometry)
+{
+	if (geometry.m_rigidbody == nullptr)
+	{
+		return;
+	}
+
+	eInstanceColorState colorState = (geometry.m_rigidbody->GetSimulationType() == STATIC_SIMULATION) ? INSTANCE_COLOR_STATIC : INSTANCE_COLOR_DYNAMIC;
+	AddShape(geometry.m_shape, geometry.m_transform.m_position, geometry.m_rigidbody->m_rotation, colorState);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddAllBodies(const std::vector<const RenderBody*>& allBodies)
+{
+	int numBodies = static_cast<int>(allBodies.size());
+	for (int index = 0; index < numBodies; index++)
+	{
+		AddBody(*allBodies[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddBody(const RenderBody& body)
+{
+	eInstanceColorState colorState = (body.m_simulationType == STATIC_SIMULATION) ? INSTANCE_COLOR_STATIC : INSTANCE_COLOR_DYNAMIC;
+	AddShape(body.m_shape, body.m_position, body.m_rotationDegrees, colorState);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddShape(const GeometryShape& shape, const Vec2& position, float rotationDegrees, eInstanceColorState colorState)
+{
+	switch (shape.m_geometryType)
+	{
+	case AABB2_GEOMETRY:
+	{
+		m_instances[INSTANCE_MESH_QUAD].AddInstance(position, 0.f, shape.m_size, colorState);
+	}
+	break;
+	case BOX_GEOMETRY:
+	{
+		m_instances[INSTANCE_MESH_QUAD].AddInstance(position, rotationDegrees, shape.m_size, colorState);
+	}
+	break;
+	case DISC_GEOMETRY:
+	{
+		m_instances[INSTANCE_MESH_DISC].AddInstance(position, rotationDegrees, Vec2(shape.m_radius, shape.m_radius), colorState);
+	}
+	break;
+	case CAPSULE_GEOMETRY:
+	{
+		//Same convention as the batch renderer, the made with axis turned by however far the body has rotated since
+		Vec2 halfAxis = (shape.m_end - shape.m_start) * 0.5f;
+		float halfLength = halfAxis.GetLength();
+		float axisDegrees = atan2f(halfAxis.y, halfAxis.x) * 57.2957795f + rotationDegrees - shape.m_rotationDegrees;
+
+		float radians = axisDegrees * 0.01745329f;
+		Vec2 rotatedHalfAxis = Vec2(cosf(radians), sinf(radians)) * halfLength;
+		Vec2 capScale = Vec2(shape.m_radius, shape.m_radius);
+
+		m_instances[INSTANCE_MESH_CAPSULE_BODY].AddInstance(position, axisDegrees, Vec2(halfLength * 2.f, shape.m_radius * 2.f), colorState);
+		m_instances[INSTANCE_MESH_CAPSULE_CAP].AddInstance(position + rotatedHalfAxis, axisDegrees, capScale, colorState);
+		m_instances[INSTANCE_MESH_CAPSULE_CAP].AddInstance(position - rotatedHalfAxis, axisDegrees + 180.f, capScale, colorState);
+	}
+	break;
+	default:
+	break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::BuildVertices()
+{
+	int numVertices = 0;
+	for (int meshIndex = 0; meshIndex < NUM_INSTANCE_MESHES; meshIndex++)
+	{
+		numVertices += m_instances[meshIndex].GetNumInstances() * m_meshes[meshIndex].GetNumVertices();
+	}
+
+	//Keeps its capacity, only grows when the body count does
+	m_vertices.resize(numVertices);
+
+	int firstVertex = 0;
+	for (int meshIndex = 0; meshIndex < NUM_INSTANCE_MESHES; meshIndex++)
+	{
+		ComputeRotations(m_instances[meshIndex]);
+		ExpandInstances(m_meshes[meshIndex], m_instances[meshIndex], firstVertex);
+		firstVertex += m_instances[meshIndex].GetNumInstances() * m_meshes[meshIndex].GetNumVertices();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::DrawInstances(RenderContext& renderContext) const
+{
+	if (m_vertices.empty())
+	{
+		return;
+	}
+
+	renderContext.BindTextureViewWithSampler(0U, nullptr);
+	renderContext.DrawVertexArray(m_vertices);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedShapeRenderer::GetNumInstances() const
+{
+	int numInstances = 0;
+	for (int meshIndex = 0; meshIndex < NUM_INSTANCE_MESHES; meshIndex++)
+	{
+		numInstances += m_instances[meshIndex].GetNumInstances();
+	}
+	return numInstances;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::BuildUnitMeshes()
+{
+	Vec2 bottomLeft = Vec2(-0.5f, -0.5f);
+	Vec2 bottomRight = Vec2(0.5f, -0.5f);
+	Vec2 topRight = Vec2(0.5f, 0.5f);
+	Vec2 topLeft = Vec2(-0.5f, 0.5f);
+	Vec2 noOffset = Vec2(0.f, 0.f);
+
+	//Quad, unit square with all 4 edges outlined
+	UnitShapeMesh& quad = m_meshes[INSTANCE_MESH_QUAD];
+	UnitShapeMesh& capsuleBody = m_meshes[INSTANCE_MESH_CAPSULE_BODY];
+	UnitShapeMesh* quadMeshes[2] = { &quad, &capsuleBody };
+	for (int index = 0; index < 2; index++)
+	{
+		UnitShapeMesh& mesh = *quadMeshes[index];
+		mesh.AddVertex(bottomLeft, noOffset, false);
+		mesh.AddVertex(bottomRight, noOffset, false);
+		mesh.AddVertex(topRight, noOffset, false);
+		mesh.AddVertex(bottomLeft, noOffset, false);
+		mesh.AddVertex(topRight, noOffset, false);
+		mesh.AddVertex(topLeft, noOffset, false);
+	}
+
+	AddOutlineQuad(quad, bottomLeft, bottomRight, Vec2(0.f, -1.f));
+	AddOutlineQuad(quad, bottomRight, topRight, Vec2(1.f, 0.f));
+	AddOutlineQuad(quad, topRight, topLeft, Vec2(0.f, 1.f));
+	AddOutlineQuad(quad, topLeft, bottomLeft, Vec2(-1.f, 0.f));
+
+	//The caps close off the ends of a capsule
+	AddOutlineQuad(capsuleBody, bottomLeft, bottomRight, Vec2(0.f, -1.f));
+	AddOutlineQuad(capsuleBody, topRight, topLeft, Vec2(0.f, 1.f));
+
+	//Disc of radius 1, with a line out to +x so rotation is visible
+	UnitShapeMesh& disc = m_meshes[INSTANCE_MESH_DISC];
+	UnitShapeMesh& cap = m_meshes[INSTANCE_MESH_CAPSULE_CAP];
+	for (int side = 0; side < DISC_SIDES; side++)
+	{
+		float currentRadians = 6.2831853f * static_cast<float>(side) / static_cast<float>(DISC_SIDES);
+		float nextRadians = 6.2831853f * static_cast<float>(side + 1) / static_cast<float>(DISC_SIDES);
+		Vec2 current = Vec2(cosf(currentRadians), sinf(currentRadians));
+		Vec2 next = Vec2(cosf(nextRadians), sinf(nextRadians));
+
+		//Caps only use the half facing +x
+		bool isOnCap = (side < DISC_SIDES / 4) || (side >= DISC_SIDES * 3 / 4);
+		UnitShapeMesh* meshes[2] = { &disc, isOnCap ? &cap : nullptr };
+		for (int meshIndex = 0; meshIndex < 2; meshIndex++)
+		{
+			if (meshes[meshIndex] == nullptr)
+			{
+				continue;
+			}
+
+			UnitShapeMesh& mesh = *meshes[meshIndex];
+			mesh.AddVertex(noOffset, noOffset, false);
+			mesh.AddVertex(current, noOffset, false);
+			mesh.AddVertex(next, noOffset, false);
+
+			mesh.AddVertex(current, current * -0.5f, true);
+			mesh.AddVertex(current, current * 0.5f, true);
+			mesh.AddVertex(next, next * 0.5f, true);
+			mesh.AddVertex(current, current * -0.5f, true);
+			mesh.AddVertex(next, next * 0.5f, true);
+			mesh.AddVertex(next, next * -0.5f, true);
+		}
+	}
+
+	AddOutlineQuad(disc, noOffset, Vec2(1.f, 0.f), Vec2(0.f, 1.f));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::AddOutlineQuad(UnitShapeMesh& mesh, const Vec2& start, const Vec2& end, const Vec2& outwardNormal)
+{
+	//Offsets are in outline thicknesses, stretched past the ends by half a thickness so corners close up
+	Vec2 direction = (end - start).GetNormalized() * 0.5f;
+	Vec2 normal = outwardNormal * 0.5f;
+
+	Vec2 startInner = direction * -1.f - normal;
+	Vec2 endInner = direction - normal;
+	Vec2 endOuter = direction + normal;
+	Vec2 startOuter = direction * -1.f + normal;
+
+	mesh.AddVertex(start, startInner, true);
+	mesh.AddVertex(end, endInner, true);
+	mesh.AddVertex(end, endOuter, true);
+	mesh.AddVertex(start, startInner, true);
+	mesh.AddVertex(end, endOuter, true);
+	mesh.AddVertex(start, startOuter, true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void InstancedShapeRenderer::ComputeRotations(ShapeInstanceBuffer& instances)
+{
+	int numInstances = instances.GetNumInstances();
+	instances.m_cos.resize(numInstances);
+	instances.m_sin.resize(numInstances);
+
+	const float* rotationDegrees = instances.m_rotationDegrees.data();
+	float* cosines = instances.m_cos.data();
+	float* sines = instances.m_sin.data();
+	for (int index = 0; index < numInstances; index++)
+	{
+		float radians = rotationDegrees[index] * 0.01745329f;
+		cosines[index] = cosf(radians);
+		sines[index] = sinf(radians);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedShapeRenderer::ExpandInstances(const UnitShapeMesh& mesh, const ShapeInstanceBuffer& instances, int firstVertex)
+{
+	int numInstances = instances.GetNumInstances();
+	int numMeshVertices = mesh.GetNumVertices();
+	if (numInstances == 0 || numMeshVertices == 0)
+	{
+		return;
+	}
+
+	const float* unitX = mesh.m_x.data();
+	const float* unitY = mesh.m_y.data();
+	const float* offsetX = mesh.m_offsetX.data();
+	const float* offsetY = mesh.m_offsetY.data();
+	const uint8_t* isOutline = mesh.m_isOutline.data();
+
+	float thickness = m_outlineThickness;
+	Vertex_PCU* vertex = m_vertices.data() + firstVertex;
+	for (int instanceIndex = 0; instanceIndex < numInstances; instanceIndex++)
+	{
+		float positionX = instances.m_positionX[instanceIndex];
+		float positionY = instances.m_positionY[instanceIndex];
+		float scaleX = instances.m_scaleX[instanceIndex];
+		float scaleY = instances.m_scaleY[instanceIndex];
+		float cosAngle = instances.m_cos[instanceIndex];
+		float sinAngle = instances.m_sin[instanceIndex];
+
+		uint8_t colorState = instances.m_colorState[instanceIndex];
+		const Rgba colors[2] = { m_fillColors[colorState], m_outlineColors[colorState] };
+
+		for (int vertexIndex = 0; vertexIndex < numMeshVertices; vertexIndex++)
+		{
+			float localX = unitX[vertexIndex] * scaleX + offsetX[vertexIndex] * thickness;
+			float localY = unitY[vertexIndex] * scaleY + offsetY[vertexIndex] * thickness;
+
+			vertex->position = Vec3(positionX + cosAngle * localX - sinAngle * localY, positionY + sinAngle * localX + cosAngle * localY, 0.f);
+			vertex->color = colors[isOutline[vertexIndex]];
+			vertex->uvTexCoords = Vec2::ZERO;
+			vertex++;
+		}
+	}
+}
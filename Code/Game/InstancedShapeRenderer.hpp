@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vertex_PCU.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+#include "Game/Geometry.hpp"
+#include <stdint.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class RenderContext;
+struct RenderBody;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eInstanceMesh
+{
+	INSTANCE_MESH_QUAD,				// AABB2 and box
+	INSTANCE_MESH_DISC,
+	INSTANCE_MESH_CAPSULE_BODY,		// Quad outlined on the long sides only
+	INSTANCE_MESH_CAPSULE_CAP,		// Half disc facing +x
+
+	NUM_INSTANCE_MESHES
+};
+
+enum eInstanceColorState
+{
+	INSTANCE_COLOR_STATIC,
+	INSTANCE_COLOR_DYNAMIC,
+	INSTANCE_COLOR_TRIGGER,
+
+	NUM_INSTANCE_COLOR_STATES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One entry per body, one array per field
+//------------------------------------------------------------------------------------------------------------------------------
+struct ShapeInstanceBuffer
+{
+	void					Clear();
+	void					AddInstance(const Vec2& position, float rotationDegrees, const Vec2& scale, eInstanceColorState colorState);
+	inline int				GetNumInstances() const { return static_cast<int>(m_positionX.size()); }
+
+	std::vector<float>		m_positionX;
+	std::vector<float>		m_positionY;
+	std::vector<float>		m_rotationDegrees;
+	std::vector<float>		m_scaleX;
+	std::vector<float>		m_scaleY;
+	std::vector<uint8_t>	m_colorState;
+
+	//Filled by ComputeRotations from m_rotationDegrees
+	std::vector<float>		m_cos;
+	std::vector<float>		m_sin;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Unit space mesh. Outline vertices also carry an offset in outline thicknesses, added after scaling so outlines keep their width
+//------------------------------------------------------------------------------------------------------------------------------
+struct UnitShapeMesh
+{
+	void					AddVertex(const Vec2& unitPosition, const Vec2& outlineOffset, bool isOutline);
+	inline int				GetNumVertices() const { return static_cast<int>(m_x.size()); }
+
+	std::vector<float>		m_x;
+	std::vector<float>		m_y;
+	std::vector<float>		m_offsetX;
+	std::vector<float>		m_offsetY;
+	std::vector<uint8_t>	m_isOutline;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Each shape type is tessellated once into a unit mesh and bodies only add an instance record.
+// The engine has no instanced draw, so BuildVertices expands the instances into one vertex array and it is drawn in one call
+//------------------------------------------------------------------------------------------------------------------------------
+class InstancedShapeRenderer
+{
+public:
+	InstancedShapeRenderer();
+
+	//Clears the instances but keeps the memory for the next frame
+	void					BeginFrame();
+
+	void					AddAllGeometry(const std::vector<Geometry*>& allGeometry);
+	void					AddGeometry(const Geometry& geometry);
+	void					AddAllBodies(const std::vector<const RenderBody*>& allBodies);
+	void					AddBody(const RenderBody& body);
+	void					AddShape(const GeometryShape& shape, const Vec2& position, float rotationDegrees, eInstanceColorState colorState);
+
+	//Nothing here touches the renderer so instances and vertices can be checked without a window
+	void					BuildVertices();
+	void					DrawInstances(RenderContext& renderContext) const;
+
+	inline const ShapeInstanceBuffer&	GetInstances(eInstanceMesh mesh) const { return m_instances[mesh]; }
+	inline const UnitShapeMesh&			GetUnitMesh(eInstanceMesh mesh) const { return m_meshes[mesh]; }
+	inline const std::vector<Vertex_PCU>&	GetVertices() const { return m_vertices; }
+	int						GetNumInstances() const;
+
+private:
+	void					BuildUnitMeshes();
+	void					AddOutlineQuad(UnitShapeMesh& mesh, const Vec2& start, const Vec2& end, const Vec2& outwardNormal);
+
+	static void				ComputeRotations(ShapeInstanceBuffer& instances);
+	void					ExpandInstances(const UnitShapeMesh& mesh, const ShapeInstanceBuffer& instances, int firstVertex);
+
+public:
+	static constexpr int	DISC_SIDES = 32;
+
+	float					m_outlineThickness = 0.3f;
+
+	Rgba					m_fillColors[NUM_INSTANCE_COLOR_STATES];
+	Rgba					m_outlineColors[NUM_INSTANCE_COLOR_STATES];
+
+private:
+	UnitShapeMesh			m_meshes[NUM_INSTANCE_MESHES];
+	ShapeInstanceBuffer		m_instances[NUM_INSTANCE_MESHES];
+	std::vector<Vertex_PCU>	m_vertices;
+};
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Fixed size ring that any number of threads push into and one thread pops from, without locks. Each cell carries a
+// sequence number: producers claim a position with one compare exchange and publish the item by bumping the cell's
+// sequence, the consumer only reads cells whose item is published. Full rings refuse pushes instead of growing.
+// An item still being written stops the pop there, the items after it wait for the next pop
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+class MPSCQueue
+{
+public:
+	explicit MPSCQueue(int capacity);		// Rounded up to a power of two
+	~MPSCQueue();
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	//Any thread. Returns false when the ring is full
+	bool					Push(const T& item);
+
+	//Consumer thread only. Returns false when there is nothing published to pop. out_position is the item's place in the
+	//order of all pushes, so the consumer can tell items pushed before some point from those pushed after it
+	bool					Pop(T& out_item, size_t* out_position = nullptr);
+
+	inline int				GetCapacity() const { return static_cast<int>(m_mask + 1); }
+	//Positions claimed so far. Anything already pushed when this is read has a position below it
+	inline size_t			GetNumPushed() const { return m_pushPosition.load(std::memory_order_acquire); }
+	//Consumer thread only
+	inline size_t			GetNumPopped() const { return m_popPosition; }
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t>	m_sequence;
+		T					m_item;
+	};
+
+private:
+	Cell*					m_cells = nullptr;
+	size_t					m_mask = 0;
+
+	//Padded onto their own cache lines so producers and the consumer don't fight over one. Padding rather than alignas
+	//keeps owners like PhysicsWorld at normal alignment for new
+	char					m_padBeforePush[64];
+	std::atomic<size_t>		m_pushPosition;
+	char					m_padBeforePop[64];
+	size_t					m_popPosition = 0;
+	char					m_padAfterPop[64];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+MPSCQueue<T>::MPSCQueue(int capacity)
+{
+	size_t numCells = 2;
+	while (numCells < static_cast<size_t>(capacity))
+	{
+		numCells *= 2;
+	}
+
+	m_cells = new Cell[numCells];
+	m_mask = numCells - 1;
+	for (size_t index = 0; index < numCells; index++)
+	{
+		m_cells[index].m_sequence.store(index, std::memory_order_relaxed);
+	}
+
+	m_pushPosition.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+MPSCQueue<T>::~MPSCQueue()
+{
+	delete[] m_cells;
+	m_cells = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+bool MPSCQueue<T>::Push(const T& item)
+{
+	size_t position = m_pushPosition.load(std::memory_order_relaxed);
+	Cell* cell = nullptr;
+	while (true)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (difference == 0)
+		{
+			//The cell is free for this lap, claim the position. A failed exchange reloads position
+			if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//The consumer has not popped this cell from the last lap yet
+			return false;
+		}
+		else
+		{
+			position = m_pushPosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->m_item = item;
+	cell->m_sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+bool MPSCQueue<T>::Pop(T& out_item, size_t* out_position)
+{
+	Cell& cell = m_cells[m_popPosition & m_mask];
+	size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+	if (sequence != m_popPosition + 1)
+	{
+		return false;
+	}
+
+	out_item = cell.m_item;
+	if (out_position != nullptr)
+	{
+		*out_position = m_popPosition;
+	}
+
+	//Free the cell for the producers' next lap
+	cell.m_sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+	m_popPosition++;
+	return true;
+}
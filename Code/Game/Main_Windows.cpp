@@ -150,7 +150,7 @@ void RunMessagePump()
 }
 
 //-----------------------------------------------------------------------------------------------
-void Startup()
+void Startup( const char* commandLineString )
 {
 	//We create app first and read black board. Then we create window and we get the window data based on black board info to create either full screen/ windowed screen
 	//CreateOpenGLWindow( applicationInstanceHandle, CLIENT_ASPECT );
@@ -159,6 +159,7 @@ void Startup()
 	CreateWindowAndRenderContext( CLIENT_ASPECT );
 	g_theApp = new App();	
 	g_theApp->StartUp();
+	g_theApp->HandleCommandLine( commandLineString );
 }
 
 
@@ -177,9 +178,8 @@ void Shutdown()
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int )
 {
-	UNUSED( commandLineString );
 	UNUSED( applicationInstanceHandle );
-	Startup();
+	Startup( commandLineString );
 
 	// Program main loop; keep running frames until it's time to quit
 	while( !g_theApp->IsQuitting() )
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/MappedFile.hpp"
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		//An empty file can't be mapped
+		Close();
+		return false;
+	}
+
+	m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+
+	m_size = 0;
+}
@@ -0,0 +1,29 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Read only view of a whole file. Pages come straight from the OS file cache so every process mapping the same board shares them
+//------------------------------------------------------------------------------------------------------------------------------
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile& copy) = delete;
+	MappedFile& operator=(const MappedFile& copy) = delete;
+
+	bool					Open(const std::string& filePath);
+	void					Close();
+
+	inline bool				IsOpen() const { return m_data != nullptr; }
+	inline const void*		GetData() const { return m_data; }
+	inline size_t			GetSize() const { return m_size; }
+
+private:
+	void*					m_fileHandle = nullptr;
+	void*					m_mappingHandle = nullptr;
+	const void*				m_data = nullptr;
+	size_t					m_size = 0;
+};
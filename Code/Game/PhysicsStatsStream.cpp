@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysicsStatsStream.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsStatsStream::~PhysicsStatsStream()
+{
+	Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsStatsStream::Open(const std::string& filePath, ePhysicsStatsFormat format)
+{
+	Close();
+
+	m_file.open(filePath, std::ios::out | std::ios::trunc);
+	if (!m_file.is_open())
+	{
+		return false;
+	}
+
+	m_filePath = filePath;
+	m_format = format;
+	m_numRows = 0;
+	m_numPendingRows = 0;
+	m_pendingText.clear();
+	m_queuedText.clear();
+	m_isQuitting = false;
+
+	if (m_format == PHYSICS_STATS_CSV)
+	{
+		m_pendingText = "step,time,bodies,static,dynamic,awake,triggers,broadphasePairs,contacts,triggerEnters,triggerExits,collected,physicsStepMS,garbageMS,broadphaseMS\n";
+	}
+
+	m_isOpen = true;
+	m_thread = std::thread(&PhysicsStatsStream::WriterThreadMain, this);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::Close()
+{
+	if (!m_isOpen)
+	{
+		return;
+	}
+
+	//The writer drains the queue before it quits
+	HandOffPendingText();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	m_file.close();
+	m_isOpen = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::AppendRow(const PhysicsStatsRow& row)
+{
+	if (!m_isOpen)
+	{
+		return;
+	}
+
+	if (m_format == PHYSICS_STATS_CSV)
+	{
+		AppendCsvRow(row);
+	}
+	else
+	{
+		AppendJsonRow(row);
+	}
+
+	m_numRows++;
+	m_numPendingRows++;
+	if (m_numPendingRows >= m_rowsPerFlush)
+	{
+		HandOffPendingText();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ePhysicsStatsFormat PhysicsStatsStream::GetFormatForPath(const std::string& filePath)
+{
+	size_t extensionStart = filePath.rfind('.');
+	if (extensionStart != std::string::npos && filePath.compare(extensionStart, std::string::npos, ".csv") == 0)
+	{
+		return PHYSICS_STATS_CSV;
+	}
+
+	return PHYSICS_STATS_JSON_LINES;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::HandOffPendingText()
+{
+	if (m_pendingText.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queuedText.empty())
+		{
+			//Swapping hands the writer's spent buffer back to us, so steady state streaming doesn't allocate
+			m_queuedText.swap(m_pendingText);
+		}
+		else
+		{
+			//The writer is behind, keep everything in order
+			m_queuedText.append(m_pendingText);
+		}
+	}
+	m_pendingText.clear();
+	m_numPendingRows = 0;
+
+	m_wakeCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::WriterThreadMain()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this]() { return m_isQuitting || !m_queuedText.empty(); });
+
+			if (m_queuedText.empty())
+			{
+				//Quitting and nothing left to write
+				return;
+			}
+
+			m_writingText.swap(m_queuedText);
+		}
+
+		m_file.write(m_writingText.data(), m_writingText.size());
+		m_file.flush();
+		m_writingText.clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::AppendCsvRow(const PhysicsStatsRow& row)
+{
+	char line[512];
+	int length = snprintf(line, sizeof(line), "%d,%.6f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f\n",
+		row.m_step, row.m_timeSeconds, row.m_numBodies, row.m_numStatic, row.m_numDynamic, row.m_numAwake, row.m_numTriggers,
+		row.m_numBroadphasePairs, row.m_numContacts, row.m_numTriggerEnters, row.m_numTriggerExits, row.m_numCollected,
+		row.m_physicsStepMS, row.m_garbageMS, row.m_broadphaseMS);
+
+	if (length > 0)
+	{
+		m_pendingText.append(line, (length < (int)sizeof(line)) ? length : sizeof(line) - 1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStatsStream::AppendJsonRow(const PhysicsStatsRow& row)
+{
+	char line[512];
+	int length = snprintf(line, sizeof(line), "{\"step\":%d,\"time\":%.6f,\"bodies\":%d,\"static\":%d,\"dynamic\":%d,\"awake\":%d,\"triggers\":%d,"
+		"\"broadphasePairs\":%d,\"contacts\":%d,\"triggerEnters\":%d,\"triggerExits\":%d,\"collected\":%d,"
+		"\"physicsStepMS\":%.4f,\"garbageMS\":%.4f,\"broadphaseMS\":%.4f}\n",
+		row.m_step, row.m_timeSeconds, row.m_numBodies, row.m_numStatic, row.m_numDynamic, row.m_numAwake, row.m_numTriggers,
+		row.m_numBroadphasePairs, row.m_numContacts, row.m_numTriggerEnters, row.m_numTriggerExits, row.m_numCollected,
+		row.m_physicsStepMS, row.m_garbageMS, row.m_broadphaseMS);
+
+	if (length > 0)
+	{
+		m_pendingText.append(line, (length < (int)sizeof(line)) ? length : sizeof(line) - 1);
+	}
+}
@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum ePhysicsStatsFormat
+{
+	PHYSICS_STATS_CSV,
+	PHYSICS_STATS_JSON_LINES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Counters for one physics step. Event counts cover everything since the previous row
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysicsStatsRow
+{
+	int						m_step = 0;
+	double					m_timeSeconds = 0.0;
+
+	int						m_numBodies = 0;
+	int						m_numStatic = 0;
+	int						m_numDynamic = 0;
+	int						m_numAwake = 0;					// Dynamic bodies still moving, the engine has no sleep state
+	int						m_numTriggers = 0;
+	int						m_numBroadphasePairs = 0;		// Pairs of bodies whose bounds overlap
+	int						m_numContacts = 0;				// Collision events raised by the engine's narrowphase
+	int						m_numTriggerEnters = 0;
+	int						m_numTriggerExits = 0;
+	int						m_numCollected = 0;				// Bodies removed by garbage collection
+
+	float					m_physicsStepMS = 0.f;
+	float					m_garbageMS = 0.f;
+	float					m_broadphaseMS = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Appends one line per physics step to a CSV or JSON lines file. Rows are formatted into a buffer on the game thread and
+// handed to a writer thread every few rows, so the step never waits on the disk. Close writes whatever is left
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsStatsStream
+{
+public:
+	~PhysicsStatsStream();
+
+	bool					Open(const std::string& filePath, ePhysicsStatsFormat format);
+	void					Close();
+	void					AppendRow(const PhysicsStatsRow& row);
+
+	inline bool				IsOpen() const { return m_isOpen; }
+	inline int				GetNumRows() const { return m_numRows; }
+	inline const std::string&	GetFilePath() const { return m_filePath; }
+
+	//.csv is CSV, anything else is JSON lines
+	static ePhysicsStatsFormat	GetFormatForPath(const std::string& filePath);
+
+public:
+	int						m_rowsPerFlush = 60;
+
+private:
+	void					HandOffPendingText();
+	void					WriterThreadMain();
+	void					AppendCsvRow(const PhysicsStatsRow& row);
+	void					AppendJsonRow(const PhysicsStatsRow& row);
+
+private:
+	bool					m_isOpen = false;
+	ePhysicsStatsFormat		m_format = PHYSICS_STATS_CSV;
+	std::string				m_filePath;
+	std::ofstream			m_file;							// Only the writer thread touches it while open
+	int						m_numRows = 0;
+	int						m_numPendingRows = 0;
+
+	std::string				m_pendingText;					// Game thread only
+	std::string				m_queuedText;					// Guarded by m_mutex
+	std::string				m_writingText;					// Writer thread only
+
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wakeCondition;
+	bool					m_isQuitting = false;
+};
@@ -0,0 +1,644 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysicsWorld.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Collider2D.hpp"
+#include "Engine/Math/PhysicsSystem.hpp"
+#include "Engine/Math/RigidBodyBucket.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/StateHashLog.hpp"
+#include "Game/StaticBoard.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include <new>
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsWorld::PhysicsWorld(PhysicsSystem& physicsSystem)
+	: m_physicsSystem(physicsSystem)
+	, m_queuedCommands(PHYSICS_COMMAND_QUEUE_CAPACITY)
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsWorld::PhysicsWorld(const Vec2& gravity, unsigned int seed)
+	: m_ownedPhysicsSystem(new PhysicsSystem())
+	, m_physicsSystem(*m_ownedPhysicsSystem)
+	, m_rng(seed)
+	, m_queuedCommands(PHYSICS_COMMAND_QUEUE_CAPACITY)
+{
+	m_physicsSystem.SetGravity(gravity);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsWorld::~PhysicsWorld()
+{
+	DetachStaticBoard();
+
+	//Bodies created by commands nobody collected still belong to the world
+	for (size_t index = 0; index < m_createdGeometry.size(); index++)
+	{
+		delete m_createdGeometry[index];
+	}
+	m_createdGeometry.clear();
+
+	delete m_ownedPhysicsSystem;
+	m_ownedPhysicsSystem = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::Step(float deltaTime)
+{
+	BeginStep();
+	ApplyCommands();
+	m_physicsSystem.Update(deltaTime);
+	m_numSteps++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueCommand(const PhysicsCommand& command)
+{
+	return m_queuedCommands.Push(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueSetTransform(uint32_t bodyID, const Vec2& position)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_SET_TRANSFORM;
+	command.m_bodyID = bodyID;
+	command.m_position = position;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueSetVelocity(uint32_t bodyID, const Vec2& velocity)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_SET_VELOCITY;
+	command.m_bodyID = bodyID;
+	command.m_velocity = velocity;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueSetSimulationType(uint32_t bodyID, eSimulationType simulationType)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_SET_SIMULATION_TYPE;
+	command.m_bodyID = bodyID;
+	command.m_simulationType = simulationType;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueSetMaterial(uint32_t bodyID, float mass, float friction, float restitution, float linearDrag, float angularDrag)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_SET_MATERIAL;
+	command.m_bodyID = bodyID;
+	command.m_mass = mass;
+	command.m_friction = friction;
+	command.m_restitution = restitution;
+	command.m_linearDrag = linearDrag;
+	command.m_angularDrag = angularDrag;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueSetConstraints(uint32_t bodyID, bool xFreedom, bool yFreedom, bool rotationFreedom)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_SET_CONSTRAINTS;
+	command.m_bodyID = bodyID;
+	command.m_xFreedom = xFreedom;
+	command.m_yFreedom = yFreedom;
+	command.m_rotationFreedom = rotationFreedom;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueDestroyBody(uint32_t bodyID)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_DESTROY_BODY;
+	command.m_bodyID = bodyID;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueBeginHold(uint32_t bodyID)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_BEGIN_HOLD;
+	command.m_bodyID = bodyID;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::QueueEndHold(uint32_t bodyID)
+{
+	PhysicsCommand command;
+	command.m_type = PHYSICS_COMMAND_END_HOLD;
+	command.m_bodyID = bodyID;
+	return QueueCommand(command);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint32_t PhysicsWorld::QueueCreateBody(const PhysicsCommand& createCommand)
+{
+	PhysicsCommand command = createCommand;
+	command.m_type = PHYSICS_COMMAND_CREATE_BODY;
+	command.m_bodyID = Geometry::ReserveID();
+	if (!QueueCommand(command))
+	{
+		return 0;
+	}
+
+	return command.m_bodyID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::TakeCreatedGeometry(std::vector<Geometry*>& out_geometry)
+{
+	out_geometry.insert(out_geometry.end(), m_createdGeometry.begin(), m_createdGeometry.end());
+	m_createdGeometry.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::DiscardCommands()
+{
+	PhysicsCommand command;
+	while (m_queuedCommands.Pop(command))
+	{
+	}
+
+	m_cancelledBefore.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::CancelCommands(uint32_t bodyID)
+{
+	size_t cancelPosition = m_queuedCommands.GetNumPushed();
+	if (cancelPosition == m_queuedCommands.GetNumPopped())
+	{
+		return;
+	}
+
+	m_cancelledBefore[bodyID] = cancelPosition;
+	m_lastCancelPosition = cancelPosition;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::RegisterGeometry(Geometry* geometry)
+{
+	m_geometryByID[geometry->m_id] = geometry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::UnregisterGeometry(const Geometry* geometry)
+{
+	//A restored id may have been taken over by another body, only remove our own entry
+	std::unordered_map<uint32_t, Geometry*>::iterator entry = m_geometryByID.find(geometry->m_id);
+	if (entry != m_geometryByID.end() && entry->second == geometry)
+	{
+		m_geometryByID.erase(entry);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Geometry* PhysicsWorld::FindGeometry(uint32_t bodyID) const
+{
+	std::unordered_map<uint32_t, Geometry*>::const_iterator entry = m_geometryByID.find(bodyID);
+	if (entry == m_geometryByID.end())
+	{
+		return nullptr;
+	}
+
+	return entry->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::ApplyCommands()
+{
+	PROFILE_SCOPE("Apply Physics Commands");
+
+	//Commands run in the order they were queued, so a grab and a release in one frame still end up released. Stop
+	//after one queue's worth so producers pushing as fast as we pop can't hold the step here
+	int numToApply = m_queuedCommands.GetCapacity();
+	PhysicsCommand command;
+	size_t position = 0;
+	for (int index = 0; index < numToApply; index++)
+	{
+		if (!m_queuedCommands.Pop(command, &position))
+		{
+			break;
+		}
+
+		if (!m_cancelledBefore.empty())
+		{
+			std::unordered_map<uint32_t, size_t>::const_iterator cancelled = m_cancelledBefore.find(command.m_bodyID);
+			if (cancelled != m_cancelledBefore.end() && position < cancelled->second)
+			{
+				continue;
+			}
+		}
+
+		ApplyCommand(command);
+	}
+
+	//Every cancelled command has gone by
+	if (!m_cancelledBefore.empty() && m_queuedCommands.GetNumPopped() >= m_lastCancelPosition)
+	{
+		m_cancelledBefore.clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::ApplyCommand(const PhysicsCommand& command)
+{
+	if (command.m_type == PHYSICS_COMMAND_CREATE_BODY)
+	{
+		CreateBody(command);
+		return;
+	}
+
+	Geometry* geometry = FindGeometry(command.m_bodyID);
+	if (geometry == nullptr || geometry->m_rigidbody == nullptr)
+	{
+		return;
+	}
+
+	Rigidbody2D& rigidbody = *geometry->m_rigidbody;
+	switch (command.m_type)
+	{
+	case PHYSICS_COMMAND_DESTROY_BODY:
+	//Marked dead here, the game's garbage collection removes it after the step
+	geometry->ReleaseRigidbody();
+	break;
+	case PHYSICS_COMMAND_SET_TRANSFORM:
+	geometry->m_transform.m_position = command.m_position;
+	break;
+	case PHYSICS_COMMAND_SET_VELOCITY:
+	rigidbody.m_velocity = command.m_velocity;
+	break;
+	case PHYSICS_COMMAND_SET_SIMULATION_TYPE:
+	geometry->SetSimulationType(command.m_simulationType);
+	break;
+	case PHYSICS_COMMAND_SET_MATERIAL:
+	{
+		rigidbody.m_mass = command.m_mass;
+		rigidbody.m_friction = command.m_friction;
+		rigidbody.m_material.restitution = command.m_restitution;
+		rigidbody.m_linearDrag = command.m_linearDrag;
+		rigidbody.m_angularDrag = command.m_angularDrag;
+	}
+	break;
+	case PHYSICS_COMMAND_SET_CONSTRAINTS:
+	rigidbody.SetConstraints(command.m_xFreedom, command.m_yFreedom, command.m_rotationFreedom);
+	break;
+	case PHYSICS_COMMAND_BEGIN_HOLD:
+	geometry->BeginHold();
+	break;
+	case PHYSICS_COMMAND_END_HOLD:
+	geometry->EndHold();
+	break;
+	default:
+	break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::CreateBody(const PhysicsCommand& command)
+{
+	if (command.m_geometryType <= TYPE_UNKNOWN || command.m_geometryType >= NUM_GEOMETRY_TYPES)
+	{
+		return;
+	}
+
+	Geometry* geometry = new Geometry(*this, command.m_simulationType, command.m_geometryType, command.m_position, command.m_rotationDegrees, command.m_length, command.m_endPosition);
+	geometry->SetID(command.m_bodyID);
+
+	Rigidbody2D& rigidbody = *geometry->m_rigidbody;
+	rigidbody.m_mass = command.m_mass;
+	rigidbody.m_friction = command.m_friction;
+	rigidbody.m_material.restitution = command.m_restitution;
+	rigidbody.m_linearDrag = command.m_linearDrag;
+	rigidbody.m_angularDrag = command.m_angularDrag;
+	geometry->m_collider->SetMomentForObject();
+
+	if (command.m_collisionEvent != nullptr)
+	{
+		geometry->m_collider->SetCollisionEvent(command.m_collisionEvent);
+	}
+
+	m_createdGeometry.push_back(geometry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::ReserveRigidbodies(eSimulationType simulationType, int numAdditional)
+{
+	if (numAdditional <= 0)
+	{
+		return;
+	}
+
+	std::vector<Rigidbody2D*>& bucket = m_physicsSystem.m_rbBucket->m_RbBucket[simulationType];
+	bucket.reserve(bucket.size() + numAdditional);
+	m_geometryByID.reserve(m_geometryByID.size() + numAdditional);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Geometry* PhysicsWorld::CreateGeometry(const GeometrySnapshotRecord& record)
+{
+	eSimulationType simType = static_cast<eSimulationType>(record.m_simulationType);
+	Geometry* geometry = new Geometry(*this, simType, record.GetShape());
+	record.ApplyToGeometry(*geometry);
+	return geometry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::CreateGeometryBatch(const GeometrySnapshotRecord* records, int numRecords, std::vector<Geometry*>& out_geometry)
+{
+	int numStatic = 0;
+	for (int index = 0; index < numRecords; index++)
+	{
+		if (records[index].m_simulationType == STATIC_SIMULATION)
+		{
+			numStatic++;
+		}
+	}
+
+	ReserveRigidbodies(STATIC_SIMULATION, numStatic);
+	ReserveRigidbodies(DYNAMIC_SIMULATION, numRecords - numStatic);
+	out_geometry.reserve(out_geometry.size() + numRecords);
+
+	for (int index = 0; index < numRecords; index++)
+	{
+		out_geometry.push_back(CreateGeometry(records[index]));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::CreateDynamicGeometryBatch(const GeometrySnapshotRecord* records, int numRecords, std::vector<Geometry*>& out_geometry)
+{
+	int numDynamic = 0;
+	for (int index = 0; index < numRecords; index++)
+	{
+		if (records[index].m_simulationType != STATIC_SIMULATION)
+		{
+			numDynamic++;
+		}
+	}
+
+	ReserveRigidbodies(DYNAMIC_SIMULATION, numDynamic);
+	out_geometry.reserve(out_geometry.size() + numDynamic);
+
+	for (int index = 0; index < numRecords; index++)
+	{
+		if (records[index].m_simulationType != STATIC_SIMULATION)
+		{
+			out_geometry.push_back(CreateGeometry(records[index]));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::AttachStaticBoard(const std::shared_ptr<const StaticBoard>& board)
+{
+	if (board == m_staticBoard && IsBoardIntact())
+	{
+		return false;
+	}
+
+	PROFILE_SCOPE("Attach Static Board");
+
+	DetachStaticBoard();
+	m_staticBoard = board;
+	if (m_staticBoard == nullptr)
+	{
+		return false;
+	}
+
+	const GeometrySnapshotRecord* records = m_staticBoard->GetRecords();
+	int numRecords = m_staticBoard->GetNumBodies();
+	ReserveRigidbodies(STATIC_SIMULATION, numRecords);
+	if (numRecords == 0)
+	{
+		return true;
+	}
+
+	//Built in place, the bodies register their own address with the world and the physics system
+	m_boardGeometry = static_cast<Geometry*>(::operator new(sizeof(Geometry) * numRecords));
+	for (int index = 0; index < numRecords; index++)
+	{
+		Geometry* geometry = new (&m_boardGeometry[index]) Geometry(*this, STATIC_SIMULATION, records[index].GetShape());
+		geometry->m_isBoardGeometry = true;
+		records[index].ApplyToGeometry(*geometry);
+		m_numBoardGeometry++;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::DetachStaticBoard()
+{
+	//The physics system purges the released bodies, clearing the block then frees the geometry
+	for (int index = 0; index < m_numBoardGeometry; index++)
+	{
+		Geometry& geometry = m_boardGeometry[index];
+		if (geometry.m_rigidbody != nullptr)
+		{
+			geometry.ReleaseRigidbody();
+			geometry.m_collider = nullptr;
+			geometry.m_rigidbody = nullptr;
+		}
+		geometry.~Geometry();
+	}
+
+	::operator delete(m_boardGeometry);
+	m_boardGeometry = nullptr;
+	m_numBoardGeometry = 0;
+	m_staticBoard = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::IsBoardIntact() const
+{
+	if (m_staticBoard == nullptr)
+	{
+		return false;
+	}
+
+	const GeometrySnapshotRecord* records = m_staticBoard->GetRecords();
+	if (m_staticBoard->GetNumBodies() != m_numBoardGeometry)
+	{
+		return false;
+	}
+
+	//Only what the editor can change is checked, static bodies are never moved by the simulation
+	for (int index = 0; index < m_numBoardGeometry; index++)
+	{
+		const Geometry& geometry = m_boardGeometry[index];
+		const GeometrySnapshotRecord& record = records[index];
+		if (geometry.m_rigidbody == nullptr || !geometry.m_rigidbody->m_isAlive || geometry.m_rigidbody->GetSimulationType() != STATIC_SIMULATION)
+		{
+			return false;
+		}
+
+		if (geometry.m_transform.m_position.x != record.m_position.x || geometry.m_transform.m_position.y != record.m_position.y
+			|| geometry.m_transform.m_rotation != record.m_rotation || geometry.m_rigidbody->m_rotation != record.m_bodyRotation)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsWorld::IsBoardGeometry(const Geometry* geometry) const
+{
+	return geometry != nullptr && geometry->m_isBoardGeometry && geometry->GetWorld() == this;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::GetBoardGeometry(std::vector<Geometry*>& out_geometry)
+{
+	out_geometry.reserve(out_geometry.size() + m_numBoardGeometry);
+	for (int index = 0; index < m_numBoardGeometry; index++)
+	{
+		if (m_boardGeometry[index].m_rigidbody != nullptr)
+		{
+			out_geometry.push_back(&m_boardGeometry[index]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnBodyAdded(eSimulationType simulationType, eGeometryType geometryType)
+{
+	m_stats.m_numBodies++;
+	AdjustSimulationCount(simulationType, 1);
+	if (geometryType >= 0 && geometryType < NUM_GEOMETRY_TYPES)
+	{
+		m_stats.m_numByShape[geometryType]++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnBodyRemoved(eSimulationType simulationType, eGeometryType geometryType)
+{
+	m_stats.m_numBodies--;
+	AdjustSimulationCount(simulationType, -1);
+	if (geometryType >= 0 && geometryType < NUM_GEOMETRY_TYPES)
+	{
+		m_stats.m_numByShape[geometryType]--;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnSimulationTypeChanged(eSimulationType oldType, eSimulationType newType)
+{
+	if (oldType == newType)
+	{
+		return;
+	}
+
+	AdjustSimulationCount(oldType, -1);
+	AdjustSimulationCount(newType, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnTriggerAdded()
+{
+	m_stats.m_numTriggers++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnTriggerEnter()
+{
+	m_stats.m_numTriggerOverlaps++;
+	m_stats.m_numTriggerEntersTotal++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnTriggerExit()
+{
+	m_stats.m_numTriggerExitsTotal++;
+
+	//Bodies already inside when a trigger was added only ever report the exit
+	if (m_stats.m_numTriggerOverlaps > 0)
+	{
+		m_stats.m_numTriggerOverlaps--;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnContactEvent()
+{
+	m_stats.m_numContactEvents++;
+	m_stats.m_numContactEventsTotal++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::OnBodiesCollected(int numBodies)
+{
+	m_stats.m_numCollectedTotal += numBodies;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::BeginStep()
+{
+	m_stats.m_numContactEvents = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorld::AdjustSimulationCount(eSimulationType simulationType, int delta)
+{
+	switch (simulationType)
+	{
+	case STATIC_SIMULATION:
+	m_stats.m_numStatic += delta;
+	break;
+	case DYNAMIC_SIMULATION:
+	m_stats.m_numDynamic += delta;
+	break;
+	default:
+	break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t PhysicsWorld::ComputeStateHash(const std::vector<Geometry*>& allGeometry, int step)
+{
+	StateHasher hasher;
+	hasher.AddInt(step);
+
+	int numGeometry = static_cast<int>(allGeometry.size());
+	hasher.AddInt(numGeometry);
+
+	for (int index = 0; index < numGeometry; index++)
+	{
+		const Geometry* geometry = allGeometry[index];
+		if (geometry == nullptr || geometry->m_rigidbody == nullptr)
+		{
+			hasher.AddInt(-1);
+			continue;
+		}
+
+		hasher.AddInt(geometry->m_geometryType);
+		hasher.AddFloat(geometry->m_transform.m_position.x);
+		hasher.AddFloat(geometry->m_transform.m_position.y);
+		hasher.AddFloat(geometry->m_transform.m_rotation);
+		hasher.AddFloat(geometry->m_rigidbody->m_rotation);
+		hasher.AddFloat(geometry->m_rigidbody->m_velocity.x);
+		hasher.AddFloat(geometry->m_rigidbody->m_velocity.y);
+		hasher.AddFloat(geometry->m_rigidbody->m_angularVelocity);
+	}
+
+	return hasher.GetHash();
+}
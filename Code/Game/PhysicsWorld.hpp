@@ -0,0 +1,190 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Rigidbody2D.hpp"
+#include "Game/DeterministicRNG.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/MPSCQueue.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsSystem;
+class StaticBoard;
+struct GeometrySnapshotRecord;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Running totals kept up to date as bodies come and go, so reading them never walks the buckets
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysicsStats
+{
+	int						m_numBodies = 0;
+	int						m_numStatic = 0;
+	int						m_numDynamic = 0;
+	int						m_numByShape[NUM_GEOMETRY_TYPES] = {};
+	int						m_numTriggers = 0;
+	int						m_numTriggerOverlaps = 0;			// Bodies currently inside any trigger
+	int						m_numContactEvents = 0;				// Collision events raised by the last step
+	int						m_numContactEventsTotal = 0;
+	int						m_numTriggerEntersTotal = 0;
+	int						m_numTriggerExitsTotal = 0;
+	int						m_numCollectedTotal = 0;			// Bodies removed by garbage collection
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum ePhysicsCommandType
+{
+	PHYSICS_COMMAND_CREATE_BODY,
+	PHYSICS_COMMAND_DESTROY_BODY,
+	PHYSICS_COMMAND_SET_TRANSFORM,
+	PHYSICS_COMMAND_SET_VELOCITY,
+	PHYSICS_COMMAND_SET_SIMULATION_TYPE,
+	PHYSICS_COMMAND_SET_MATERIAL,
+	PHYSICS_COMMAND_SET_CONSTRAINTS,
+	PHYSICS_COMMAND_BEGIN_HOLD,
+	PHYSICS_COMMAND_END_HOLD,
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// An edit to one body held until the start of the next step. Only the fields for the command's type are read.
+// Bodies are named by Geometry::m_id so a producer never holds a pointer the step may free
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysicsCommand
+{
+	ePhysicsCommandType		m_type = PHYSICS_COMMAND_SET_TRANSFORM;
+	uint32_t				m_bodyID = 0;
+
+	Vec2					m_position = Vec2::ZERO;
+	Vec2					m_velocity = Vec2::ZERO;
+	eSimulationType			m_simulationType = STATIC_SIMULATION;
+
+	//Create body, passed to the Geometry constructor. The collision event must outlive the command, use a literal
+	eGeometryType			m_geometryType = TYPE_UNKNOWN;
+	float					m_rotationDegrees = 0.f;
+	float					m_length = 0.f;
+	Vec2					m_endPosition = Vec2::ZERO;
+	const char*				m_collisionEvent = nullptr;
+
+	float					m_mass = 1.f;
+	float					m_friction = 0.f;
+	float					m_restitution = 0.f;
+	float					m_linearDrag = 0.f;
+	float					m_angularDrag = 0.f;
+
+	bool					m_xFreedom = true;
+	bool					m_yFreedom = true;
+	bool					m_rotationFreedom = true;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Game side front for one engine PhysicsSystem. Geometry is created against a world and draws its random sizes from the
+// world's RNG and reports to the world's stats, so any number of worlds can live side by side. The game's world wraps the
+// engine's global system, standalone worlds own theirs. Destroy a world's geometry before the world
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsWorld
+{
+public:
+	explicit PhysicsWorld(PhysicsSystem& physicsSystem);
+	explicit PhysicsWorld(const Vec2& gravity, unsigned int seed = 0U);
+	~PhysicsWorld();
+
+	PhysicsWorld(const PhysicsWorld&) = delete;
+	PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+	//Applies the queued commands, then steps the physics system
+	void					Step(float deltaTime);
+	inline int				GetNumSteps() const { return m_numSteps; }
+
+	//Edits to bodies wait for the start of the next step. Any thread may queue, even while the world is stepping, and
+	//no lock is taken. Each returns false when the queue is full and the command was dropped. Commands for a body that
+	//no longer exists are skipped
+	bool					QueueCommand(const PhysicsCommand& command);
+	bool					QueueSetTransform(uint32_t bodyID, const Vec2& position);
+	bool					QueueSetVelocity(uint32_t bodyID, const Vec2& velocity);
+	bool					QueueSetSimulationType(uint32_t bodyID, eSimulationType simulationType);
+	bool					QueueSetMaterial(uint32_t bodyID, float mass, float friction, float restitution, float linearDrag, float angularDrag);
+	bool					QueueSetConstraints(uint32_t bodyID, bool xFreedom, bool yFreedom, bool rotationFreedom);
+	bool					QueueDestroyBody(uint32_t bodyID);
+	//Held bodies are static until released, then get back the type they had when the hold was applied
+	bool					QueueBeginHold(uint32_t bodyID);
+	bool					QueueEndHold(uint32_t bodyID);
+
+	//Reserves the new body's id now so later commands can name it. Returns 0 when the queue is full. Bodies created by
+	//a step are collected with TakeCreatedGeometry
+	uint32_t				QueueCreateBody(const PhysicsCommand& createCommand);
+
+	//The rest are consumer side: call them from the stepping thread, or from the game thread while the simulation thread
+	//is idle (input and console handlers run at the frame's sync point, so they qualify)
+
+	//Hands over the bodies created since the last call
+	void					TakeCreatedGeometry(std::vector<Geometry*>& out_geometry);
+	//Drops everything queued, for when the scene is replaced
+	void					DiscardCommands();
+	//Skips every command for the body that was queued before this call. Later ones still apply
+	void					CancelCommands(uint32_t bodyID);
+
+	//Id to body lookup for the commands. Geometry registers itself, stepping thread only
+	void					RegisterGeometry(Geometry* geometry);
+	void					UnregisterGeometry(const Geometry* geometry);
+	Geometry*				FindGeometry(uint32_t bodyID) const;
+
+	//Grow the rigidbody bucket once so a large load doesn't reallocate it per body
+	void					ReserveRigidbodies(eSimulationType simulationType, int numAdditional);
+
+	Geometry*				CreateGeometry(const GeometrySnapshotRecord& record);
+	void					CreateGeometryBatch(const GeometrySnapshotRecord* records, int numRecords, std::vector<Geometry*>& out_geometry);
+	//Skips the static records, for scenes that get their static bodies from a board
+	void					CreateDynamicGeometryBatch(const GeometrySnapshotRecord* records, int numRecords, std::vector<Geometry*>& out_geometry);
+
+	//Gives the world a body for every shape on the board. Attaching the board that is already attached keeps its bodies,
+	//unless one was moved, destroyed or made dynamic. Returns true if the bodies were created
+	bool					AttachStaticBoard(const std::shared_ptr<const StaticBoard>& board);
+	void					DetachStaticBoard();
+	bool					IsBoardIntact() const;
+	bool					IsBoardGeometry(const Geometry* geometry) const;
+	void					GetBoardGeometry(std::vector<Geometry*>& out_geometry);
+	inline const std::shared_ptr<const StaticBoard>&	GetStaticBoard() const { return m_staticBoard; }
+
+	inline PhysicsSystem&	GetPhysicsSystem() const { return m_physicsSystem; }
+	inline DeterministicRNG&	GetRNG() { return m_rng; }
+
+	//Hash of every body's shape type, position, rotation and velocities, for comparing runs and worlds
+	static uint64_t			ComputeStateHash(const std::vector<Geometry*>& allGeometry, int step);
+
+	//Stat bookkeeping. Geometry reports its own body, Game reports triggers and physics events
+	void					OnBodyAdded(eSimulationType simulationType, eGeometryType geometryType);
+	void					OnBodyRemoved(eSimulationType simulationType, eGeometryType geometryType);
+	void					OnSimulationTypeChanged(eSimulationType oldType, eSimulationType newType);
+	void					OnTriggerAdded();
+	void					OnTriggerEnter();
+	void					OnTriggerExit();
+	void					OnContactEvent();
+	void					OnBodiesCollected(int numBodies);
+	void					BeginStep();
+
+	inline const PhysicsStats&	GetStats() const { return m_stats; }
+
+private:
+	void					AdjustSimulationCount(eSimulationType simulationType, int delta);
+	void					ApplyCommands();
+	void					ApplyCommand(const PhysicsCommand& command);
+	void					CreateBody(const PhysicsCommand& command);
+
+private:
+	PhysicsSystem*			m_ownedPhysicsSystem = nullptr;		// Declared before m_physicsSystem, which may point at it
+	PhysicsSystem&			m_physicsSystem;
+	DeterministicRNG		m_rng;
+	PhysicsStats			m_stats;
+	int						m_numSteps = 0;
+	MPSCQueue<PhysicsCommand>	m_queuedCommands;
+	std::unordered_map<uint32_t, Geometry*>	m_geometryByID;
+	std::unordered_map<uint32_t, size_t>	m_cancelledBefore;		// Body id to the queue position its commands are skipped below
+	size_t					m_lastCancelPosition = 0;
+	std::vector<Geometry*>	m_createdGeometry;			// Made by commands, waiting for TakeCreatedGeometry
+
+	//Bodies for the attached board are built in place in one block sized once. Pointers into it are handed out, so it is
+	//never grown or moved, only freed whole by DetachStaticBoard
+	std::shared_ptr<const StaticBoard>	m_staticBoard;
+	Geometry*				m_boardGeometry = nullptr;
+	int						m_numBoardGeometry = 0;
+};
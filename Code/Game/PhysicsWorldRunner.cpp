@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysicsWorldRunner.hpp"
+//Game Systems
+#include "Game/AllocationTracker.hpp"
+#include "Game/FloatingPointMode.hpp"
+#include "Game/FrameProfiler.hpp"
+#include "Game/PhysicsWorld.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsWorldRunner::PhysicsWorldRunner(int numThreads)
+{
+	m_nextWorldIndex = 0;
+
+	if (numThreads <= 0)
+	{
+		numThreads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+
+	//The calling thread is one of them
+	for (int threadIndex = 1; threadIndex < numThreads; threadIndex++)
+	{
+		m_threads.emplace_back(&PhysicsWorldRunner::WorkerThreadMain, this);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsWorldRunner::~PhysicsWorldRunner()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t threadIndex = 0; threadIndex < m_threads.size(); threadIndex++)
+	{
+		m_threads[threadIndex].join();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorldRunner::StepAll(const std::vector<PhysicsWorld*>& worlds, float deltaTime, int numSteps)
+{
+	if (worlds.empty() || numSteps <= 0)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_worlds = worlds.data();
+		m_numWorlds = static_cast<int>(worlds.size());
+		m_deltaTime = deltaTime;
+		m_numSteps = numSteps;
+		m_nextWorldIndex = 0;
+		m_numWorkersBusy = static_cast<int>(m_threads.size());
+		m_jobIndex++;
+	}
+	m_wakeCondition.notify_all();
+
+	StepWorlds();
+
+	//Workers that found nothing left still check in, so the job can't change under one still reading it
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return m_numWorkersBusy == 0; });
+	m_worlds = nullptr;
+	m_numWorlds = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorldRunner::WorkerThreadMain()
+{
+	unsigned int lastJobIndex = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this, lastJobIndex]() { return m_isQuitting || m_jobIndex != lastJobIndex; });
+
+			if (m_isQuitting)
+			{
+				return;
+			}
+
+			lastJobIndex = m_jobIndex;
+		}
+
+		StepWorlds();
+
+		bool isLastWorker = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numWorkersBusy--;
+			isLastWorker = (m_numWorkersBusy == 0);
+		}
+
+		if (isLastWorker)
+		{
+			m_doneCondition.notify_one();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsWorldRunner::StepWorlds()
+{
+	ALLOCATION_TAG_SCOPE(ALLOC_TAG_PHYSICS);
+
+	//Workers step in the same FP mode as the calling thread, or world hashes depend on which thread ran them
+	FloatingPointMode::Apply();
+
+	while (true)
+	{
+		int worldIndex = m_nextWorldIndex.fetch_add(1);
+		if (worldIndex >= m_numWorlds)
+		{
+			return;
+		}
+
+		PROFILE_SCOPE("World Steps");
+		PhysicsWorld& world = *m_worlds[worldIndex];
+		for (int stepIndex = 0; stepIndex < m_numSteps; stepIndex++)
+		{
+			world.Step(m_deltaTime);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsWorld;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Steps many independent PhysicsWorlds on a pool of threads that lives as long as the runner. Each world is stepped by
+// one thread at a time, threads take the next unstepped world until none are left, and the calling thread helps.
+// Worlds stepped here must not use collision or trigger event names, the engine fires those through the global event system
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsWorldRunner
+{
+public:
+	explicit PhysicsWorldRunner(int numThreads = 0);		// 0 uses every hardware thread
+	~PhysicsWorldRunner();
+
+	PhysicsWorldRunner(const PhysicsWorldRunner&) = delete;
+	PhysicsWorldRunner& operator=(const PhysicsWorldRunner&) = delete;
+
+	//Runs numSteps steps of deltaTime on every world and returns once all of them are done
+	void					StepAll(const std::vector<PhysicsWorld*>& worlds, float deltaTime, int numSteps);
+
+	inline int				GetNumThreads() const { return static_cast<int>(m_threads.size()) + 1; }
+
+private:
+	void					WorkerThreadMain();
+	void					StepWorlds();
+
+private:
+	std::vector<std::thread>	m_threads;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wakeCondition;
+	std::condition_variable	m_doneCondition;
+	bool					m_isQuitting = false;
+	unsigned int			m_jobIndex = 0;				// Bumped for every StepAll so workers know there is new work
+	int						m_numWorkersBusy = 0;
+
+	//The current job, only written while no worker is busy
+	PhysicsWorld* const*	m_worlds = nullptr;
+	int						m_numWorlds = 0;
+	float					m_deltaTime = 0.f;
+	int						m_numSteps = 0;
+	std::atomic<int>		m_nextWorldIndex;
+};
@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/RenderSnapshot.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderBody::SetFromGeometry(const Geometry& geometry)
+{
+	Rigidbody2D& rigidbody = *geometry.m_rigidbody;
+
+	m_shape = geometry.m_shape;
+	m_position = geometry.m_transform.m_position;
+	m_rotationDegrees = rigidbody.m_rotation;
+	m_simulationType = rigidbody.GetSimulationType();
+	m_bounds = geometry.GetWorldBounds();
+	m_numCorePoints = geometry.GetWorldCore(m_corePoints, m_coreRadius);
+
+	m_mass = rigidbody.m_mass;
+	m_velocity = rigidbody.m_velocity;
+	m_angularVelocity = rigidbody.m_angularVelocity;
+	m_friction = rigidbody.m_friction;
+	m_restitution = rigidbody.m_material.restitution;
+	m_linearDrag = rigidbody.m_linearDrag;
+	m_angularDrag = rigidbody.m_angularDrag;
+	m_momentOfInertia = rigidbody.m_momentOfInertia;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool RenderBody::Contains(const Vec2& point) const
+{
+	if (m_numCorePoints <= 0)
+	{
+		return false;
+	}
+
+	//Polygon cores wind counter clockwise, so the point is inside when it is left of every edge
+	bool isInside = (m_numCorePoints > 2);
+	float closestDistanceSquared = 3.402823466e+38f;
+	int numEdges = (m_numCorePoints > 2) ? m_numCorePoints : 1;
+	for (int edgeIndex = 0; edgeIndex < numEdges; edgeIndex++)
+	{
+		const Vec2& start = m_corePoints[edgeIndex];
+		const Vec2& end = m_corePoints[(m_numCorePoints > 2) ? (edgeIndex + 1) % m_numCorePoints : m_numCorePoints - 1];
+
+		Vec2 edge = end - start;
+		float lengthSquared = edge.x * edge.x + edge.y * edge.y;
+		float fraction = 0.f;
+		if (lengthSquared > 0.f)
+		{
+			fraction = ((point.x - start.x) * edge.x + (point.y - start.y) * edge.y) / lengthSquared;
+			fraction = (fraction < 0.f) ? 0.f : ((fraction > 1.f) ? 1.f : fraction);
+		}
+
+		Vec2 offset = point - (start + edge * fraction);
+		closestDistanceSquared = fminf(closestDistanceSquared, offset.x * offset.x + offset.y * offset.y);
+
+		float cross = edge.x * (point.y - start.y) - edge.y * (point.x - start.x);
+		isInside = isInside && (cross >= 0.f);
+	}
+
+	return isInside || closestDistanceSquared <= m_coreRadius * m_coreRadius;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderSnapshot::Capture(const std::vector<Geometry*>& allGeometry)
+{
+	PROFILE_SCOPE("Capture Render Snapshot");
+
+	m_bodies.clear();
+	m_bodies.reserve(allGeometry.size());
+	m_bodyBounds.clear();
+	m_bodyBounds.reserve(allGeometry.size());
+
+	int numGeometry = static_cast<int>(allGeometry.size());
+	for (int index = 0; index < numGeometry; index++)
+	{
+		const Geometry* geometry = allGeometry[index];
+		if (geometry == nullptr || geometry->m_rigidbody == nullptr)
+		{
+			continue;
+		}
+
+		m_bodies.emplace_back();
+		m_bodies.back().SetFromGeometry(*geometry);
+		m_bodyBounds.push_back(m_bodies.back().m_bounds);
+	}
+
+	m_grid.Rebuild(m_bodyBounds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderSnapshot::QueryAABB(const AABB2& bounds, std::vector<const RenderBody*>& out_bodies) const
+{
+	m_queryIndices.clear();
+	m_grid.QueryAABB(bounds, m_queryIndices);
+	for (int index : m_queryIndices)
+	{
+		out_bodies.push_back(&m_bodies[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderSnapshot::QueryPoint(const Vec2& point, std::vector<const RenderBody*>& out_bodies) const
+{
+	//The grid only looks in the cell under the point and tests bounds, the shape test is done here
+	m_queryIndices.clear();
+	m_grid.QueryPoint(point, m_queryIndices);
+	for (int index : m_queryIndices)
+	{
+		const RenderBody& body = m_bodies[index];
+		if (body.Contains(point))
+		{
+			out_bodies.push_back(&body);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderSnapshot::GetAllBodies(std::vector<const RenderBody*>& out_bodies) const
+{
+	out_bodies.reserve(out_bodies.size() + m_bodies.size());
+	for (size_t index = 0; index < m_bodies.size(); index++)
+	{
+		out_bodies.push_back(&m_bodies[index]);
+	}
+}
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Game/BroadphaseGrid.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/PhysicsWorld.hpp"
+#include "Game/ShapeCast.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One body as it was at the end of a step. Holds everything drawing and the hover info read, so neither touches the body
+//------------------------------------------------------------------------------------------------------------------------------
+struct RenderBody
+{
+	GeometryShape			m_shape;
+	Vec2					m_position = Vec2::ZERO;
+	float					m_rotationDegrees = 0.f;
+	eSimulationType			m_simulationType = STATIC_SIMULATION;
+	AABB2					m_bounds;
+
+	//World core for point tests, see Geometry::GetWorldCore
+	Vec2					m_corePoints[GEOMETRY_MAX_CORE_POINTS];
+	int						m_numCorePoints = 0;
+	float					m_coreRadius = 0.f;
+
+	float					m_mass = 0.f;
+	Vec2					m_velocity = Vec2::ZERO;
+	float					m_angularVelocity = 0.f;
+	float					m_friction = 0.f;
+	float					m_restitution = 0.f;
+	float					m_linearDrag = 0.f;
+	float					m_angularDrag = 0.f;
+	float					m_momentOfInertia = 0.f;
+
+	void					SetFromGeometry(const Geometry& geometry);
+	bool					Contains(const Vec2& point) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Read only copy of the world the simulation thread fills at the end of its job. The game keeps two, rendering reads one
+// while the simulation writes the other, and they swap once the job is waited on. Copies rather than pointers, so a body
+// destroyed after the capture can still be drawn for the frame. The capture builds its own grid over the copies, so culling
+// and hover cost what they do against the live broadphase
+//------------------------------------------------------------------------------------------------------------------------------
+class RenderSnapshot
+{
+public:
+	//Keeps the memory from the last capture
+	void					Capture(const std::vector<Geometry*>& allGeometry);
+
+	//Bodies whose bounds overlap, and bodies whose shape holds the point. Reader thread only, they share a scratch list
+	void					QueryAABB(const AABB2& bounds, std::vector<const RenderBody*>& out_bodies) const;
+	void					QueryPoint(const Vec2& point, std::vector<const RenderBody*>& out_bodies) const;
+	void					GetAllBodies(std::vector<const RenderBody*>& out_bodies) const;
+
+	inline int				GetNumBodies() const { return static_cast<int>(m_bodies.size()); }
+
+public:
+	std::vector<RenderBody>	m_bodies;
+	std::vector<AABB2>		m_bodyBounds;				// Same order as m_bodies, what the grid is built from
+	BroadphaseGrid			m_grid;
+	PhysicsStats			m_stats;
+
+	//Copied from the game for the HUD and the cast preview
+	std::vector<ShapeCast>	m_previewCasts;
+	std::vector<CastHit>	m_previewHits;
+	int						m_numRewindFrames = 0;
+	int						m_scrubFrame = -1;
+
+private:
+	mutable std::vector<int>	m_queryIndices;
+};
@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/RewindTimeline.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr int REWIND_KEYFRAME_INTERVAL = 30;
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::Reset(const AABB2& worldBounds, int capacityFrames)
+{
+	Clear();
+
+	//Finer than the history defaults, a restored board should look exactly like it did
+	QuantizationSettings settings;
+	settings.m_positionError = 0.0005f;
+	settings.m_rotationErrorDegrees = 0.005f;
+	settings.m_velocityError = 0.0005f;
+	settings.m_angularVelocityError = 0.005f;
+
+	m_stream.Reset(worldBounds, settings, REWIND_KEYFRAME_INTERVAL);
+	m_capacityFrames = capacityFrames;
+	m_isActive = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::Clear()
+{
+	m_stream.Clear();
+	m_archive.clear();
+	m_highestArchivedID = 0;
+	m_nextFrameNumber = 0;
+	m_branchFrame = -1;
+	m_isActive = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::RecordFrame(const std::vector<BodyStateRecord>& bodies)
+{
+	if (m_branchFrame >= 0)
+	{
+		m_stream.TruncateAfter(m_branchFrame);
+		m_nextFrameNumber = m_stream.GetFrameStep(m_branchFrame) + 1;
+		m_branchFrame = -1;
+	}
+
+	m_stream.AppendFrame(bodies, m_nextFrameNumber);
+	m_nextFrameNumber++;
+
+	//Bounded: once a whole keyframe block is past capacity drop it from the front
+	if (m_stream.GetNumFrames() >= m_capacityFrames + REWIND_KEYFRAME_INTERVAL)
+	{
+		m_stream.DiscardFramesBefore(m_stream.GetNumFrames() - m_capacityFrames);
+		PruneArchive();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::ArchiveBody(const GeometrySnapshotRecord& record)
+{
+	ArchivedBody& archived = m_archive[record.m_id];
+	archived.m_record = record;
+	archived.m_destroyedFrame = -1;
+
+	if (record.m_id > m_highestArchivedID)
+	{
+		m_highestArchivedID = record.m_id;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::NoteDestroyed(uint32_t id)
+{
+	auto found = m_archive.find(id);
+	if (found != m_archive.end())
+	{
+		found->second.m_destroyedFrame = m_nextFrameNumber;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const GeometrySnapshotRecord* RewindTimeline::FindArchivedBody(uint32_t id) const
+{
+	auto found = m_archive.find(id);
+	if (found == m_archive.end())
+	{
+		return nullptr;
+	}
+	return &found->second.m_record;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool RewindTimeline::DecodeFrame(int frameIndex, std::vector<BodyStateRecord>& out_bodies) const
+{
+	return m_stream.DecodeFrame(frameIndex, out_bodies);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::BranchFrom(int frameIndex)
+{
+	m_branchFrame = frameIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RewindTimeline::PruneArchive()
+{
+	//Anything destroyed before the oldest frame can never be restored again
+	int oldestFrame = m_stream.GetFrameStep(0);
+	for (auto archiveIterator = m_archive.begin(); archiveIterator != m_archive.end(); )
+	{
+		int destroyedFrame = archiveIterator->second.m_destroyedFrame;
+		if (destroyedFrame >= 0 && destroyedFrame <= oldestFrame)
+		{
+			archiveIterator = m_archive.erase(archiveIterator);
+		}
+		else
+		{
+			++archiveIterator;
+		}
+	}
+}
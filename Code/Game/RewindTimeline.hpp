@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Game/SnapshotStream.hpp"
+#include <unordered_map>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The last few seconds of dynamic body state, one compressed frame per step.
+// Bodies that die inside the window keep their full record so scrubbing back can bring them back
+//------------------------------------------------------------------------------------------------------------------------------
+class RewindTimeline
+{
+public:
+	void					Reset(const AABB2& worldBounds, int capacityFrames);
+	void					Clear();
+
+	//Call once per step after the physics update. Bodies must be sorted by id
+	void					RecordFrame(const std::vector<BodyStateRecord>& bodies);
+	void					ArchiveBody(const GeometrySnapshotRecord& record);
+	void					NoteDestroyed(uint32_t id);
+
+	//Ids above this have never been archived
+	inline uint32_t			GetHighestArchivedID() const { return m_highestArchivedID; }
+	const GeometrySnapshotRecord*	FindArchivedBody(uint32_t id) const;
+
+	bool					DecodeFrame(int frameIndex, std::vector<BodyStateRecord>& out_bodies) const;
+	//Recording picks up from this frame next time, anything after it is dropped
+	void					BranchFrom(int frameIndex);
+
+	inline bool				IsActive() const { return m_isActive; }
+	inline int				GetNumFrames() const { return m_stream.GetNumFrames(); }
+	inline size_t			GetNumBytes() const { return m_stream.GetNumBytes(); }
+
+private:
+	struct ArchivedBody
+	{
+		GeometrySnapshotRecord	m_record;
+		int					m_destroyedFrame = -1;
+	};
+
+	void					PruneArchive();
+
+private:
+	SnapshotStream			m_stream;
+	bool					m_isActive = false;
+	int						m_capacityFrames = 600;
+	int						m_nextFrameNumber = 0;
+	int						m_branchFrame = -1;
+
+	std::unordered_map<uint32_t, ArchivedBody>	m_archive;
+	uint32_t				m_highestArchivedID = 0;
+};
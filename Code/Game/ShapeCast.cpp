@@ -0,0 +1,343 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ShapeCast.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include "Game/Geometry.hpp"
+#include <math.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Every shape here is a convex polygon of up to 4 points grown by a radius. Sweeping one against another is a ray against
+// their Minkowski difference, which is the hull of the point differences grown by both radii
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr int MAX_HULL_POINTS = GEOMETRY_MAX_CORE_POINTS * 2;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float Cross2D(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float Dot2D(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Counter clockwise hull with collinear and repeated points dropped. Sorts the points in place
+//------------------------------------------------------------------------------------------------------------------------------
+static int BuildConvexHull(Vec2* points, int numPoints, Vec2* out_hull)
+{
+	//Insertion sort, there are never more than 8 points
+	for (int index = 1; index < numPoints; index++)
+	{
+		Vec2 point = points[index];
+		int insertIndex = index - 1;
+		while (insertIndex >= 0 && (points[insertIndex].x > point.x || (points[insertIndex].x == point.x && points[insertIndex].y > point.y)))
+		{
+			points[insertIndex + 1] = points[insertIndex];
+			insertIndex--;
+		}
+		points[insertIndex + 1] = point;
+	}
+
+	//Monotone chain, lower hull then upper hull
+	int numHull = 0;
+	for (int index = 0; index < numPoints; index++)
+	{
+		while (numHull >= 2 && Cross2D(out_hull[numHull - 1] - out_hull[numHull - 2], points[index] - out_hull[numHull - 2]) <= 0.f)
+		{
+			numHull--;
+		}
+		out_hull[numHull++] = points[index];
+	}
+
+	int lowerSize = numHull + 1;
+	for (int index = numPoints - 2; index >= 0; index--)
+	{
+		while (numHull >= lowerSize && Cross2D(out_hull[numHull - 1] - out_hull[numHull - 2], points[index] - out_hull[numHull - 2]) <= 0.f)
+		{
+			numHull--;
+		}
+		out_hull[numHull++] = points[index];
+	}
+
+	//The last point repeats the first
+	numHull--;
+	if (numHull == 2 && out_hull[0].x == out_hull[1].x && out_hull[0].y == out_hull[1].y)
+	{
+		numHull = 1;
+	}
+	return (numHull < 1) ? 1 : numHull;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float GetDistanceSquaredToSegment(const Vec2& point, const Vec2& start, const Vec2& end)
+{
+	Vec2 segment = end - start;
+	float lengthSq = Dot2D(segment, segment);
+	float fraction = (lengthSq > 0.f) ? Dot2D(point - start, segment) / lengthSq : 0.f;
+	fraction = (fraction < 0.f) ? 0.f : ((fraction > 1.f) ? 1.f : fraction);
+
+	Vec2 displacement = point - (start + segment * fraction);
+	return Dot2D(displacement, displacement);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool IsPointInsideRoundedHull(const Vec2& point, const Vec2* hull, int numHull, float radius)
+{
+	if (numHull >= 3)
+	{
+		bool isInside = true;
+		for (int index = 0; index < numHull && isInside; index++)
+		{
+			const Vec2& edgeStart = hull[index];
+			const Vec2& edgeEnd = hull[(index + 1) % numHull];
+			isInside = Cross2D(edgeEnd - edgeStart, point - edgeStart) >= 0.f;
+		}
+
+		if (isInside)
+		{
+			return true;
+		}
+	}
+
+	float radiusSq = radius * radius;
+	for (int index = 0; index < numHull; index++)
+	{
+		const Vec2& edgeStart = hull[index];
+		const Vec2& edgeEnd = hull[(index + 1) % numHull];
+		if (GetDistanceSquaredToSegment(point, edgeStart, edgeEnd) <= radiusSq)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Ray that starts outside against a segment grown by a radius. Only keeps hits closer than inout_distance
+//------------------------------------------------------------------------------------------------------------------------------
+static bool RaycastRoundedSegment(const Vec2& start, const Vec2& direction, const Vec2& segmentStart, const Vec2& segmentEnd, float radius, float& inout_distance, Vec2& out_normal)
+{
+	bool didHit = false;
+
+	//The two flat sides
+	Vec2 segment = segmentEnd - segmentStart;
+	float length = sqrtf(Dot2D(segment, segment));
+	if (length > 0.f)
+	{
+		Vec2 axis = segment * (1.f / length);
+		for (int side = -1; side <= 1; side += 2)
+		{
+			Vec2 sideNormal = Vec2(-axis.y, axis.x) * static_cast<float>(side);
+			float approachSpeed = -Dot2D(direction, sideNormal);
+			float gap = Dot2D(start - segmentStart, sideNormal) - radius;
+			if (approachSpeed <= 0.f || gap < 0.f)
+			{
+				continue;
+			}
+
+			float distance = gap / approachSpeed;
+			float alongSegment = Dot2D(start + direction * distance - segmentStart, axis);
+			if (distance < inout_distance && alongSegment >= 0.f && alongSegment <= length)
+			{
+				inout_distance = distance;
+				out_normal = sideNormal;
+				didHit = true;
+			}
+		}
+	}
+
+	//The round ends
+	if (radius > 0.f)
+	{
+		const Vec2 ends[2] = { segmentStart, segmentEnd };
+		for (int endIndex = 0; endIndex < 2; endIndex++)
+		{
+			Vec2 toStart = start - ends[endIndex];
+			float projection = Dot2D(toStart, direction);
+			float excess = Dot2D(toStart, toStart) - radius * radius;
+			float discriminant = projection * projection - excess;
+			if (projection > 0.f || discriminant < 0.f)
+			{
+				continue;
+			}
+
+			float distance = -projection - sqrtf(discriminant);
+			if (distance >= 0.f && distance < inout_distance)
+			{
+				inout_distance = distance;
+				out_normal = (start + direction * distance - ends[endIndex]) * (1.f / radius);
+				didHit = true;
+			}
+		}
+	}
+
+	return didHit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ShapeCast ShapeCast::MakeRay(const Vec2& start, const Vec2& direction, float maxDistance)
+{
+	ShapeCast cast;
+	cast.m_start = start;
+	cast.m_direction = direction;
+	cast.m_maxDistance = maxDistance;
+	return cast;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ShapeCast ShapeCast::MakeDisc(const Vec2& start, float radius, const Vec2& direction, float maxDistance)
+{
+	ShapeCast cast = MakeRay(start, direction, maxDistance);
+	cast.m_radius = radius;
+	return cast;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ShapeCast ShapeCast::MakeCapsule(const Vec2& capsuleStart, const Vec2& capsuleEnd, float radius, const Vec2& direction, float maxDistance)
+{
+	ShapeCast cast = MakeDisc((capsuleStart + capsuleEnd) * 0.5f, radius, direction, maxDistance);
+	cast.m_halfAxis = (capsuleEnd - capsuleStart) * 0.5f;
+	return cast;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float ShapeCast::GetReach() const
+{
+	return sqrtf(Dot2D(m_halfAxis, m_halfAxis)) + m_radius;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ShapeCast::CastAgainstGeometry(Geometry& geometry, float maxDistance, CastHit& out_hit) const
+{
+	Vec2 corePoints[GEOMETRY_MAX_CORE_POINTS];
+	float coreRadius = 0.f;
+	int numCorePoints = geometry.GetWorldCore(corePoints, coreRadius);
+	if (numCorePoints == 0)
+	{
+		return false;
+	}
+
+	//Minkowski difference of the body and the cast shape, relative to where the cast shape's center can be
+	bool isCapsule = (m_halfAxis.x != 0.f || m_halfAxis.y != 0.f);
+	Vec2 differencePoints[MAX_HULL_POINTS];
+	int numDifferencePoints = 0;
+	for (int index = 0; index < numCorePoints; index++)
+	{
+		if (isCapsule)
+		{
+			differencePoints[numDifferencePoints++] = corePoints[index] - m_halfAxis;
+			differencePoints[numDifferencePoints++] = corePoints[index] + m_halfAxis;
+		}
+		else
+		{
+			differencePoints[numDifferencePoints++] = corePoints[index];
+		}
+	}
+
+	Vec2 hull[MAX_HULL_POINTS + 1];
+	int numHull = BuildConvexHull(differencePoints, numDifferencePoints, hull);
+	float radius = coreRadius + m_radius;
+
+	float distance = maxDistance;
+	Vec2 normal = Vec2(-m_direction.x, -m_direction.y);
+	if (IsPointInsideRoundedHull(m_start, hull, numHull, radius))
+	{
+		distance = 0.f;
+	}
+	else
+	{
+		bool didHit = false;
+		int numEdges = (numHull <= 2) ? 1 : numHull;
+		for (int index = 0; index < numEdges; index++)
+		{
+			const Vec2& edgeStart = hull[index];
+			const Vec2& edgeEnd = hull[(index + 1) % numHull];
+			didHit |= RaycastRoundedSegment(m_start, m_direction, edgeStart, edgeEnd, radius, distance, normal);
+		}
+
+		if (!didHit)
+		{
+			return false;
+		}
+	}
+
+	out_hit.m_geometry = &geometry;
+	out_hit.m_distance = distance;
+	out_hit.m_position = m_start + m_direction * distance;
+	out_hit.m_normal = normal;
+
+	//The part of the cast shape furthest along -normal is what touched
+	Vec2 contactOffset = Vec2::ZERO;
+	float axisAlongNormal = Dot2D(m_halfAxis, normal);
+	if (axisAlongNormal > 0.0001f)
+	{
+		contactOffset = Vec2(-m_halfAxis.x, -m_halfAxis.y);
+	}
+	else if (axisAlongNormal < -0.0001f)
+	{
+		contactOffset = m_halfAxis;
+	}
+	out_hit.m_point = out_hit.m_position + contactOffset - normal * m_radius;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCastBatch::CastAll(const BroadphaseGrid& grid, const std::vector<ShapeCast>& casts, std::vector<CastHit>& out_hits)
+{
+	int numCasts = static_cast<int>(casts.size());
+	out_hits.resize(numCasts);
+
+	int maxThreads = m_maxThreads;
+	if (maxThreads <= 0)
+	{
+		maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+
+	int minCastsPerThread = (m_minCastsPerThread > 0) ? m_minCastsPerThread : 1;
+	int numThreads = numCasts / minCastsPerThread;
+	numThreads = (numThreads > maxThreads) ? maxThreads : numThreads;
+	numThreads = (numThreads < 1) ? 1 : numThreads;
+	m_numThreadsUsed = numThreads;
+
+	if (static_cast<int>(m_scratch.size()) < numThreads)
+	{
+		m_scratch.resize(numThreads);
+	}
+
+	const ShapeCast* castData = casts.data();
+	CastHit* hitData = out_hits.data();
+	BroadphaseCastScratch* scratchData = m_scratch.data();
+	auto castRange = [&grid, castData, hitData, scratchData](int threadIndex, int startIndex, int endIndex)
+	{
+		PROFILE_SCOPE("Cast Batch");
+		for (int castIndex = startIndex; castIndex < endIndex; castIndex++)
+		{
+			hitData[castIndex] = CastHit();
+			grid.CastShape(castData[castIndex], scratchData[threadIndex], hitData[castIndex]);
+		}
+	};
+
+	//The calling thread takes the first share instead of waiting
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads - 1);
+	for (int threadIndex = 1; threadIndex < numThreads; threadIndex++)
+	{
+		int startIndex = numCasts * threadIndex / numThreads;
+		int endIndex = numCasts * (threadIndex + 1) / numThreads;
+		workers.emplace_back(castRange, threadIndex, startIndex, endIndex);
+	}
+
+	castRange(0, 0, numCasts / numThreads);
+
+	for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+	{
+		workers[workerIndex].join();
+	}
+}
@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BroadphaseGrid.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct CastHit
+{
+	Geometry*				m_geometry = nullptr;
+	float					m_distance = 0.f;			// How far the cast moved before touching
+	Vec2					m_position = Vec2::ZERO;	// Center of the cast shape when it touched
+	Vec2					m_point = Vec2::ZERO;		// Contact point on the surface that was hit
+	Vec2					m_normal = Vec2::ZERO;		// Surface normal at the contact, facing the cast
+
+	inline bool				DidHit() const { return m_geometry != nullptr; }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A ray, disc or capsule swept along a direction. Rays are discs of radius 0 and discs are capsules with no axis,
+// so one cast handles all three against every geometry type. A cast that starts overlapping a body hits it at distance 0
+//------------------------------------------------------------------------------------------------------------------------------
+struct ShapeCast
+{
+	Vec2					m_start = Vec2::ZERO;
+	Vec2					m_direction = Vec2(1.f, 0.f);	// Unit length
+	float					m_maxDistance = 0.f;
+	float					m_radius = 0.f;
+	Vec2					m_halfAxis = Vec2::ZERO;		// Capsule runs from m_start - m_halfAxis to m_start + m_halfAxis
+
+	static ShapeCast		MakeRay(const Vec2& start, const Vec2& direction, float maxDistance);
+	static ShapeCast		MakeDisc(const Vec2& start, float radius, const Vec2& direction, float maxDistance);
+	static ShapeCast		MakeCapsule(const Vec2& capsuleStart, const Vec2& capsuleEnd, float radius, const Vec2& direction, float maxDistance);
+
+	//Distance from m_start to the furthest point of the cast shape
+	float					GetReach() const;
+
+	//Tests one body, only reporting a hit closer than maxDistance
+	bool					CastAgainstGeometry(Geometry& geometry, float maxDistance, CastHit& out_hit) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Runs many casts against the broadphase at once. Large batches are split across worker threads for the length of the
+// call, each with its own scratch, so nothing is shared while they run and the grid must not change until it returns
+//------------------------------------------------------------------------------------------------------------------------------
+class ShapeCastBatch
+{
+public:
+	void					CastAll(const BroadphaseGrid& grid, const std::vector<ShapeCast>& casts, std::vector<CastHit>& out_hits);
+
+	inline int				GetNumThreadsUsed() const { return m_numThreadsUsed; }
+
+public:
+	int						m_maxThreads = 0;			// 0 uses every hardware thread
+	int						m_minCastsPerThread = 256;	// Small batches aren't worth starting threads for
+
+private:
+	std::vector<BroadphaseCastScratch>	m_scratch;
+	int						m_numThreadsUsed = 0;
+};
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/SimulationThread.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+//Game Systems
+#include "Game/FloatingPointMode.hpp"
+#include "Game/FrameProfiler.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+SimulationThread::SimulationThread(SimulationJobCallback callback)
+	: m_callback(callback)
+{
+	m_thread = std::thread(&SimulationThread::SimulationThreadMain, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SimulationThread::~SimulationThread()
+{
+	//A running job finishes first, the thread only checks for quitting between jobs
+	WaitForJob();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	PrintQueuedMessages();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SimulationThread::StartJob(float deltaTime)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_deltaTime = deltaTime;
+		m_hasJob = true;
+	}
+	m_wakeCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SimulationThread::WaitForJob()
+{
+	PROFILE_SCOPE("Wait For Simulation");
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return !m_hasJob; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SimulationThread::IsCurrentThread() const
+{
+	return std::this_thread::get_id() == m_thread.get_id();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SimulationThread::QueueMessage(const Rgba& color, const std::string& message)
+{
+	m_queuedMessages.emplace_back();
+	m_queuedMessages.back().m_color = color;
+	m_queuedMessages.back().m_message = message;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SimulationThread::PrintQueuedMessages()
+{
+	for (size_t index = 0; index < m_queuedMessages.size(); index++)
+	{
+		g_devConsole->PrintString(m_queuedMessages[index].m_color, m_queuedMessages[index].m_message);
+	}
+	m_queuedMessages.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SimulationThread::SimulationThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_wakeCondition.wait(lock, [this]() { return m_hasJob || m_isQuitting; });
+		if (!m_hasJob)
+		{
+			return;
+		}
+
+		float deltaTime = m_deltaTime;
+		lock.unlock();
+
+		{
+			PROFILE_SCOPE("Simulation Job");
+			FloatingPointMode::Apply();
+			m_callback(deltaTime);
+		}
+
+		lock.lock();
+		m_hasJob = false;
+		m_doneCondition.notify_all();
+	}
+}
@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Renderer/Rgba.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void (*SimulationJobCallback)(float deltaTime);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Runs the game's simulation on its own thread, one job per frame. The game thread starts the job once input is handled
+// and waits for it after rendering, so a frame costs the longer of the two instead of both. Nothing else touches the
+// world while a job runs, rendering reads the copy the last job left behind
+//------------------------------------------------------------------------------------------------------------------------------
+class SimulationThread
+{
+public:
+	explicit SimulationThread(SimulationJobCallback callback);
+	~SimulationThread();
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	void					StartJob(float deltaTime);
+	//Returns at once if no job is running
+	void					WaitForJob();
+
+	bool					IsCurrentThread() const;
+
+	//The dev console is drawn while jobs run, so messages from a job wait here. Only call from the job
+	void					QueueMessage(const Rgba& color, const std::string& message);
+	//Call on the game thread after WaitForJob
+	void					PrintQueuedMessages();
+
+private:
+	struct QueuedMessage
+	{
+		Rgba				m_color;
+		std::string			m_message;
+	};
+
+	void					SimulationThreadMain();
+
+private:
+	SimulationJobCallback	m_callback = nullptr;
+
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wakeCondition;
+	std::condition_variable	m_doneCondition;
+	bool					m_isQuitting = false;
+	bool					m_hasJob = false;
+	float					m_deltaTime = 0.f;
+
+	//Written by the job, read once it has been waited on
+	std::vector<QueuedMessage>	m_queuedMessages;
+};
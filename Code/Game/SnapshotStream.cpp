@@ -0,0 +1,584 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/SnapshotStream.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t SNAPSHOT_STREAM_VERSION = 1;
+
+//Quantized values are held inside this so the delta between any two of them still fits an int32
+constexpr float MAX_QUANTIZED_MAGNITUDE = 1.0e9f;
+
+struct SnapshotStreamHeader
+{
+	char					m_fourCC[4] = { 'P', 'S', 'T', 'R' };
+	uint32_t				m_version = SNAPSHOT_STREAM_VERSION;
+	uint32_t				m_numFrames = 0;
+	uint32_t				m_numBytes = 0;
+	int32_t					m_keyframeInterval = 0;
+	Vec2					m_worldMin = Vec2::ZERO;
+	Vec2					m_worldMax = Vec2::ZERO;
+	QuantizationSettings	m_settings;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static int32_t QuantizeValue(float value, float maxError)
+{
+	//Rounding to a grid of 2 * error keeps every value within error of where it started. Values too far out for the
+	//error are clamped, converting them to int32 as they are is undefined
+	float scaled = floorf(value / (2.f * maxError) + 0.5f);
+	if (scaled != scaled)
+	{
+		return 0;
+	}
+
+	scaled = std::max(-MAX_QUANTIZED_MAGNITUDE, std::min(scaled, MAX_QUANTIZED_MAGNITUDE));
+	return static_cast<int32_t>(scaled);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float DequantizeValue(int32_t value, float maxError)
+{
+	return static_cast<float>(value) * 2.f * maxError;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::Reset(const AABB2& worldBounds, const QuantizationSettings& settings, int keyframeInterval)
+{
+	Clear();
+
+	m_worldBounds = worldBounds;
+	m_settings = settings;
+	m_keyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::Clear()
+{
+	m_data.clear();
+	m_frames.clear();
+	m_previousFrame.clear();
+	m_currentFrame.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::AppendFrame(const std::vector<BodyStateRecord>& bodies, int simulationStep)
+{
+	bool isKeyframe = (m_frames.size() % m_keyframeInterval) == 0;
+	if (isKeyframe)
+	{
+		m_previousFrame.clear();
+	}
+
+	int numBodies = static_cast<int>(bodies.size());
+	m_currentFrame.resize(numBodies);
+	for (int index = 0; index < numBodies; index++)
+	{
+		Quantize(bodies[index], m_currentFrame[index]);
+	}
+
+	m_scratch.clear();
+	WriteVarint(m_scratch, static_cast<uint32_t>(numBodies));
+
+	//Ids first, as the gap to the one before. Consecutive ids write zeros
+	uint32_t lastID = 0;
+	for (int index = 0; index < numBodies; index++)
+	{
+		WriteVarint(m_scratch, m_currentFrame[index].m_id - lastID - 1);
+		lastID = m_currentFrame[index].m_id;
+	}
+
+	//Then each value as a column, delta against the same body last frame so resting bodies write zeros
+	for (int valueIndex = 0; valueIndex < NUM_QUANTIZED_VALUES; valueIndex++)
+	{
+		size_t previousIndex = 0;
+		for (int index = 0; index < numBodies; index++)
+		{
+			const QuantizedBody& current = m_currentFrame[index];
+			while (previousIndex < m_previousFrame.size() && m_previousFrame[previousIndex].m_id < current.m_id)
+			{
+				previousIndex++;
+			}
+
+			int32_t reference = 0;
+			if (previousIndex < m_previousFrame.size() && m_previousFrame[previousIndex].m_id == current.m_id)
+			{
+				reference = m_previousFrame[previousIndex].m_values[valueIndex];
+			}
+
+			WriteVarint(m_scratch, ZigZagEncode(current.m_values[valueIndex] - reference));
+		}
+	}
+
+	FrameInfo frame;
+	frame.m_offset = static_cast<uint32_t>(m_data.size());
+	frame.m_rawSize = static_cast<uint32_t>(m_scratch.size());
+	frame.m_simulationStep = simulationStep;
+	frame.m_numBodies = static_cast<uint32_t>(numBodies);
+	frame.m_isKeyframe = isKeyframe ? 1 : 0;
+
+	CompressZeroRuns(m_scratch, m_data);
+	frame.m_compressedSize = static_cast<uint32_t>(m_data.size()) - frame.m_offset;
+	m_frames.push_back(frame);
+
+	m_previousFrame.swap(m_currentFrame);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::DecodeFrame(int frameIndex, std::vector<BodyStateRecord>& out_bodies) const
+{
+	if (frameIndex < 0 || frameIndex >= GetNumFrames())
+	{
+		return false;
+	}
+
+	int keyframeIndex = FindKeyframe(frameIndex);
+
+	std::vector<QuantizedBody> previous;
+	std::vector<QuantizedBody> current;
+	for (int index = keyframeIndex; index <= frameIndex; index++)
+	{
+		if (!DecodeFrameInto(m_frames[index], previous, current))
+		{
+			return false;
+		}
+		previous.swap(current);
+	}
+
+	out_bodies.resize(previous.size());
+	for (int index = 0; index < (int)previous.size(); index++)
+	{
+		Dequantize(previous[index], out_bodies[index]);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::DiscardFramesBefore(int frameIndex)
+{
+	if (frameIndex <= 0 || m_frames.empty())
+	{
+		return;
+	}
+
+	int keyframeIndex = FindKeyframe(std::min(frameIndex, GetNumFrames() - 1));
+	if (keyframeIndex == 0)
+	{
+		return;
+	}
+
+	uint32_t discardedBytes = m_frames[keyframeIndex].m_offset;
+	m_data.erase(m_data.begin(), m_data.begin() + discardedBytes);
+	m_frames.erase(m_frames.begin(), m_frames.begin() + keyframeIndex);
+
+	for (int index = 0; index < (int)m_frames.size(); index++)
+	{
+		m_frames[index].m_offset -= discardedBytes;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::TruncateAfter(int frameIndex)
+{
+	if (frameIndex < 0)
+	{
+		Clear();
+		return;
+	}
+
+	if (frameIndex >= GetNumFrames() - 1)
+	{
+		return;
+	}
+
+	//The encoder needs the truncated frame as its reference for the next append
+	RestoreEncoderState(frameIndex);
+
+	const FrameInfo& lastFrame = m_frames[frameIndex];
+	m_data.resize(lastFrame.m_offset + lastFrame.m_compressedSize);
+	m_frames.resize(frameIndex + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::SaveToFile(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	SnapshotStreamHeader header;
+	header.m_numFrames = static_cast<uint32_t>(m_frames.size());
+	header.m_numBytes = static_cast<uint32_t>(m_data.size());
+	header.m_keyframeInterval = m_keyframeInterval;
+	header.m_worldMin = m_worldBounds.m_minBounds;
+	header.m_worldMax = m_worldBounds.m_maxBounds;
+	header.m_settings = m_settings;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(m_frames.data()), sizeof(FrameInfo) * m_frames.size());
+	file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bytes between the read position and the end, so counts from a header can be checked before anything is sized by them
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t GetBytesRemaining(std::ifstream& file)
+{
+	std::streampos position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streampos end = file.tellg();
+	file.seekg(position);
+	return (end > position) ? static_cast<uint64_t>(end - position) : 0U;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::LoadFromFile(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	SnapshotStreamHeader header;
+	SnapshotStreamHeader expected;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || memcmp(header.m_fourCC, expected.m_fourCC, sizeof(header.m_fourCC)) != 0 || header.m_version != expected.m_version)
+	{
+		return false;
+	}
+
+	//A corrupt or truncated file must not size the frames or data past what is actually there
+	uint64_t numBytesExpected = static_cast<uint64_t>(header.m_numFrames) * sizeof(FrameInfo) + header.m_numBytes;
+	if (GetBytesRemaining(file) < numBytesExpected)
+	{
+		return false;
+	}
+
+	Reset(AABB2(header.m_worldMin, header.m_worldMax), header.m_settings, header.m_keyframeInterval);
+	m_frames.resize(header.m_numFrames);
+	m_data.resize(header.m_numBytes);
+
+	file.read(reinterpret_cast<char*>(m_frames.data()), sizeof(FrameInfo) * m_frames.size());
+	file.read(reinterpret_cast<char*>(m_data.data()), m_data.size());
+	if (!file.good())
+	{
+		Clear();
+		return false;
+	}
+
+	//The frame table is checked before any frame is decoded from it
+	if (!IsFrameTableValid())
+	{
+		Clear();
+		return false;
+	}
+
+	//Appending carries on from the last frame in the file
+	if (!m_frames.empty() && !RestoreEncoderState(GetNumFrames() - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SnapshotStream::GetFrameStep(int frameIndex) const
+{
+	if (frameIndex < 0 || frameIndex >= GetNumFrames())
+	{
+		return -1;
+	}
+
+	return m_frames[frameIndex].m_simulationStep;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SnapshotStream::GetFrameIndexForStep(int simulationStep) const
+{
+	//Last frame at or before the step
+	auto found = std::upper_bound(m_frames.begin(), m_frames.end(), simulationStep, [](int step, const FrameInfo& frame) { return step < frame.m_simulationStep; });
+	return static_cast<int>(found - m_frames.begin()) - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SnapshotStream::FindKeyframe(int frameIndex) const
+{
+	//Keyframe at or before the frame
+	int keyframeIndex = frameIndex;
+	while (keyframeIndex > 0 && m_frames[keyframeIndex].m_isKeyframe == 0)
+	{
+		keyframeIndex--;
+	}
+	return keyframeIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Frames must tile the data in order with nothing left over, and claim no more raw bytes than their compressed bytes can
+// expand to. Anything else came from a damaged file
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::IsFrameTableValid() const
+{
+	uint64_t expectedOffset = 0;
+	for (const FrameInfo& frame : m_frames)
+	{
+		if (frame.m_offset != expectedOffset)
+		{
+			return false;
+		}
+
+		if (static_cast<uint64_t>(frame.m_rawSize) > static_cast<uint64_t>(frame.m_compressedSize) * MAX_ZERO_RUN_EXPANSION)
+		{
+			return false;
+		}
+
+		expectedOffset += frame.m_compressedSize;
+		if (expectedOffset > m_data.size())
+		{
+			return false;
+		}
+	}
+
+	return expectedOffset == m_data.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::RestoreEncoderState(int frameIndex)
+{
+	std::vector<QuantizedBody> previous;
+	for (int index = FindKeyframe(frameIndex); index <= frameIndex; index++)
+	{
+		if (!DecodeFrameInto(m_frames[index], previous, m_previousFrame))
+		{
+			return false;
+		}
+		previous.swap(m_previousFrame);
+	}
+
+	m_previousFrame.swap(previous);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::Quantize(const BodyStateRecord& body, QuantizedBody& out_body) const
+{
+	out_body.m_id = body.m_id;
+	out_body.m_values[0] = QuantizeValue(body.m_position.x - m_worldBounds.m_minBounds.x, m_settings.m_positionError);
+	out_body.m_values[1] = QuantizeValue(body.m_position.y - m_worldBounds.m_minBounds.y, m_settings.m_positionError);
+	out_body.m_values[2] = QuantizeValue(body.m_rotation, m_settings.m_rotationErrorDegrees);
+	out_body.m_values[3] = QuantizeValue(body.m_bodyRotation, m_settings.m_rotationErrorDegrees);
+	out_body.m_values[4] = QuantizeValue(body.m_velocity.x, m_settings.m_velocityError);
+	out_body.m_values[5] = QuantizeValue(body.m_velocity.y, m_settings.m_velocityError);
+	out_body.m_values[6] = QuantizeValue(body.m_angularVelocity, m_settings.m_angularVelocityError);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SnapshotStream::Dequantize(const QuantizedBody& body, BodyStateRecord& out_body) const
+{
+	out_body.m_id = body.m_id;
+	out_body.m_position.x = DequantizeValue(body.m_values[0], m_settings.m_positionError) + m_worldBounds.m_minBounds.x;
+	out_body.m_position.y = DequantizeValue(body.m_values[1], m_settings.m_positionError) + m_worldBounds.m_minBounds.y;
+	out_body.m_rotation = DequantizeValue(body.m_values[2], m_settings.m_rotationErrorDegrees);
+	out_body.m_bodyRotation = DequantizeValue(body.m_values[3], m_settings.m_rotationErrorDegrees);
+	out_body.m_velocity.x = DequantizeValue(body.m_values[4], m_settings.m_velocityError);
+	out_body.m_velocity.y = DequantizeValue(body.m_values[5], m_settings.m_velocityError);
+	out_body.m_angularVelocity = DequantizeValue(body.m_values[6], m_settings.m_angularVelocityError);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SnapshotStream::DecodeFrameInto(const FrameInfo& frame, const std::vector<QuantizedBody>& previous, std::vector<QuantizedBody>& out_current) const
+{
+	if (static_cast<uint64_t>(frame.m_offset) + frame.m_compressedSize > m_data.size())
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> raw;
+	if (!DecompressZeroRuns(m_data.data() + frame.m_offset, frame.m_compressedSize, raw, frame.m_rawSize))
+	{
+		return false;
+	}
+
+	const uint8_t* readPos = raw.data();
+	const uint8_t* readEnd = raw.data() + raw.size();
+
+	uint32_t numBodies = 0;
+	if (!ReadVarint(readPos, readEnd, numBodies) || numBodies != frame.m_numBodies)
+	{
+		return false;
+	}
+
+	//Every body takes at least a byte for its id and one per value
+	if (numBodies > static_cast<size_t>(readEnd - readPos) / (1 + NUM_QUANTIZED_VALUES))
+	{
+		return false;
+	}
+
+	out_current.resize(numBodies);
+	uint32_t lastID = 0;
+	for (uint32_t index = 0; index < numBodies; index++)
+	{
+		uint32_t gap = 0;
+		if (!ReadVarint(readPos, readEnd, gap))
+		{
+			return false;
+		}
+
+		out_current[index].m_id = lastID + gap + 1;
+		lastID = out_current[index].m_id;
+	}
+
+	//Keyframes are coded against nothing
+	static const std::vector<QuantizedBody> s_noPrevious;
+	const std::vector<QuantizedBody>& reference = frame.m_isKeyframe ? s_noPrevious : previous;
+
+	for (int valueIndex = 0; valueIndex < NUM_QUANTIZED_VALUES; valueIndex++)
+	{
+		size_t previousIndex = 0;
+		for (uint32_t index = 0; index < numBodies; index++)
+		{
+			QuantizedBody& current = out_current[index];
+			while (previousIndex < reference.size() && reference[previousIndex].m_id < current.m_id)
+			{
+				previousIndex++;
+			}
+
+			int32_t referenceValue = 0;
+			if (previousIndex < reference.size() && reference[previousIndex].m_id == current.m_id)
+			{
+				referenceValue = reference[previousIndex].m_values[valueIndex];
+			}
+
+			uint32_t encoded = 0;
+			if (!ReadVarint(readPos, readEnd, encoded))
+			{
+				return false;
+			}
+			//Wraps rather than overflows on a damaged delta
+			current.m_values[valueIndex] = static_cast<int32_t>(static_cast<uint32_t>(referenceValue) + static_cast<uint32_t>(ZigZagDecode(encoded)));
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void SnapshotStream::WriteVarint(std::vector<uint8_t>& buffer, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back(static_cast<uint8_t>(value));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool SnapshotStream::ReadVarint(const uint8_t*& readPos, const uint8_t* readEnd, uint32_t& out_value)
+{
+	out_value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (readPos == readEnd)
+		{
+			return false;
+		}
+
+		uint8_t byte = *readPos;
+		readPos++;
+
+		out_value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint32_t SnapshotStream::ZigZagEncode(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int32_t SnapshotStream::ZigZagDecode(uint32_t value)
+{
+	return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void SnapshotStream::CompressZeroRuns(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out_compressed)
+{
+	//A zero byte is followed by how many more zeros come after it (up to 255)
+	size_t readIndex = 0;
+	while (readIndex < raw.size())
+	{
+		uint8_t byte = raw[readIndex];
+		out_compressed.push_back(byte);
+		readIndex++;
+
+		if (byte != 0)
+		{
+			continue;
+		}
+
+		uint8_t runLength = 0;
+		while (readIndex < raw.size() && raw[readIndex] == 0 && runLength < 255)
+		{
+			runLength++;
+			readIndex++;
+		}
+		out_compressed.push_back(runLength);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool SnapshotStream::DecompressZeroRuns(const uint8_t* compressed, size_t compressedSize, std::vector<uint8_t>& out_raw, size_t rawSize)
+{
+	out_raw.clear();
+	if (static_cast<uint64_t>(rawSize) > static_cast<uint64_t>(compressedSize) * MAX_ZERO_RUN_EXPANSION)
+	{
+		return false;
+	}
+	out_raw.reserve(rawSize);
+
+	size_t readIndex = 0;
+	while (readIndex < compressedSize)
+	{
+		uint8_t byte = compressed[readIndex];
+		readIndex++;
+
+		if (byte != 0)
+		{
+			out_raw.push_back(byte);
+			continue;
+		}
+
+		if (readIndex == compressedSize)
+		{
+			return false;
+		}
+
+		out_raw.insert(out_raw.end(), static_cast<size_t>(compressed[readIndex]) + 1, 0);
+		readIndex++;
+
+		if (out_raw.size() > rawSize)
+		{
+			return false;
+		}
+	}
+
+	return out_raw.size() == rawSize;
+}
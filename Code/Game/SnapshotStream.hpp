@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Game/CheckpointLog.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Largest error allowed after a round trip. Smaller values cost more bits
+//------------------------------------------------------------------------------------------------------------------------------
+struct QuantizationSettings
+{
+	float					m_positionError = 0.005f;
+	float					m_rotationErrorDegrees = 0.05f;
+	float					m_velocityError = 0.005f;
+	float					m_angularVelocityError = 0.05f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Compact history of body states, one frame per simulation step.
+// Each frame is quantized, delta coded against the frame before it (or nothing, on a keyframe), written column by column
+// as varints and then zero run compressed. Bodies that didn't move cost a couple of bytes
+//------------------------------------------------------------------------------------------------------------------------------
+class SnapshotStream
+{
+public:
+	void					Reset(const AABB2& worldBounds, const QuantizationSettings& settings, int keyframeInterval = 120);
+	void					Clear();
+
+	//Bodies must be sorted by id, which capture order already is
+	void					AppendFrame(const std::vector<BodyStateRecord>& bodies, int simulationStep);
+	bool					DecodeFrame(int frameIndex, std::vector<BodyStateRecord>& out_bodies) const;
+
+	//Drops everything before the keyframe at or below frameIndex, used to keep a bounded history
+	void					DiscardFramesBefore(int frameIndex);
+	//Drops everything after frameIndex so recording can branch off from it
+	void					TruncateAfter(int frameIndex);
+
+	bool					SaveToFile(const std::string& filePath) const;
+	bool					LoadFromFile(const std::string& filePath);
+
+	inline int				GetNumFrames() const { return static_cast<int>(m_frames.size()); }
+	inline size_t			GetNumBytes() const { return m_data.size(); }
+	int						GetFrameStep(int frameIndex) const;
+	int						GetFrameIndexForStep(int simulationStep) const;
+	inline const QuantizationSettings&	GetSettings() const { return m_settings; }
+
+private:
+	static constexpr int	NUM_QUANTIZED_VALUES = 7;
+	static constexpr int	MAX_ZERO_RUN_EXPANSION = 128;		// Raw bytes per compressed byte at most, a zero and its run give 256
+
+	struct QuantizedBody
+	{
+		uint32_t			m_id = 0;
+		int32_t				m_values[NUM_QUANTIZED_VALUES];
+	};
+
+	struct FrameInfo
+	{
+		uint32_t			m_offset = 0;
+		uint32_t			m_compressedSize = 0;
+		uint32_t			m_rawSize = 0;
+		int32_t				m_simulationStep = 0;
+		uint32_t			m_numBodies = 0;
+		uint32_t			m_isKeyframe = 0;
+	};
+
+	int						FindKeyframe(int frameIndex) const;
+	bool					IsFrameTableValid() const;
+	bool					RestoreEncoderState(int frameIndex);
+
+	void					Quantize(const BodyStateRecord& body, QuantizedBody& out_body) const;
+	void					Dequantize(const QuantizedBody& body, BodyStateRecord& out_body) const;
+
+	bool					DecodeFrameInto(const FrameInfo& frame, const std::vector<QuantizedBody>& previous, std::vector<QuantizedBody>& out_current) const;
+
+	static void				WriteVarint(std::vector<uint8_t>& buffer, uint32_t value);
+	static bool				ReadVarint(const uint8_t*& readPos, const uint8_t* readEnd, uint32_t& out_value);
+	static uint32_t			ZigZagEncode(int32_t value);
+	static int32_t			ZigZagDecode(uint32_t value);
+
+	static void				CompressZeroRuns(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out_compressed);
+	static bool				DecompressZeroRuns(const uint8_t* compressed, size_t compressedSize, std::vector<uint8_t>& out_raw, size_t rawSize);
+
+private:
+	AABB2					m_worldBounds;
+	QuantizationSettings	m_settings;
+	int						m_keyframeInterval = 120;
+
+	std::vector<uint8_t>	m_data;
+	std::vector<FrameInfo>	m_frames;
+
+	//Encoder state, the last frame appended
+	std::vector<QuantizedBody>	m_previousFrame;
+	std::vector<QuantizedBody>	m_currentFrame;
+	std::vector<uint8_t>		m_scratch;
+};
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/StateHashLog.hpp"
+#include <fstream>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StateHasher::AddBytes(const void* data, size_t numBytes)
+{
+	constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	for (size_t byteIndex = 0; byteIndex < numBytes; byteIndex++)
+	{
+		m_hash ^= bytes[byteIndex];
+		m_hash *= FNV_PRIME;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StateHasher::AddFloat(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	AddBytes(&bits, sizeof(bits));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StateHasher::AddInt(int value)
+{
+	AddBytes(&value, sizeof(value));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StateHashLog::Clear()
+{
+	m_stepHashes.clear();
+	m_divergedStep = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StateHashLog::ClearReference()
+{
+	m_referenceHashes.clear();
+	m_divergedStep = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool StateHashLog::RecordStep(uint64_t stateHash)
+{
+	int step = static_cast<int>(m_stepHashes.size());
+	m_stepHashes.push_back(stateHash);
+
+	if (HasDiverged() || step >= static_cast<int>(m_referenceHashes.size()))
+	{
+		return true;
+	}
+
+	if (m_referenceHashes[step] != stateHash)
+	{
+		m_divergedStep = step;
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool StateHashLog::SaveToFile(const std::string& filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	//One "step hash" pair per line so two runs can be diffed directly
+	file << std::hex;
+	int numSteps = GetNumSteps();
+	for (int step = 0; step < numSteps; step++)
+	{
+		file << step << " " << m_stepHashes[step] << "\n";
+	}
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool StateHashLog::LoadReferenceFromFile(const std::string& filePath)
+{
+	std::ifstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	ClearReference();
+
+	file >> std::hex;
+	int step = 0;
+	uint64_t hash = 0;
+	while (file >> step >> hash)
+	{
+		m_referenceHashes.push_back(hash);
+	}
+
+	return true;
+}
@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// FNV-1a hasher for simulation state. Floats are hashed by their bit pattern so any divergence shows up
+//------------------------------------------------------------------------------------------------------------------------------
+class StateHasher
+{
+public:
+	void					AddBytes(const void* data, size_t numBytes);
+	void					AddFloat(float value);
+	void					AddInt(int value);
+
+	inline uint64_t			GetHash() const { return m_hash; }
+
+private:
+	uint64_t				m_hash = 0xcbf29ce484222325ULL;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Per step record of world state hashes. Can be written out and used as a reference for a later run
+//------------------------------------------------------------------------------------------------------------------------------
+class StateHashLog
+{
+public:
+	void					Clear();
+	void					ClearReference();
+
+	// Returns false the first time a step does not match the loaded reference
+	bool					RecordStep(uint64_t stateHash);
+
+	bool					SaveToFile(const std::string& filePath) const;
+	bool					LoadReferenceFromFile(const std::string& filePath);
+
+	inline int				GetNumSteps() const					{ return static_cast<int>(m_stepHashes.size()); }
+	inline uint64_t			GetHashForStep(int step) const		{ return m_stepHashes[step]; }
+	inline bool				HasReference() const				{ return !m_referenceHashes.empty(); }
+	inline bool				HasDiverged() const					{ return m_divergedStep >= 0; }
+	inline int				GetDivergedStep() const				{ return m_divergedStep; }
+
+private:
+	std::vector<uint64_t>	m_stepHashes;
+	std::vector<uint64_t>	m_referenceHashes;
+	int						m_divergedStep = -1;
+};
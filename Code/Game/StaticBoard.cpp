@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/StaticBoard.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+//Game Systems
+#include "Game/FrameProfiler.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/MappedFile.hpp"
+#include "Game/StateHashLog.hpp"
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+std::mutex StaticBoard::s_liveBoardsMutex;
+std::vector<std::weak_ptr<const StaticBoard>> StaticBoard::s_liveBoards;
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::shared_ptr<const StaticBoard> StaticBoard::Compile(const GeometrySnapshotRecord* records, int numRecords, const std::shared_ptr<const MappedFile>& mappedFile)
+{
+	PROFILE_SCOPE("Compile Static Board");
+
+	int firstStatic = -1;
+	int lastStatic = -1;
+	int numStatic = 0;
+	for (int index = 0; index < numRecords; index++)
+	{
+		if (records[index].m_simulationType == STATIC_SIMULATION)
+		{
+			firstStatic = (firstStatic < 0) ? index : firstStatic;
+			lastStatic = index;
+			numStatic++;
+		}
+	}
+
+	//Static records in one run are used where they are, scattered ones are gathered into a copy first
+	bool isOneRun = (numStatic > 0) && (lastStatic - firstStatic + 1 == numStatic);
+	std::vector<GeometrySnapshotRecord> staticRecords;
+	const GeometrySnapshotRecord* staticData = isOneRun ? &records[firstStatic] : nullptr;
+	if (!isOneRun && numStatic > 0)
+	{
+		staticRecords.reserve(numStatic);
+		for (int index = 0; index < numRecords; index++)
+		{
+			if (records[index].m_simulationType == STATIC_SIMULATION)
+			{
+				staticRecords.push_back(records[index]);
+			}
+		}
+		staticData = staticRecords.data();
+	}
+
+	//Records are 4 byte fields with no padding, so the bytes are the content
+	StateHasher hasher;
+	hasher.AddInt(numStatic);
+	hasher.AddBytes(staticData, numStatic * sizeof(GeometrySnapshotRecord));
+	uint64_t hash = hasher.GetHash();
+
+	std::lock_guard<std::mutex> lock(s_liveBoardsMutex);
+	for (size_t boardIndex = 0; boardIndex < s_liveBoards.size(); boardIndex++)
+	{
+		std::shared_ptr<const StaticBoard> liveBoard = s_liveBoards[boardIndex].lock();
+		if (liveBoard == nullptr)
+		{
+			s_liveBoards.erase(s_liveBoards.begin() + boardIndex);
+			boardIndex--;
+			continue;
+		}
+
+		if (liveBoard->m_hash == hash && liveBoard->HasSameRecords(staticData, numStatic))
+		{
+			return liveBoard;
+		}
+	}
+
+	StaticBoard* board = new StaticBoard();
+	if (isOneRun && mappedFile != nullptr)
+	{
+		board->m_mappedFile = mappedFile;
+		board->m_records = staticData;
+	}
+	else
+	{
+		if (isOneRun)
+		{
+			staticRecords.assign(staticData, staticData + numStatic);
+		}
+		board->m_ownedRecords.swap(staticRecords);
+		board->m_records = board->m_ownedRecords.data();
+	}
+	board->m_numRecords = numStatic;
+	board->m_hash = hash;
+	board->m_pegBoard.Build(board->m_records, board->GetNumBodies(), DISC_MAX_RADIUS);
+
+	std::shared_ptr<const StaticBoard> sharedBoard(board);
+	s_liveBoards.push_back(sharedBoard);
+	return sharedBoard;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool StaticBoard::HasSameRecords(const GeometrySnapshotRecord* records, int numRecords) const
+{
+	if (numRecords != m_numRecords)
+	{
+		return false;
+	}
+
+	return numRecords == 0 || memcmp(records, m_records, numRecords * sizeof(GeometrySnapshotRecord)) == 0;
+}
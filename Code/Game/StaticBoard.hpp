@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Game/BallBatch.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class MappedFile;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The static bodies of a scene compiled once into shapes and a peg grid, then never changed. Boards are handed out as
+// shared pointers and compiling the same static set again returns the board that is already alive, so every world and
+// every reload of one board shares a single copy. Worlds build their own bodies from it, see PhysicsWorld::AttachStaticBoard
+//------------------------------------------------------------------------------------------------------------------------------
+class StaticBoard
+{
+public:
+	//Keeps only the static records. Safe to call from any thread. When the records come from a mapped file and the static
+	//ones sit in one run, the board reads them in place and holds the mapping open for as long as it lives
+	static std::shared_ptr<const StaticBoard>	Compile(const GeometrySnapshotRecord* records, int numRecords, const std::shared_ptr<const MappedFile>& mappedFile = nullptr);
+
+	inline const GeometrySnapshotRecord*	GetRecords() const { return m_records; }
+	inline int				GetNumBodies() const { return m_numRecords; }
+	inline bool				IsMapped() const { return m_mappedFile != nullptr; }
+	inline uint64_t			GetHash() const { return m_hash; }
+
+	//Built for balls up to DISC_MAX_RADIUS
+	inline const PegBoard&	GetPegBoard() const { return m_pegBoard; }
+
+private:
+	StaticBoard() = default;
+
+	bool					HasSameRecords(const GeometrySnapshotRecord* records, int numRecords) const;
+
+private:
+	const GeometrySnapshotRecord*	m_records = nullptr;		// Into m_ownedRecords or the mapped file
+	int						m_numRecords = 0;
+	std::vector<GeometrySnapshotRecord>	m_ownedRecords;
+	std::shared_ptr<const MappedFile>	m_mappedFile;
+	uint64_t				m_hash = 0;
+	PegBoard				m_pegBoard;
+
+	//Boards still in use somewhere. Expired entries are dropped on the next compile
+	static std::mutex		s_liveBoardsMutex;
+	static std::vector<std::weak_ptr<const StaticBoard>>	s_liveBoards;
+};
@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/WorldSnapshot.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Collider2D.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+#include <ThirdParty/TinyXML2/tinyxml2.h>
+//Game Systems
+#include "Game/Geometry.hpp"
+#include <fstream>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometrySnapshotRecord::SetFromGeometry(const Geometry& geometry)
+{
+	const GeometryShape& shape = geometry.m_shape;
+	const Rigidbody2D& rigidbody = *geometry.m_rigidbody;
+
+	m_id = geometry.m_id;
+	m_geometryType = shape.m_geometryType;
+	m_simulationType = geometry.m_rigidbody->GetSimulationType();
+	m_size = shape.m_size;
+	m_start = shape.m_start;
+	m_end = shape.m_end;
+	m_radius = shape.m_radius;
+	m_shapeRotation = shape.m_rotationDegrees;
+
+	m_mass = rigidbody.m_mass;
+	m_friction = rigidbody.m_friction;
+	m_linearDrag = rigidbody.m_linearDrag;
+	m_angularDrag = rigidbody.m_angularDrag;
+	m_momentOfInertia = rigidbody.m_momentOfInertia;
+	m_restitution = rigidbody.m_material.restitution;
+	m_constraints = rigidbody.m_constraints;
+
+	m_position = geometry.m_transform.m_position;
+	m_rotation = geometry.m_transform.m_rotation;
+	m_scale = geometry.m_transform.m_scale;
+	m_bodyRotation = rigidbody.m_rotation;
+	m_velocity = rigidbody.m_velocity;
+	m_angularVelocity = rigidbody.m_angularVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void GeometrySnapshotRecord::ApplyToGeometry(Geometry& geometry) const
+{
+	if (m_id != 0)
+	{
+		geometry.SetID(m_id);
+	}
+
+	Rigidbody2D* rigidbody = geometry.m_rigidbody;
+	rigidbody->m_mass = m_mass;
+	rigidbody->m_friction = m_friction;
+	rigidbody->m_linearDrag = m_linearDrag;
+	rigidbody->m_angularDrag = m_angularDrag;
+	rigidbody->m_momentOfInertia = m_momentOfInertia;
+	rigidbody->m_material.restitution = m_restitution;
+	rigidbody->SetConstraints(m_constraints);
+	rigidbody->m_rotation = m_bodyRotation;
+	rigidbody->m_velocity = m_velocity;
+	rigidbody->m_angularVelocity = m_angularVelocity;
+
+	geometry.m_transform.m_position = m_position;
+	geometry.m_transform.m_rotation = m_rotation;
+	geometry.m_transform.m_scale = m_scale;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+GeometryShape GeometrySnapshotRecord::GetShape() const
+{
+	GeometryShape shape;
+	shape.m_geometryType = static_cast<eGeometryType>(m_geometryType);
+	shape.m_position = m_position;
+	shape.m_rotationDegrees = m_shapeRotation;
+	shape.m_size = m_size;
+	shape.m_start = m_start;
+	shape.m_end = m_end;
+	shape.m_radius = m_radius;
+	return shape;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool WorldSnapshot::SaveToFile(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	WorldSnapshotHeader header;
+	header.m_numRecords = static_cast<uint32_t>(m_records.size());
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	//Static records are written first, each group keeping its order, so a mapped load finds the board in one run it can use
+	//where it sits. Loads split the records by type anyway, so the order between the groups changes nothing
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool isStaticPass = (pass == 0);
+		size_t runStart = 0;
+		for (size_t index = 0; index <= m_records.size(); index++)
+		{
+			bool isInPass = index < m_records.size() && (m_records[index].m_simulationType == STATIC_SIMULATION) == isStaticPass;
+			if (isInPass)
+			{
+				continue;
+			}
+
+			if (index > runStart)
+			{
+				file.write(reinterpret_cast<const char*>(&m_records[runStart]), sizeof(GeometrySnapshotRecord) * (index - runStart));
+			}
+			runStart = index + 1;
+		}
+	}
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bytes between the read position and the end, so counts from a header can be checked before anything is sized by them
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t GetBytesRemaining(std::ifstream& file)
+{
+	std::streampos position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streampos end = file.tellg();
+	file.seekg(position);
+	return (end > position) ? static_cast<uint64_t>(end - position) : 0U;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool WorldSnapshot::LoadFromFile(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	WorldSnapshotHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || !IsHeaderValid(header))
+	{
+		return false;
+	}
+
+	//A corrupt or truncated file must not size the records past what is actually there
+	if (GetBytesRemaining(file) < static_cast<uint64_t>(header.m_numRecords) * sizeof(GeometrySnapshotRecord))
+	{
+		return false;
+	}
+
+	m_records.resize(header.m_numRecords);
+	if (header.m_numRecords > 0)
+	{
+		file.read(reinterpret_cast<char*>(m_records.data()), sizeof(GeometrySnapshotRecord) * m_records.size());
+		if (!file.good())
+		{
+			m_records.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool WorldSnapshot::SaveToXmlFile(const std::string& filePath) const
+{
+	tinyxml2::XMLDocument saveDoc;
+
+	tinyxml2::XMLElement* rootNode = saveDoc.NewElement("SavedGeometry");
+	saveDoc.InsertFirstChild(rootNode);
+
+	int numObjects = (int)m_records.size();
+	int numStatic = 0;
+	for (int index = 0; index < numObjects; index++)
+	{
+		if (m_records[index].m_simulationType == STATIC_SIMULATION)
+		{
+			numStatic++;
+		}
+	}
+
+	//Lets the streaming loader reserve everything before it creates the first body
+	rootNode->SetAttribute("Count", numObjects);
+	rootNode->SetAttribute("StaticCount", numStatic);
+
+	for (int index = 0; index < numObjects; index++)
+	{
+		const GeometrySnapshotRecord& record = m_records[index];
+
+		tinyxml2::XMLElement* geometry = saveDoc.NewElement("GeometryData");
+		tinyxml2::XMLElement* rbElem = saveDoc.NewElement("RigidBody");
+		geometry->InsertEndChild(rbElem);
+
+		//Rigidbody data
+		rbElem->SetAttribute("SimType", record.m_simulationType);
+		rbElem->SetAttribute("Shape", GetColliderTypeForGeometry(record.m_geometryType));
+		rbElem->SetAttribute("Mass", record.m_mass);
+		rbElem->SetAttribute("Friction", record.m_friction);
+		rbElem->SetAttribute("AngularDrag", record.m_angularDrag);
+		rbElem->SetAttribute("LinearDrag", record.m_linearDrag);
+		rbElem->SetAttribute("Freedom", record.m_constraints.GetAsString().c_str());
+		rbElem->SetAttribute("Moment", record.m_momentOfInertia);
+		rbElem->SetAttribute("Restitution", record.m_restitution);
+
+		tinyxml2::XMLElement* colElem = saveDoc.NewElement("Collider");
+		geometry->InsertEndChild(colElem);
+
+		//Collider data
+		switch (record.m_geometryType)
+		{
+		case AABB2_GEOMETRY:
+		{
+			colElem->SetAttribute("Size", record.m_size.GetAsString().c_str());
+		}
+		break;
+		case DISC_GEOMETRY:
+		{
+			colElem->SetAttribute("Radius", record.m_radius);
+		}
+		break;
+		case BOX_GEOMETRY:
+		{
+			colElem->SetAttribute("Center", record.m_position.GetAsString().c_str());
+			colElem->SetAttribute("Size", record.m_size.GetAsString().c_str());
+			colElem->SetAttribute("Rotation", record.m_bodyRotation);
+		}
+		break;
+		case CAPSULE_GEOMETRY:
+		{
+			colElem->SetAttribute("Start", record.m_start.GetAsString().c_str());
+			colElem->SetAttribute("End", record.m_end.GetAsString().c_str());
+			colElem->SetAttribute("Radius", record.m_radius);
+		}
+		break;
+		default:
+		break;
+		}
+
+		//Transform stuff
+		tinyxml2::XMLElement* tranformElem = saveDoc.NewElement("Transform");
+		geometry->InsertEndChild(tranformElem);
+
+		tranformElem->SetAttribute("Position", record.m_position.GetAsString().c_str());
+		tranformElem->SetAttribute("Rotation", record.m_rotation);
+		tranformElem->SetAttribute("Scale", record.m_scale.GetAsString().c_str());
+
+		rootNode->InsertEndChild(geometry);
+	}
+
+	return saveDoc.SaveFile(filePath.c_str()) == tinyxml2::XML_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int WorldSnapshot::GetColliderTypeForGeometry(int geometryType)
+{
+	switch (geometryType)
+	{
+	case AABB2_GEOMETRY:	return COLLIDER_AABB2;
+	case DISC_GEOMETRY:		return COLLIDER_DISC;
+	case BOX_GEOMETRY:		return COLLIDER_BOX;
+	case CAPSULE_GEOMETRY:	return COLLIDER_CAPSULE;
+	default:				return -1;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool WorldSnapshot::IsHeaderValid(const WorldSnapshotHeader& header)
+{
+	WorldSnapshotHeader expected;
+	if (memcmp(header.m_fourCC, expected.m_fourCC, sizeof(header.m_fourCC)) != 0)
+	{
+		return false;
+	}
+
+	return header.m_version == expected.m_version && header.m_recordSize == expected.m_recordSize;
+}
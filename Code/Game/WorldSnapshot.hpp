@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+struct GeometryShape;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Fixed layout, 4 byte fields only. Written and read as one packed array so do not reorder without bumping the version
+//------------------------------------------------------------------------------------------------------------------------------
+struct GeometrySnapshotRecord
+{
+	uint32_t				m_id = 0;
+
+	//Shape
+	int32_t					m_geometryType = -1;
+	int32_t					m_simulationType = 0;
+	Vec2					m_size = Vec2::ZERO;
+	Vec2					m_start = Vec2::ZERO;
+	Vec2					m_end = Vec2::ZERO;
+	float					m_radius = 0.f;
+	float					m_shapeRotation = 0.f;
+
+	//Material
+	float					m_mass = 1.f;
+	float					m_friction = 0.f;
+	float					m_linearDrag = 0.f;
+	float					m_angularDrag = 0.f;
+	float					m_momentOfInertia = 0.f;
+	float					m_restitution = 1.f;
+	Vec3					m_constraints = Vec3::ONE;
+
+	//Transform and velocity
+	Vec2					m_position = Vec2::ZERO;
+	float					m_rotation = 0.f;
+	Vec2					m_scale = Vec2(1.f, 1.f);
+	float					m_bodyRotation = 0.f;
+	Vec2					m_velocity = Vec2::ZERO;
+	float					m_angularVelocity = 0.f;
+
+	void					SetFromGeometry(const Geometry& geometry);
+	void					ApplyToGeometry(Geometry& geometry) const;
+	GeometryShape			GetShape() const;
+};
+
+static_assert(sizeof(GeometrySnapshotRecord) == 116, "GeometrySnapshotRecord layout changed, bump WORLD_SNAPSHOT_VERSION");
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t WORLD_SNAPSHOT_VERSION = 2;
+
+struct WorldSnapshotHeader
+{
+	char					m_fourCC[4] = { 'P', 'S', 'N', 'P' };
+	uint32_t				m_version = WORLD_SNAPSHOT_VERSION;
+	uint32_t				m_recordSize = sizeof(GeometrySnapshotRecord);
+	uint32_t				m_numRecords = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Binary save format for the world. XML stays the human editable format, this one is for speed and size
+//------------------------------------------------------------------------------------------------------------------------------
+class WorldSnapshot
+{
+public:
+	bool					SaveToFile(const std::string& filePath) const;
+	bool					LoadFromFile(const std::string& filePath);
+
+	//Same layout Game::LoadFromFile reads
+	bool					SaveToXmlFile(const std::string& filePath) const;
+
+	static bool				IsHeaderValid(const WorldSnapshotHeader& header);
+	static int				GetColliderTypeForGeometry(int geometryType);
+
+public:
+	std::vector<GeometrySnapshotRecord>	m_records;
+};
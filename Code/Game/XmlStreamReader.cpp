@@ -0,0 +1,349 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/XmlStreamReader.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool IsXmlWhitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Pulls up to maxValues floats out of text like "1.5,2" or "(1.5, 2, 0)". Returns how many were found
+//------------------------------------------------------------------------------------------------------------------------------
+static int ParseFloatList(const char* text, float* out_values, int maxValues)
+{
+	int numValues = 0;
+	const char* readPos = text;
+	while (*readPos != '\0' && numValues < maxValues)
+	{
+		bool isNumberStart = (*readPos >= '0' && *readPos <= '9') || *readPos == '-' || *readPos == '+' || *readPos == '.';
+		if (!isNumberStart)
+		{
+			readPos++;
+			continue;
+		}
+
+		char* numberEnd = nullptr;
+		float value = strtof(readPos, &numberEnd);
+		if (numberEnd == readPos)
+		{
+			readPos++;
+			continue;
+		}
+
+		out_values[numValues] = value;
+		numValues++;
+		readPos = numberEnd;
+	}
+
+	return numValues;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const char* XmlStreamElement::GetAttribute(const char* name) const
+{
+	for (int index = 0; index < m_numAttributes; index++)
+	{
+		if (m_attributes[index].m_name == name)
+		{
+			return m_attributes[index].m_value.c_str();
+		}
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float XmlStreamElement::GetAttribute(const char* name, float defaultValue) const
+{
+	const char* text = GetAttribute(name);
+	float value = defaultValue;
+	if (text != nullptr)
+	{
+		ParseFloatList(text, &value, 1);
+	}
+	return value;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int XmlStreamElement::GetAttribute(const char* name, int defaultValue) const
+{
+	const char* text = GetAttribute(name);
+	if (text == nullptr)
+	{
+		return defaultValue;
+	}
+
+	return atoi(text);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 XmlStreamElement::GetAttribute(const char* name, const Vec2& defaultValue) const
+{
+	const char* text = GetAttribute(name);
+	float values[2];
+	if (text == nullptr || ParseFloatList(text, values, 2) != 2)
+	{
+		return defaultValue;
+	}
+
+	return Vec2(values[0], values[1]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 XmlStreamElement::GetAttribute(const char* name, const Vec3& defaultValue) const
+{
+	const char* text = GetAttribute(name);
+	float values[3];
+	if (text == nullptr || ParseFloatList(text, values, 3) != 3)
+	{
+		return defaultValue;
+	}
+
+	return Vec3(values[0], values[1], values[2]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool XmlStreamReader::Open(const std::string& filePath)
+{
+	Close();
+
+	m_file.open(filePath, std::ios::binary);
+	if (!m_file.is_open())
+	{
+		return false;
+	}
+
+	m_buffer.resize(BUFFER_SIZE);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void XmlStreamReader::Close()
+{
+	if (m_file.is_open())
+	{
+		m_file.close();
+	}
+
+	m_file.clear();
+	m_bufferPos = 0;
+	m_bufferEnd = 0;
+	m_hasError = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool XmlStreamReader::GetChar(char& out_char)
+{
+	if (m_bufferPos == m_bufferEnd)
+	{
+		m_file.read(m_buffer.data(), BUFFER_SIZE);
+		m_bufferEnd = static_cast<int>(m_file.gcount());
+		m_bufferPos = 0;
+
+		if (m_bufferEnd == 0)
+		{
+			return false;
+		}
+	}
+
+	out_char = m_buffer[m_bufferPos];
+	m_bufferPos++;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool XmlStreamReader::SkipPast(const char* terminator)
+{
+	int terminatorLength = static_cast<int>(strlen(terminator));
+	int numMatched = 0;
+
+	char c;
+	while (GetChar(c))
+	{
+		if (c == terminator[numMatched])
+		{
+			numMatched++;
+			if (numMatched == terminatorLength)
+			{
+				return true;
+			}
+		}
+		else
+		{
+			numMatched = (c == terminator[0]) ? 1 : 0;
+		}
+	}
+
+	m_hasError = true;
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool XmlStreamReader::ReadNextElement(XmlStreamElement& out_element)
+{
+	char c;
+	while (GetChar(c))
+	{
+		if (c != '<')
+		{
+			//Text content, our files don't use it
+			continue;
+		}
+
+		if (!GetChar(c))
+		{
+			break;
+		}
+
+		if (c == '?')
+		{
+			//Declaration
+			if (!SkipPast("?>"))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		if (c == '!')
+		{
+			//Comment or doctype
+			char first;
+			char second;
+			if (!GetChar(first) || !GetChar(second))
+			{
+				break;
+			}
+
+			bool isComment = (first == '-' && second == '-');
+			if (!SkipPast(isComment ? "-->" : ">"))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		out_element.m_name.clear();
+		out_element.m_numAttributes = 0;
+		out_element.m_isEndTag = (c == '/');
+		out_element.m_isEmptyTag = false;
+
+		if (!out_element.m_isEndTag)
+		{
+			out_element.m_name.push_back(c);
+		}
+
+		return ReadTag(out_element);
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool XmlStreamReader::ReadTag(XmlStreamElement& out_element)
+{
+	char c;
+
+	//Element name
+	while (true)
+	{
+		if (!GetChar(c))
+		{
+			m_hasError = true;
+			return false;
+		}
+
+		if (IsXmlWhitespace(c) || c == '/' || c == '>')
+		{
+			break;
+		}
+
+		out_element.m_name.push_back(c);
+	}
+
+	//Attributes
+	while (true)
+	{
+		while (IsXmlWhitespace(c))
+		{
+			if (!GetChar(c))
+			{
+				m_hasError = true;
+				return false;
+			}
+		}
+
+		if (c == '>')
+		{
+			return true;
+		}
+
+		if (c == '/')
+		{
+			out_element.m_isEmptyTag = true;
+			if (!GetChar(c) || c != '>')
+			{
+				m_hasError = true;
+				return false;
+			}
+			return true;
+		}
+
+		if (out_element.m_numAttributes == static_cast<int>(out_element.m_attributes.size()))
+		{
+			out_element.m_attributes.emplace_back();
+		}
+
+		XmlStreamAttribute& attribute = out_element.m_attributes[out_element.m_numAttributes];
+		attribute.m_name.clear();
+		attribute.m_value.clear();
+		out_element.m_numAttributes++;
+
+		//Name up to the =
+		while (c != '=' && !IsXmlWhitespace(c))
+		{
+			attribute.m_name.push_back(c);
+			if (!GetChar(c))
+			{
+				m_hasError = true;
+				return false;
+			}
+		}
+
+		while (c != '"' && c != '\'')
+		{
+			if (!GetChar(c) || (c != '=' && c != '"' && c != '\'' && !IsXmlWhitespace(c)))
+			{
+				m_hasError = true;
+				return false;
+			}
+		}
+
+		//Quoted value
+		char quote = c;
+		while (true)
+		{
+			if (!GetChar(c))
+			{
+				m_hasError = true;
+				return false;
+			}
+
+			if (c == quote)
+			{
+				break;
+			}
+
+			attribute.m_value.push_back(c);
+		}
+
+		if (!GetChar(c))
+		{
+			m_hasError = true;
+			return false;
+		}
+	}
+}
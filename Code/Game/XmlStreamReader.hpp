@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct XmlStreamAttribute
+{
+	std::string				m_name;
+	std::string				m_value;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One start, end or empty tag. Attribute storage is kept between reads so parsing a long file doesn't allocate per element
+//------------------------------------------------------------------------------------------------------------------------------
+struct XmlStreamElement
+{
+	std::string				m_name;
+	bool					m_isEndTag = false;
+	bool					m_isEmptyTag = false;
+	int						m_numAttributes = 0;
+	std::vector<XmlStreamAttribute>	m_attributes;
+
+	const char*				GetAttribute(const char* name) const;
+	float					GetAttribute(const char* name, float defaultValue) const;
+	int						GetAttribute(const char* name, int defaultValue) const;
+	Vec2					GetAttribute(const char* name, const Vec2& defaultValue) const;
+	Vec3					GetAttribute(const char* name, const Vec3& defaultValue) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Forward only XML tag reader. Reads the file through a fixed size buffer so memory use doesn't depend on the file size.
+// Only handles what our save files use: elements and attributes. Text, comments and declarations are skipped
+//------------------------------------------------------------------------------------------------------------------------------
+class XmlStreamReader
+{
+public:
+	bool					Open(const std::string& filePath);
+	void					Close();
+
+	bool					ReadNextElement(XmlStreamElement& out_element);
+
+	inline bool				HasError() const { return m_hasError; }
+
+private:
+	bool					GetChar(char& out_char);
+	bool					SkipPast(const char* terminator);
+	bool					ReadTag(XmlStreamElement& out_element);
+
+private:
+	static constexpr int	BUFFER_SIZE = 64 * 1024;
+
+	std::ifstream			m_file;
+	std::vector<char>		m_buffer;
+	int						m_bufferPos = 0;
+	int						m_bufferEnd = 0;
+	bool					m_hasError = false;
+};
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// GeometryBatchRenderer builds one vertex array for every shape on the CPU. Checks that the batch equals the shapes drawn
+// one at a time, that every shape writes exactly GetNumVertsForShape vertices, degenerate ones included, that no vertex
+// lands outside its shape, and that refilling an unchanged frame reuses the buffer
+//------------------------------------------------------------------------------------------------------------------------------
+//Game Systems
+#include "Game/GeometryBatchRenderer.hpp"
+#include "Tests/ShapeTestCases.hpp"
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool IsSameVertex(const Vertex_PCU& a, const Vertex_PCU& b)
+{
+	return a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z && IsSameColor(a.color, b.color);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int main()
+{
+	std::vector<ShapeTestCase> cases = MakeShapeTestCases(4000, 1234U);
+	Rgba fillColor = Rgba(0.1f, 0.2f, 0.3f, 0.5f);
+	Rgba outlineColor = Rgba(0.9f, 0.8f, 0.7f, 1.f);
+	int numFailures = 0;
+
+	GeometryBatchRenderer batch;
+	batch.BeginBatch();
+	for (const ShapeTestCase& testCase : cases)
+	{
+		batch.AddShape(testCase.m_shape, testCase.m_position, testCase.m_rotationDegrees, fillColor, outlineColor);
+	}
+
+	GeometryBatchRenderer single;
+	size_t batchOffset = 0;
+	for (const ShapeTestCase& testCase : cases)
+	{
+		single.BeginBatch();
+		single.AddShape(testCase.m_shape, testCase.m_position, testCase.m_rotationDegrees, fillColor, outlineColor);
+
+		const std::vector<Vertex_PCU>& vertices = single.GetVertices();
+		if (static_cast<int>(vertices.size()) != GeometryBatchRenderer::GetNumVertsForShape(testCase.m_shape.m_geometryType))
+		{
+			printf("Shape type %d wrote %d vertices\n", testCase.m_shape.m_geometryType, static_cast<int>(vertices.size()));
+			numFailures++;
+		}
+
+		for (size_t index = 0; index < vertices.size(); index++)
+		{
+			if (batchOffset + index >= batch.GetVertices().size() || !IsSameVertex(vertices[index], batch.GetVertices()[batchOffset + index]))
+			{
+				printf("Shape type %d differs between the batch and drawing it alone\n", testCase.m_shape.m_geometryType);
+				numFailures++;
+				break;
+			}
+
+			if (!IsVertexNearShape(vertices[index], testCase, batch.m_outlineThickness))
+			{
+				printf("Shape type %d has a vertex outside the shape\n", testCase.m_shape.m_geometryType);
+				numFailures++;
+				break;
+			}
+		}
+		batchOffset += vertices.size();
+	}
+
+	if (batchOffset != batch.GetVertices().size() || batch.GetNumShapes() != static_cast<int>(cases.size()))
+	{
+		printf("Batch holds %d vertices for %d shapes\n", static_cast<int>(batch.GetVertices().size()), batch.GetNumShapes());
+		numFailures++;
+	}
+
+	//The same frame again must fit in the memory the last one left behind
+	const Vertex_PCU* firstVertex = batch.GetVertices().data();
+	batch.BeginBatch();
+	for (const ShapeTestCase& testCase : cases)
+	{
+		batch.AddShape(testCase.m_shape, testCase.m_position, testCase.m_rotationDegrees, fillColor, outlineColor);
+	}
+
+	if (batch.GetVertices().data() != firstVertex)
+	{
+		printf("Batch reallocated on an unchanged frame\n");
+		numFailures++;
+	}
+
+	printf("BatchRendererTest: %d shapes, %d vertices, %d failures\n", static_cast<int>(cases.size()), static_cast<int>(batch.GetVertices().size()), numFailures);
+	return (numFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// Stand ins for the few Engine definitions the tested Game classes reach. The tests link these instead of the Engine
+// library so they run without a device or a window. Keep the signatures in step with the Engine headers
+//------------------------------------------------------------------------------------------------------------------------------
+//Engine Systems
+#include "Engine/Commons/StringUtils.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/Rigidbody2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+const Vec2 Vec2::ZERO = Vec2(0.f, 0.f);
+
+const Rgba Rgba::WHITE = Rgba(1.f, 1.f, 1.f, 1.f);
+const Rgba Rgba::RED = Rgba(1.f, 0.f, 0.f, 1.f);
+const Rgba Rgba::GREEN = Rgba(0.f, 1.f, 0.f, 1.f);
+const Rgba Rgba::YELLOW = Rgba(1.f, 1.f, 0.f, 1.f);
+const Rgba Rgba::ORANGE = Rgba(1.f, 0.5f, 0.f, 1.f);
+
+DevConsole* g_devConsole = nullptr;
+
+//------------------------------------------------------------------------------------------------------------------------------
+const std::string Stringf(const char* format, ...)
+{
+	char buffer[2048];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	return std::string(buffer);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float Vec2::GetLength() const
+{
+	return sqrtf(x * x + y * y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 Vec2::GetNormalized() const
+{
+	float length = GetLength();
+	return (length > 0.f) ? Vec2(x / length, y / length) : Vec2(0.f, 0.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+eSimulationType Rigidbody2D::GetSimulationType()
+{
+	return DYNAMIC_SIMULATION;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Drawing is not under test, the renderers are checked through the vertices they build
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderContext::BindTextureViewWithSampler(unsigned int, TextureView*)
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RenderContext::DrawVertexArray(const std::vector<Vertex_PCU>&)
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DevConsole::PrintString(const Rgba&, const std::string& message)
+{
+	printf("%s\n", message.c_str());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A quad per character, laid out on a fixed advance. Enough for callers that count or cache glyph vertices
+//------------------------------------------------------------------------------------------------------------------------------
+void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& vertexArray, const Vec2& textStartPosition, float cellHeight, const std::string& printText, const Rgba& tint, float cellAspect)
+{
+	float cellWidth = cellHeight * cellAspect;
+	for (size_t charIndex = 0; charIndex < printText.size(); charIndex++)
+	{
+		float left = textStartPosition.x + cellWidth * static_cast<float>(charIndex);
+		float right = left + cellWidth;
+		float bottom = textStartPosition.y;
+		float top = bottom + cellHeight;
+
+		vertexArray.push_back(Vertex_PCU(Vec3(left, bottom, 0.f), tint, Vec2(0.f, 0.f)));
+		vertexArray.push_back(Vertex_PCU(Vec3(right, bottom, 0.f), tint, Vec2(1.f, 0.f)));
+		vertexArray.push_back(Vertex_PCU(Vec3(right, top, 0.f), tint, Vec2(1.f, 1.f)));
+		vertexArray.push_back(Vertex_PCU(Vec3(left, bottom, 0.f), tint, Vec2(0.f, 0.f)));
+		vertexArray.push_back(Vertex_PCU(Vec3(right, top, 0.f), tint, Vec2(1.f, 1.f)));
+		vertexArray.push_back(Vertex_PCU(Vec3(left, top, 0.f), tint, Vec2(0.f, 1.f)));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TextureView* BitmapFont::GetTexture()
+{
+	return nullptr;
+}
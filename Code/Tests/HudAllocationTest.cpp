@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// The HUD formats its lines into frame memory and HudTextBatch keeps the glyphs of lines that did not change. Once both have
+// grown to fit, a frame of HUD text must make no heap allocations. Needs GAME_TRACK_ALLOCATIONS so AllocationTracker counts
+//------------------------------------------------------------------------------------------------------------------------------
+//Engine Systems
+#include "Engine/Renderer/BitmapFont.hpp"
+//Game Systems
+#include "Game/AllocationTracker.hpp"
+#include "Game/FrameAllocator.hpp"
+#include "Game/HudTextBatch.hpp"
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+int main()
+{
+	if (!AllocationTracker::IsCompiledIn())
+	{
+		printf("HudAllocationTest: build with GAME_TRACK_ALLOCATIONS\n");
+		return 1;
+	}
+
+	constexpr int NUM_WARMUP_FRAMES = 10;
+	constexpr int NUM_FRAMES = 1000;
+
+	FrameAllocator frameAllocator(256 * 1024);
+	HudTextBatch hudText;
+	BitmapFont font;
+
+	for (int frame = 0; frame < NUM_WARMUP_FRAMES + NUM_FRAMES; frame++)
+	{
+		if (frame == NUM_WARMUP_FRAMES)
+		{
+			AllocationTracker::ResetStats();
+		}
+
+		//Shaped like the HUD: a fixed label and fixed width values that change every frame
+		frameAllocator.Reset();
+		hudText.BeginFrame();
+		hudText.AddText(font, Vec2(0.f, 0.f), 1.f, "Static Objects:", Rgba::WHITE);
+		hudText.AddText(font, Vec2(0.f, 1.f), 1.f, frameAllocator.Format("Bodies: %6d", 1000 + frame % 7), Rgba::WHITE);
+		hudText.AddText(font, Vec2(0.f, 2.f), 1.f, frameAllocator.Format("Mass: %8.3f Friction: %5.2f", 1.f + 0.001f * frame, 0.5f), Rgba::YELLOW);
+		hudText.AddText(font, Vec2(0.f, 3.f), 1.f, frameAllocator.Format("Step %08d", frame), Rgba::GREEN);
+
+		AllocationTracker::EndFrame();
+	}
+
+	int numFrames = AllocationTracker::GetNumFrames();
+	int numQuietFrames = AllocationTracker::GetNumQuietFrames();
+	bool isPassing = (numFrames == NUM_FRAMES) && (numQuietFrames == NUM_FRAMES) && (frameAllocator.GetNumOverflows() == 0);
+
+	printf("HudAllocationTest: %d of %d frames made no heap allocations, %d lines rebuilt in the last frame, %d frame bytes, %d overflows\n",
+		numQuietFrames, numFrames, hudText.GetNumLinesRebuilt(), static_cast<int>(frameAllocator.GetHighWaterMark()), frameAllocator.GetNumOverflows());
+	return isPassing ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// InstancedShapeRenderer expands its per field instance arrays into vertices on the CPU. Checks every expanded vertex
+// against the scalar transform of its unit mesh vertex in double precision, the colors and counts that come out, and that
+// each shape alone stays inside its bounds, the same bound the batched renderer meets
+//------------------------------------------------------------------------------------------------------------------------------
+//Game Systems
+#include "Game/InstancedShapeRenderer.hpp"
+#include "Tests/ShapeTestCases.hpp"
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+int main()
+{
+	std::vector<ShapeTestCase> cases = MakeShapeTestCases(4000, 1234U);
+	int numFailures = 0;
+
+	InstancedShapeRenderer renderer;
+	renderer.BeginFrame();
+	for (int index = 0; index < static_cast<int>(cases.size()); index++)
+	{
+		const ShapeTestCase& testCase = cases[index];
+		renderer.AddShape(testCase.m_shape, testCase.m_position, testCase.m_rotationDegrees, static_cast<eInstanceColorState>(index % NUM_INSTANCE_COLOR_STATES));
+	}
+	renderer.BuildVertices();
+
+	//Meshes are expanded in order, every instance of a mesh gets the whole mesh
+	const std::vector<Vertex_PCU>& vertices = renderer.GetVertices();
+	size_t vertexIndex = 0;
+	double worstError = 0.0;
+	for (int meshIndex = 0; meshIndex < NUM_INSTANCE_MESHES; meshIndex++)
+	{
+		const ShapeInstanceBuffer& instances = renderer.GetInstances(static_cast<eInstanceMesh>(meshIndex));
+		const UnitShapeMesh& mesh = renderer.GetUnitMesh(static_cast<eInstanceMesh>(meshIndex));
+		for (int instance = 0; instance < instances.GetNumInstances(); instance++)
+		{
+			double radians = instances.m_rotationDegrees[instance] * 3.14159265358979323846 / 180.0;
+			double cosine = cos(radians);
+			double sine = sin(radians);
+			uint8_t colorState = instances.m_colorState[instance];
+
+			for (int meshVertex = 0; meshVertex < mesh.GetNumVertices(); meshVertex++, vertexIndex++)
+			{
+				if (vertexIndex >= vertices.size())
+				{
+					break;
+				}
+
+				double localX = mesh.m_x[meshVertex] * instances.m_scaleX[instance] + mesh.m_offsetX[meshVertex] * renderer.m_outlineThickness;
+				double localY = mesh.m_y[meshVertex] * instances.m_scaleY[instance] + mesh.m_offsetY[meshVertex] * renderer.m_outlineThickness;
+				double expectedX = instances.m_positionX[instance] + cosine * localX - sine * localY;
+				double expectedY = instances.m_positionY[instance] + sine * localX + cosine * localY;
+
+				const Vertex_PCU& vertex = vertices[vertexIndex];
+				double error = fmax(fabs(expectedX - vertex.position.x), fabs(expectedY - vertex.position.y)) / (1.0 + fabs(expectedX) + fabs(expectedY));
+				worstError = fmax(worstError, error);
+
+				const Rgba& expectedColor = mesh.m_isOutline[meshVertex] ? renderer.m_outlineColors[colorState] : renderer.m_fillColors[colorState];
+				if (!IsSameColor(vertex.color, expectedColor))
+				{
+					numFailures++;
+				}
+			}
+		}
+	}
+
+	if (vertexIndex != vertices.size())
+	{
+		printf("Expanded %d vertices, the instances need %d\n", static_cast<int>(vertices.size()), static_cast<int>(vertexIndex));
+		numFailures++;
+	}
+
+	if (worstError > 1e-5)
+	{
+		printf("Expanded vertices are off by up to %g\n", worstError);
+		numFailures++;
+	}
+
+	int numVertices = static_cast<int>(vertices.size());
+
+	//One shape at a time, nothing may land outside the shape
+	for (const ShapeTestCase& testCase : cases)
+	{
+		renderer.BeginFrame();
+		renderer.AddShape(testCase.m_shape, testCase.m_position, testCase.m_rotationDegrees, INSTANCE_COLOR_STATIC);
+		renderer.BuildVertices();
+
+		for (const Vertex_PCU& vertex : renderer.GetVertices())
+		{
+			if (!IsVertexNearShape(vertex, testCase, renderer.m_outlineThickness))
+			{
+				printf("Shape type %d has a vertex outside the shape\n", testCase.m_shape.m_geometryType);
+				numFailures++;
+				break;
+			}
+		}
+	}
+
+	printf("InstancedShapeTest: %d shapes, %d vertices, worst relative error %g, %d failures\n", static_cast<int>(cases.size()), numVertices, worstError, numFailures);
+	return (numFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Engine Systems
+#include "Engine/Math/Vertex_PCU.hpp"
+//Game Systems
+#include "Game/Geometry.hpp"
+#include <math.h>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One shape to draw and how far from its position any of its vertices may land, outline excluded
+//------------------------------------------------------------------------------------------------------------------------------
+struct ShapeTestCase
+{
+	GeometryShape			m_shape;
+	Vec2					m_position = Vec2::ZERO;
+	float					m_rotationDegrees = 0.f;
+	float					m_extent = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+inline float GetShapeExtent(const GeometryShape& shape)
+{
+	switch (shape.m_geometryType)
+	{
+	case AABB2_GEOMETRY:
+	case BOX_GEOMETRY:		return 0.5f * sqrtf(shape.m_size.x * shape.m_size.x + shape.m_size.y * shape.m_size.y);
+	case DISC_GEOMETRY:		return shape.m_radius;
+	case CAPSULE_GEOMETRY:
+	{
+		Vec2 span = Vec2(shape.m_end.x - shape.m_start.x, shape.m_end.y - shape.m_start.y);
+		return 0.5f * sqrtf(span.x * span.x + span.y * span.y) + shape.m_radius;
+	}
+	default:				return 0.f;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Random shapes of every type, then the degenerate ones: zero size boxes, zero radius discs and capsules whose ends meet
+//------------------------------------------------------------------------------------------------------------------------------
+inline std::vector<ShapeTestCase> MakeShapeTestCases(int numRandom, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	auto random = [&rng](float minValue, float maxValue) { return std::uniform_real_distribution<float>(minValue, maxValue)(rng); };
+
+	std::vector<ShapeTestCase> cases;
+	for (int index = 0; index < numRandom; index++)
+	{
+		ShapeTestCase testCase;
+		GeometryShape& shape = testCase.m_shape;
+		shape.m_geometryType = static_cast<eGeometryType>(index % 4);
+		shape.m_size = Vec2(random(0.25f, 20.f), random(0.25f, 20.f));
+		shape.m_radius = random(0.25f, 10.f);
+		shape.m_start = Vec2(random(-30.f, 30.f), random(-30.f, 30.f));
+		shape.m_end = Vec2(random(-30.f, 30.f), random(-30.f, 30.f));
+		shape.m_rotationDegrees = random(-180.f, 180.f);
+		testCase.m_position = Vec2(random(-500.f, 500.f), random(-500.f, 500.f));
+		testCase.m_rotationDegrees = random(-720.f, 720.f);
+		cases.push_back(testCase);
+	}
+
+	for (int type = 0; type < 4; type++)
+	{
+		ShapeTestCase testCase;
+		GeometryShape& shape = testCase.m_shape;
+		shape.m_geometryType = static_cast<eGeometryType>(type);
+		shape.m_size = Vec2(0.f, 0.f);
+		shape.m_radius = (type == CAPSULE_GEOMETRY) ? 1.f : 0.f;
+		shape.m_start = Vec2(3.f, 4.f);
+		shape.m_end = Vec2(3.f, 4.f);
+		testCase.m_position = Vec2(10.f, -10.f);
+		testCase.m_rotationDegrees = 30.f;
+		cases.push_back(testCase);
+	}
+
+	for (ShapeTestCase& testCase : cases)
+	{
+		testCase.m_extent = GetShapeExtent(testCase.m_shape);
+	}
+	return cases;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+inline bool IsVertexNearShape(const Vertex_PCU& vertex, const ShapeTestCase& testCase, float outlineThickness)
+{
+	float offsetX = vertex.position.x - testCase.m_position.x;
+	float offsetY = vertex.position.y - testCase.m_position.y;
+	float reach = testCase.m_extent + 2.f * outlineThickness + 1e-3f * (1.f + testCase.m_extent);
+	return sqrtf(offsetX * offsetX + offsetY * offsetY) <= reach;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+inline bool IsSameColor(const Rgba& a, const Rgba& b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}